@@ -4,26 +4,12 @@
 #include "ProjectContent/AssetDownloader/SAssetDownloadWidget.h"
 #include "Widgets/Text/STextBlock.h"
 #include "Widgets/Input/SButton.h"
-#include "AssetDownloader.h"
-#include "Modules/ModuleManager.h"
-#include "RSAssetLibrary.h"
 #include "RSAssetLibraryStyle.h"
-#include "GenericPlatform/GenericPlatformHttp.h"
 #include "Framework/Notifications/NotificationManager.h"
 #include "Widgets/Notifications/SNotificationList.h"
 
 #define LOCTEXT_NAMESPACE "SAssetDownloadWidget"
 
-static const int32 MaxConcurrentDownloads = 10;
-FCriticalSection SAssetDownloadWidget::ActiveTasksMutex;
-FCriticalSection SAssetDownloadWidget::PendingTasksMutex;
-FCriticalSection SAssetDownloadWidget::PausedTasksMutex;
-
-TQueue<TSharedPtr<SAssetDownloadWidget>> SAssetDownloadWidget::PendingTasks;
-TArray<TSharedPtr<SAssetDownloadWidget>> SAssetDownloadWidget::ActiveTasks;
-TArray<TWeakPtr<SAssetDownloadWidget>> SAssetDownloadWidget::PausedTasks;
-TArray<TSharedPtr<SAssetDownloadWidget>> SAssetDownloadWidget::FailedTasks;
-
 void SAssetDownloadWidget::Construct(const FArguments& InArgs)
 {
     DownloadCompleteWidget = InArgs._DownloadCompleteWidget;
@@ -37,14 +23,15 @@ void SAssetDownloadWidget::Construct(const FArguments& InArgs)
         // UE_LOG(LogTemp, Error, TEXT("DownloadCompleteWidget is invalid in Construct!"));
     }
     
-    AssetDownloader = NewObject<UAssetDownloader>();
-    AssetDownloader->SetOnDownloadProgress(FOnDownloadProgress::CreateSP(this, &SAssetDownloadWidget::OnDownloadProgress));
-    AssetDownloader->SetOnDownloadComplete(FOnDownloadComplete::CreateSP(this, &SAssetDownloadWidget::OnDownloadComplete));
-    AssetDownloader->SetOnDownloadError(FOnDownloadError::CreateSP(this, &SAssetDownloadWidget::OnDownloadError));
-
-    AssetURL = InArgs._URL;
-    AssetFileName = InArgs._FileName;
-    AssetMD5 = InArgs._MD5;
+    // The job keeps running in the download subsystem, this row only follows it 任务由下载子系统执行，此行只负责显示
+    Job = InArgs._Job;
+    if (Job.IsValid())
+    {
+        AssetFileName = Job->GetFileName();
+        Job->OnProgress.AddSP(this, &SAssetDownloadWidget::OnDownloadProgress);
+        Job->OnStateChanged.AddSP(this, &SAssetDownloadWidget::OnJobStateChanged);
+    }
+    FAssetImportPipeline::Get().OnImportStateChanged.AddSP(this, &SAssetDownloadWidget::OnImportStateChanged);
     ParentContainer = InArgs._ParentContainer; 
     
     ChildSlot
@@ -78,7 +65,7 @@ void SAssetDownloadWidget::Construct(const FArguments& InArgs)
                 .ContentPadding(0) 
                 .ToolTipText(LOCTEXT("DownloadTooltip", "Start"))
                 .OnClicked(this, &SAssetDownloadWidget::OnStartOrResumeClicked)
-                .IsEnabled_Lambda([this]() { return bIsPaused; }) 
+                .IsEnabled_Lambda([this]() { return IsPaused(); }) 
             ]
             
             + SHorizontalBox::Slot()
@@ -90,7 +77,7 @@ void SAssetDownloadWidget::Construct(const FArguments& InArgs)
                 .ContentPadding(0) 
                 .ToolTipText(LOCTEXT("PauseTooltip", "Pause"))
                 .OnClicked(this, &SAssetDownloadWidget::OnPauseClicked)
-                .IsEnabled_Lambda([this]() { return !bIsPaused; }) 
+                .IsEnabled_Lambda([this]() { return Job.IsValid() && !Job->IsFinished() && !IsPaused(); }) 
             ]
             
             + SHorizontalBox::Slot()
@@ -112,6 +99,7 @@ void SAssetDownloadWidget::Construct(const FArguments& InArgs)
         [
             SAssignNew(DownloadStatusText, STextBlock)
             .Text(LOCTEXT("WaitingForDownload", "Waiting..."))
+            .ToolTipText(this, &SAssetDownloadWidget::GetStatusToolTipText)
         ]
         
         + SHorizontalBox::Slot()
@@ -148,6 +136,38 @@ void SAssetDownloadWidget::Construct(const FArguments& InArgs)
     CancelButtonStyle.SetNormal(*FRSAssetLibraryStyle::Get().GetBrush("RSAssetLibrary.CancelIcon"));
     CancelButtonStyle.SetHovered(*FRSAssetLibraryStyle::Get().GetBrush("RSAssetLibrary.CancelClicked"));
     CancelButtonStyle.SetPressed(*FRSAssetLibraryStyle::Get().GetBrush("RSAssetLibrary.CancelClicked"));
+
+    // A reopened list shows jobs that are already under way 重新打开列表时显示已在进行中的任务
+    if (Job.IsValid())
+    {
+        UpdateButtonStyles();
+        if (Job->GetState() == EAssetDownloadState::Paused)
+        {
+            DownloadStatusText->SetText(LOCTEXT("DownloadPaused", "Download Paused"));
+        }
+        else if (Job->GetState() == EAssetDownloadState::Failed)
+        {
+            DownloadStatusText->SetText(Job->IsCorrupt()
+                ? LOCTEXT("DownloadCorrupt", "MD5 check failed!")
+                : LOCTEXT("DownloadFailed", "Download failed!"));
+        }
+        if (Job->GetTotalBytes() > 0)
+        {
+            OnDownloadProgress(Job.Get());
+        }
+    }
+}
+
+bool SAssetDownloadWidget::IsPaused() const
+{
+    return Job.IsValid() && (Job->GetState() == EAssetDownloadState::Paused || Job->GetState() == EAssetDownloadState::Failed);
+}
+
+void SAssetDownloadWidget::UpdateButtonStyles()
+{
+    const bool bCanStart = IsPaused();
+    BeginButtonStyle.SetNormal(*FRSAssetLibraryStyle::Get().GetBrush(bCanStart ? "RSAssetLibrary.BeginIcon" : "RSAssetLibrary.BeginClicked"));
+    PauseButtonStyle.SetNormal(*FRSAssetLibraryStyle::Get().GetBrush(bCanStart ? "RSAssetLibrary.PauseClicked" : "RSAssetLibrary.PauseIcon"));
 }
 
 FString SAssetDownloadWidget::TruncateText(const FString& OriginalText, int32 MaxLength)
@@ -178,150 +198,101 @@ FString SAssetDownloadWidget::TruncateText(const FString& OriginalText, int32 Ma
 }
 
 
-void SAssetDownloadWidget::SetDownloadParameters(const FString& InURL, const FString& InFileName, const FString& InMD5)
-{
-    OriginalURL = InURL;
-    AssetFileName = InFileName;
-    AssetMD5 = InMD5;
-}
-
 FReply SAssetDownloadWidget::OnStartOrResumeClicked()
 {
-    if (ActiveTasks.Num() >= MaxConcurrentDownloads)
-    {
-        FScopeLock Lock(&ActiveTasksMutex);
-        PendingTasks.Enqueue(SharedThis(this));
-        if (DownloadStatusText.IsValid())
-        {
-            DownloadStatusText->SetText(LOCTEXT("WaitingForDownload", "Waiting..."));
-        }
-    }
-    else
+    if (UAssetDownloadSubsystem* DownloadSubsystem = UAssetDownloadSubsystem::Get())
     {
-        if (!ActiveTasks.Contains(SharedThis(this))) 
-        {
-            StartDownload();
-        }
+        DownloadSubsystem->ResumeJob(Job.Get());
     }
-    
-    bIsPaused = false; 
-    
-    BeginButtonStyle.SetNormal(*FRSAssetLibraryStyle::Get().GetBrush("RSAssetLibrary.BeginClicked"));
-    PauseButtonStyle.SetNormal(*FRSAssetLibraryStyle::Get().GetBrush("RSAssetLibrary.PauseIcon"));
-
     return FReply::Handled();
 }
 
-
-void SAssetDownloadWidget::StartDownload()
+FReply SAssetDownloadWidget::OnPauseClicked()
 {
-    if (AssetDownloader->IsPaused())
+    if (UAssetDownloadSubsystem* DownloadSubsystem = UAssetDownloadSubsystem::Get())
     {
-        AssetDownloader->ResumeDownload();
-        DownloadStatusText->SetText(LOCTEXT("ContinueDownload", "Download..."));
-    }
-    else
-    {
-        int32 LastSlashIndex;
-        if (OriginalURL.FindLastChar('/', LastSlashIndex))
-        {
-            FString BaseUrl = OriginalURL.Left(LastSlashIndex + 1);
-            FString FileName = OriginalURL.Mid(LastSlashIndex + 1);
-            FString EncodedFileName = FGenericPlatformHttp::UrlEncode(FileName);
-            AssetURL = BaseUrl + EncodedFileName;
-        }
-        else
-        {
-            AssetURL = OriginalURL;
-        }
-
-        AssetDownloader->StartChunkDownload(AssetURL, AssetFileName, AssetMD5);
-        DownloadStatusText->SetText(LOCTEXT("StartDownload", "Starting Download..."));
-    }
-    {
-        FScopeLock Lock(&ActiveTasksMutex);
-        ActiveTasks.Add(SharedThis(this));
-
-        // // UE_LOG(LogTemp, Warning, TEXT("当前下载的任务数量为： %d"), ActiveTasks.Num())
+        DownloadSubsystem->PauseJob(Job.Get());
     }
+    return FReply::Handled();
 }
 
-FReply SAssetDownloadWidget::OnPauseClicked()
+FReply SAssetDownloadWidget::OnCancelClicked()
 {
-    if (AssetDownloader && !AssetDownloader->IsPaused())
+    UAssetDownloadSubsystem* DownloadSubsystem = UAssetDownloadSubsystem::Get();
+    if (DownloadSubsystem && Job.IsValid() && !Job->IsFinished())
     {
-        AssetDownloader->PauseDownload();
-        
-        if (DownloadStatusText.IsValid())
-        {
-            DownloadStatusText->SetText(LOCTEXT("DownloadPaused", "Download Paused"));
-        }
-        {
-            FScopeLock Lock(&ActiveTasksMutex);
-            ActiveTasks.Remove(SharedThis(this));
-        }
-        {
-            FScopeLock Lock(&PendingTasksMutex);
-            
-            ProcessPendingTasks();
-            
-            PausedTasks.Add(SharedThis(this));
-        }
-        ProcessPendingTasks();
+        // The Cancelled state change removes this row 状态变为已取消时移除此行
+        DownloadSubsystem->CancelJob(Job.Get());
+    }
+    else if (ParentContainer.IsValid())
+    {
+        ParentContainer.Pin()->RemoveSlot(SharedThis(this));
     }
-
-    bIsPaused = true; 
-    
-    BeginButtonStyle.SetNormal(*FRSAssetLibraryStyle::Get().GetBrush("RSAssetLibrary.BeginIcon"));
-    PauseButtonStyle.SetNormal(*FRSAssetLibraryStyle::Get().GetBrush("RSAssetLibrary.PauseClicked"));
-
     return FReply::Handled();
 }
 
-FReply SAssetDownloadWidget::OnCancelClicked()
+void SAssetDownloadWidget::OnJobStateChanged(UAssetDownloadJob* InJob, EAssetDownloadState PreviousState)
 {
-    if (AssetDownloader)
-    {
-        AssetDownloader->CancelDownload();
-        
-        if (DownloadStatusText.IsValid())
-        {
-            DownloadStatusText->SetText(LOCTEXT("DownloadCancelled", "Download Cancelled"));
-        }
-        
-        if (DownloadProgressBar.IsValid())
-        {
-            DownloadProgressBar->SetPercent(0.0f);
-        }
-        
-        {
-            FScopeLock Lock(&ActiveTasksMutex);
-            ActiveTasks.Remove(SharedThis(this)); 
-        }
-        
+    UpdateButtonStyles();
+
+    // The status text is replaced below, so the next progress update writes it again 状态文本被替换，下一次进度更新需重新写入
+    LastStatus.Reset();
+    LastProgressPermille = -1;
+
+    switch (InJob->GetState())
+    {
+    case EAssetDownloadState::Queued:
+        DownloadStatusText->SetText(LOCTEXT("WaitingForDownload", "Waiting..."));
+        break;
+    case EAssetDownloadState::Downloading:
+        DownloadStatusText->SetText(PreviousState == EAssetDownloadState::Queued && InJob->GetDownloadedBytes() > 0
+            ? LOCTEXT("ContinueDownload", "Download...")
+            : LOCTEXT("StartDownload", "Starting Download..."));
+        break;
+    case EAssetDownloadState::Paused:
+        DownloadStatusText->SetText(LOCTEXT("DownloadPaused", "Download Paused"));
+        break;
+    case EAssetDownloadState::Completed:
+        OnDownloadComplete();
+        break;
+    case EAssetDownloadState::Failed:
+        OnDownloadError();
+        break;
+    case EAssetDownloadState::Cancelled:
+        DownloadStatusText->SetText(LOCTEXT("DownloadCancelled", "Download Cancelled"));
+        DownloadProgressBar->SetPercent(0.0f);
         if (ParentContainer.IsValid())
         {
             ParentContainer.Pin()->RemoveSlot(SharedThis(this));
         }
-
-        {
-            FScopeLock Lock(&PendingTasksMutex);
-            ProcessPendingTasks();
-        }
+        break;
     }
-    return FReply::Handled();
 }
 
-void SAssetDownloadWidget::OnDownloadProgress(float Progress, int64 BytesDownloaded, int64 InTotalBytes)
+void SAssetDownloadWidget::OnDownloadProgress(UAssetDownloadJob* InJob)
 {
-    TotalBytes = InTotalBytes; 
+    // With an import chained to it, the download fills the bar up to the import share 有后续导入时，下载只占进度条的前一部分
+    const float Progress = FAssetImportPipeline::Get().IsImportPending(AssetFileName)
+        ? InJob->GetProgress() * DownloadShareOfImport
+        : InJob->GetProgress();
+    const int64 BytesDownloaded = InJob->GetDownloadedBytes();
+    TotalBytes = InJob->GetTotalBytes(); 
     
-    if (DownloadProgressBar.IsValid())
+    // Widgets are only touched when what they show changed 只有显示内容变化时才更新控件
+    const int32 ProgressPermille = FMath::FloorToInt(Progress * 1000.0f);
+    if (DownloadProgressBar.IsValid() && ProgressPermille != LastProgressPermille)
     {
+        LastProgressPermille = ProgressPermille;
         DownloadProgressBar->SetPercent(Progress);
     }
 
-    if (DownloadStatusText.IsValid())
+    // Progress that was gathered before a pause is not shown over the paused text 暂停前累积的进度不覆盖暂停提示
+    if (DownloadStatusText.IsValid() && InJob->GetState() == EAssetDownloadState::Downloading && InJob->IsWaitingForSharedDownload())
+    {
+        LastStatus.Reset();
+        DownloadStatusText->SetText(LOCTEXT("WaitingForSharedDownload", "Downloading in another editor..."));
+    }
+    else if (DownloadStatusText.IsValid() && InJob->GetState() == EAssetDownloadState::Downloading)
     {
         // 本地化部分 - 只本地化 "下载中："
         FText DownloadingText = LOCTEXT("Downloading", "Progress: ");
@@ -350,6 +321,25 @@ void SAssetDownloadWidget::OnDownloadProgress(float Progress, int64 BytesDownloa
         // 组合本地化文本和进度
         FText FinalStatus = FText::Format(FText::FromString("{0} {1}"), DownloadingText, FText::FromString(Status));
 
+        // Smoothed speed and time left once the rate is known 速率确定后显示平滑速度和剩余时间
+        const double BytesPerSecond = InJob->GetStats().SmoothedBytesPerSecond;
+        const double EtaSeconds = InJob->GetEtaSeconds();
+        const int64 SpeedKB = (int64)(BytesPerSecond / 1024.0);
+        const int64 EtaWholeSeconds = EtaSeconds >= 0.0 ? (int64)FMath::CeilToDouble(EtaSeconds) : -1;
+        if (Status == LastStatus && SpeedKB == LastSpeedKB && EtaWholeSeconds == LastEtaSeconds)
+        {
+            return;
+        }
+        LastStatus = Status;
+        LastSpeedKB = SpeedKB;
+        LastEtaSeconds = EtaWholeSeconds;
+
+        if (EtaWholeSeconds >= 0)
+        {
+            FinalStatus = FText::Format(LOCTEXT("DownloadingWithEta", "{0}  {1}/s, {2} left"), FinalStatus,
+                FText::AsMemory((uint64)BytesPerSecond), FText::AsTimespan(FTimespan::FromSeconds((double)EtaWholeSeconds)));
+        }
+
         // 更新文本
         DownloadStatusText->SetText(FinalStatus);
     }
@@ -359,22 +349,22 @@ void SAssetDownloadWidget::OnDownloadProgress(float Progress, int64 BytesDownloa
 
 void SAssetDownloadWidget::OnDownloadComplete()
 {
+    // A row whose file is imported next stays until the import finished 需要导入的行保留到导入结束
+    const bool bIsImportPending = FAssetImportPipeline::Get().IsImportPending(AssetFileName);
     if (DownloadStatusText.IsValid())
     {
-        DownloadStatusText->SetText(LOCTEXT("DownloadCompleted", "Download Completed!"));
+        DownloadStatusText->SetText(bIsImportPending
+            ? LOCTEXT("WaitingForImport", "Waiting to import...")
+            : LOCTEXT("DownloadCompleted", "Download Completed!"));
     }
-    if (ActiveTasks.Contains(SharedThis(this)))
+    if (bIsImportPending)
     {
-        ActiveTasks.Remove(SharedThis(this));
+        DownloadProgressBar->SetPercent(DownloadShareOfImport);
     }
-    if (ParentContainer.IsValid())
+    else if (ParentContainer.IsValid())
     {
         ParentContainer.Pin()->RemoveSlot(SharedThis(this));
     }
-    {
-        FScopeLock Lock(&PendingTasksMutex);
-        ProcessPendingTasks();
-    }
     
 
     if (OnDownloadCompleted.IsBound())
@@ -434,18 +424,17 @@ void SAssetDownloadWidget::OnDownloadComplete()
 
 void SAssetDownloadWidget::OnDownloadError()
 {
+    const bool bIsCorrupt = Job.IsValid() && Job->IsCorrupt();
     if (DownloadStatusText.IsValid())
     {
-        DownloadStatusText->SetText(LOCTEXT("DownloadFailed", "Download failed!"));
-    }
-    ActiveTasks.Remove(SharedThis(this));
-    FailedTasks.Add(SharedThis(this));
-    {
-        FScopeLock Lock(&PendingTasksMutex);
-        ProcessPendingTasks();
+        DownloadStatusText->SetText(bIsCorrupt
+            ? LOCTEXT("DownloadCorrupt", "MD5 check failed!")
+            : LOCTEXT("DownloadFailed", "Download failed!"));
     }
     
-    FNotificationInfo Info(LOCTEXT("DownloadFailed", "Download failed!"));
+    FNotificationInfo Info(bIsCorrupt
+        ? LOCTEXT("DownloadCorruptNotification", "Downloaded file is corrupt (MD5 mismatch)!")
+        : LOCTEXT("DownloadFailed", "Download failed!"));
     Info.bFireAndForget = true; 
     Info.FadeOutDuration = 2.0f;
     Info.ExpireDuration = 5.0f; 
@@ -458,114 +447,85 @@ void SAssetDownloadWidget::OnDownloadError()
     }
 }
 
-void SAssetDownloadWidget::SetPausedAllDownloads(bool bPaused)
-{
-    bIsPausedAllDownloads = bPaused;
-}
-
-
-void SAssetDownloadWidget::ProcessPendingTasks()
+void SAssetDownloadWidget::OnImportStateChanged(const FString& FileName, EAssetImportState State)
 {
-    if (bIsPausedAllDownloads) 
-        {
-            return;
-        }
-    
-    // Use the FModuleManager to obtain module instances.使用 FModuleManager 来获取模块实例
-    if (FModuleManager::Get().IsModuleLoaded("TestPluginUI"))
-    {
-        FRSAssetLibraryModule& PluginModule = FModuleManager::GetModuleChecked<FRSAssetLibraryModule>("RSAssetLibrary");
-    }
-    
-    if (PendingTasks.IsEmpty() || ActiveTasks.Num() >= MaxConcurrentDownloads)
+    if (FileName != AssetFileName || !DownloadStatusText.IsValid())
     {
         return;
     }
 
-    TSharedPtr<SAssetDownloadWidget> NextTask;
-    if (PendingTasks.Dequeue(NextTask))
-    {
-        if (NextTask.IsValid())
-        {
-            if (ActiveTasks.Num() < MaxConcurrentDownloads)
-            {
-                NextTask->StartDownload();
-            }
-            else
-            {
-                if (NextTask->DownloadStatusText.IsValid())
-                {
-                    NextTask->DownloadStatusText->SetText(LOCTEXT("WaitingForDownload", "Waiting..."));
-                }
-                PendingTasks.Enqueue(NextTask);
-            }
-        }
-    }
-}
-
+    LastStatus.Reset();
+    LastProgressPermille = -1;
 
-
-bool SAssetDownloadWidget::IsFileDownloading(const FString& FilePath)
-{
-    // Extract file name 提取文件名
-    FString FileName = FPaths::GetCleanFilename(FilePath);
-
-    // Check the active task queue 检查活跃任务队列
+    switch (State)
     {
-        FScopeLock Lock(&ActiveTasksMutex);
-        for (const TSharedPtr<SAssetDownloadWidget>& Task : ActiveTasks)
+    case EAssetImportState::Queued:
+        DownloadStatusText->SetText(LOCTEXT("WaitingForImport", "Waiting to import..."));
+        DownloadProgressBar->SetPercent(DownloadShareOfImport);
+        break;
+    case EAssetImportState::Importing:
+        DownloadStatusText->SetText(LOCTEXT("Importing", "Importing..."));
+        DownloadProgressBar->SetPercent(DownloadShareOfImport);
+        break;
+    case EAssetImportState::Imported:
+        DownloadStatusText->SetText(LOCTEXT("Imported", "Imported"));
+        DownloadProgressBar->SetPercent(1.0f);
+        if (ParentContainer.IsValid())
         {
-            if (Task.IsValid() && Task->AssetFileName.Equals(FileName, ESearchCase::IgnoreCase))
-            {
-                return true; 
-            }
+            ParentContainer.Pin()->RemoveSlot(SharedThis(this));
         }
-    }
-
-    // Check the waiting task queue 检查等待任务队列
-    {
-        FScopeLock Lock(&PendingTasksMutex);
-        TQueue<TSharedPtr<SAssetDownloadWidget>> TempPendingTasks;
-        TSharedPtr<SAssetDownloadWidget> Task;
-
-        while (!PendingTasks.IsEmpty())
+        break;
+    case EAssetImportState::Failed:
         {
-            PendingTasks.Dequeue(Task);
+            // The row stays so the failure can be seen, Cancel removes it 行保留以便查看失败，点击取消移除
+            DownloadStatusText->SetText(LOCTEXT("ImportFailed", "Import failed!"));
+            DownloadProgressBar->SetPercent(1.0f);
 
-            if (Task.IsValid() && Task->AssetFileName.Equals(FileName, ESearchCase::IgnoreCase))
+            FNotificationInfo Info(FText::Format(LOCTEXT("ImportFailedNotification", "Failed to import {0}!"), FText::FromString(AssetFileName)));
+            Info.bFireAndForget = true;
+            Info.FadeOutDuration = 2.0f;
+            Info.ExpireDuration = 5.0f;
+
+            TSharedPtr<SNotificationItem> NotificationItem = FSlateNotificationManager::Get().AddNotification(Info);
+            if (NotificationItem.IsValid())
             {
-                TempPendingTasks.Enqueue(Task); 
-                PendingTasks.Enqueue(Task);   
-                return true; 
+                NotificationItem->SetCompletionState(SNotificationItem::CS_Fail);
             }
-
-            TempPendingTasks.Enqueue(Task); // Save state 保存状态
         }
-
-        // Recovery queue 恢复队列
-        while (!TempPendingTasks.IsEmpty())
+        break;
+    case EAssetImportState::Cancelled:
+        DownloadStatusText->SetText(LOCTEXT("ImportCancelled", "Import Cancelled"));
+        if (ParentContainer.IsValid())
         {
-            TempPendingTasks.Dequeue(Task);
-            PendingTasks.Enqueue(Task);
+            ParentContainer.Pin()->RemoveSlot(SharedThis(this));
         }
+        break;
+    default:
+        break;
     }
+}
 
-    // Check the suspended task queue 检查暂停任务队列
+FText SAssetDownloadWidget::GetStatusToolTipText() const
+{
+    if (!Job.IsValid() || Job->GetTotalBytes() <= 0)
     {
-        FScopeLock Lock(&PausedTasksMutex);
-        for (const TWeakPtr<SAssetDownloadWidget>& WeakTask : PausedTasks)
-        {
-            if (TSharedPtr<SAssetDownloadWidget> Task = WeakTask.Pin())
-            {
-                if (Task->AssetFileName.Equals(FileName, ESearchCase::IgnoreCase))
-                {
-                    return true; 
-                }
-            }
-        }
+        return FText::GetEmpty();
     }
 
-    return false; // The file is not in any queue 文件未在任何队列中
+    // Built only while the tooltip is shown 仅在显示提示时生成
+    const FAssetDownloadStats Stats = Job->GetStats();
+    return FText::Format(LOCTEXT("ChunkSizeTooltip", "Chunk size: {0} KB\nRetries: {1}\nTime to first byte: {2} ms avg\nRange latency: {3} ms p50, {4} ms p95"),
+        FText::AsNumber(Job->GetCurrentChunkSize() / 1024), FText::AsNumber(Job->GetRetryCount()),
+        FText::AsNumber(FMath::RoundToInt(Stats.TimeToFirstByte.GetAverage() * 1000.0)),
+        FText::AsNumber(FMath::RoundToInt(Stats.RangeLatency.GetPercentile(0.5) * 1000.0)),
+        FText::AsNumber(FMath::RoundToInt(Stats.RangeLatency.GetPercentile(0.95) * 1000.0)));
+}
+
+bool SAssetDownloadWidget::IsFileDownloading(const FString& FilePath)
+{
+    // Queued, running, paused and failed jobs all count as downloading 排队、下载中、暂停和失败的任务都视为下载中
+    UAssetDownloadSubsystem* DownloadSubsystem = UAssetDownloadSubsystem::Get();
+    return DownloadSubsystem && DownloadSubsystem->IsFileDownloading(FPaths::GetCleanFilename(FilePath));
 }
 
 
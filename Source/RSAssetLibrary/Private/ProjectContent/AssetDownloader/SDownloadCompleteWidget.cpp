@@ -3,6 +3,7 @@
 #include "ProjectContent/AssetDownloader/SDownloadCompleteWidget.h"
 
 #include "RSAssetLibraryStyle.h"
+#include "AssetDownloader.h"
 #include "Widgets/SBoxPanel.h"
 #include "Widgets/Text/STextBlock.h"
 #include "Widgets/DeclarativeSyntaxSupport.h"
@@ -11,12 +12,19 @@
 #include "Misc/Paths.h"
 #include "HAL/PlatformFilemanager.h"
 #include "HAL/FileManager.h"
+#include "Widgets/Notifications/SProgressBar.h"
 
 
 #define LOCTEXT_NAMESPACE "SDownloadCompleteWidget"
 
 void SDownloadCompleteWidget::Construct(const FArguments& InArgs)
 {
+    OnResumeDownload = InArgs._OnResumeDownload;
+
+    ResumeButtonStyle.SetNormal(*FRSAssetLibraryStyle::Get().GetBrush("RSAssetLibrary.BeginIcon"));
+    ResumeButtonStyle.SetHovered(*FRSAssetLibraryStyle::Get().GetBrush("RSAssetLibrary.BeginClicked"));
+    ResumeButtonStyle.SetPressed(*FRSAssetLibraryStyle::Get().GetBrush("RSAssetLibrary.BeginClicked"));
+
     // Create the vertical box to hold the completed download entries
     ChildSlot
     [
@@ -29,6 +37,9 @@ void SDownloadCompleteWidget::Construct(const FArguments& InArgs)
     
     // Load the downloaded files in the folder each time you open the plugin 每次打开插件时加载文件夹中的已下载文件
     LoadCompletedDownloadsFromFolder();
+
+    // Partial downloads from an earlier session are listed on top 上次会话中断的下载显示在最上方
+    LoadInterruptedDownloadsFromFolder();
 }
 
 FString SDownloadCompleteWidget::TruncateText(const FString& OriginalText, int32 MaxLength)
@@ -193,6 +204,13 @@ void SDownloadCompleteWidget::LoadCompletedDownloadsFromFolder()
 
         // Construct the complete file path 构造完整的文件路径
         FString FilePath = FPaths::Combine(FolderPath, FileName);
+
+        // Journals, partial and corrupt files are not complete downloads 日志文件、未完成及损坏的文件不是已完成的下载
+        if (FDownloadJournal::IsJournalFile(FilePath) || FPaths::FileExists(FDownloadJournal::GetJournalPath(FilePath))
+            || UAssetDownloader::IsCorruptFile(FilePath) || UAssetDownloader::IsPartFile(FilePath))
+        {
+            continue;
+        }
         
         int64 FileSize = FileManager.FileSize(*FilePath);
         FString FileSizeText;
@@ -219,5 +237,106 @@ void SDownloadCompleteWidget::LoadCompletedDownloadsFromFolder()
     }
 }
 
+void SDownloadCompleteWidget::LoadInterruptedDownloadsFromFolder()
+{
+    FString FolderPath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("RspaceAssetsLibrary"));
+    if (!FPaths::DirectoryExists(FolderPath))
+    {
+        return;
+    }
+
+    for (const FDownloadJournal& InterruptedJournal : FDownloadJournal::FindInterruptedDownloads(FolderPath))
+    {
+        AddInterruptedDownload(InterruptedJournal);
+    }
+}
+
+void SDownloadCompleteWidget::AddInterruptedDownload(const FDownloadJournal& InJournal)
+{
+    const float Progress = InJournal.FileSize > 0 ? (float)InJournal.GetCompletedBytes() / (float)InJournal.FileSize : 0.0f;
+    const FText StatusText = FText::Format(LOCTEXT("InterruptedStatus", "Interrupted {0}"), FText::AsPercent(Progress));
+
+    // The row is only known after construction, so the button reaches it through this holder 行控件构造后才可用，按钮通过该持有者访问
+    TSharedRef<TWeakPtr<SHorizontalBox>> RowHolder = MakeShared<TWeakPtr<SHorizontalBox>>();
+
+    TSharedRef<SHorizontalBox> InterruptedDownloadBox = SNew(SHorizontalBox)
+        + SHorizontalBox::Slot()
+        .Padding(10, 5, 5, 5)
+        .FillWidth(1.0f)
+        [
+            SNew(SVerticalBox)
+            + SVerticalBox::Slot()
+            .VAlign(VAlign_Center)
+            [
+                SNew(STextBlock)
+                .Text(FText::FromString(TruncateText(InJournal.FileName, 20)))
+                .ColorAndOpacity(FSlateColor(FLinearColor::White))
+            ]
+        ]
+
+        + SHorizontalBox::Slot()
+        .AutoWidth()
+        .Padding(70, 5, 5, 5)
+        [
+            SNew(SHorizontalBox)
+            + SHorizontalBox::Slot()
+            .AutoWidth()
+            .Padding(10, 5, 5, 5)
+            [
+                SNew(SButton)
+                .Cursor(EMouseCursor::Hand)
+                .ButtonStyle(&ResumeButtonStyle)
+                .ContentPadding(0)
+                .ToolTipText(LOCTEXT("ResumeInterruptedToolTip", "Resume Download"))
+                .OnClicked_Lambda([this, InJournal, RowHolder]() -> FReply
+                {
+                    // The row moves back to the download queue 该条目移回下载队列
+                    if (CompletedDownloadsContainer.IsValid() && RowHolder->IsValid())
+                    {
+                        CompletedDownloadsContainer->RemoveSlot(RowHolder->Pin().ToSharedRef());
+                    }
+                    OnResumeDownload.ExecuteIfBound(InJournal.FileName, InJournal.URL, InJournal.MD5);
+                    return FReply::Handled();
+                })
+            ]
+        ]
+
+        + SHorizontalBox::Slot()
+        .Padding(98, 5, 5, 5)
+        .FillWidth(1.0f)
+        .VAlign(VAlign_Center)
+        [
+            SNew(STextBlock)
+            .Text(StatusText)
+            .ColorAndOpacity(FSlateColor(FLinearColor::Gray))
+        ]
+
+        + SHorizontalBox::Slot()
+        .Padding(20, 5, 5, 5)
+        .AutoWidth()
+        .VAlign(VAlign_Center)
+        [
+            SNew(SBox)
+            .HeightOverride(4.0f)
+            .WidthOverride(106.0f)
+            [
+                SNew(SProgressBar)
+                .Style(&FRSAssetLibraryStyle::Get().GetWidgetStyle<FProgressBarStyle>("RSAssetLibrary.CustomProgressBar"))
+                .Percent(Progress)
+            ]
+        ];
+    *RowHolder = InterruptedDownloadBox;
+
+    if (CompletedDownloadsContainer.IsValid())
+    {
+        CompletedDownloadsContainer->InsertSlot(0)
+        .AutoHeight()
+        .Padding(5)
+        [
+            InterruptedDownloadBox
+        ];
+    }
+}
+
 
 #undef LOCTEXT_NAMESPACE
\ No newline at end of file
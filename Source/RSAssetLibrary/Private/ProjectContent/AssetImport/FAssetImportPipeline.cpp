@@ -0,0 +1,431 @@
+﻿// Copyright (c) 2024 Hunan MangoXR Tech Co., Ltd. All Rights Reserved.
+
+#include "ProjectContent/AssetImport/FAssetImportPipeline.h"
+#include "Async/Async.h"
+#include "Downloader/AssetDownloadBatch.h"
+#include "Framework/Notifications/NotificationManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/Paths.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "UObject/Package.h"
+#include "Widgets/Notifications/SNotificationList.h"
+
+#define LOCTEXT_NAMESPACE "FAssetImportPipeline"
+
+static TAutoConsoleVariable<float> CVarImportFrameBudgetMs(
+    TEXT("RSAsset.ImportFrameBudgetMs"),
+    8.0f,
+    TEXT("Game thread time in milliseconds spent creating imported assets per frame. At least one asset is created each frame."));
+
+static TAutoConsoleVariable<int32> CVarImportMaxConcurrentPrepares(
+    TEXT("RSAsset.ImportMaxConcurrentPrepares"),
+    0,
+    TEXT("Files read and decoded at the same time. 0 uses one per task graph worker thread."));
+
+FAssetImportPipeline& FAssetImportPipeline::Get()
+{
+    static FAssetImportPipeline Pipeline;
+    return Pipeline;
+}
+
+void FAssetImportPipeline::BindToDownloads()
+{
+    if (JobStateChangedHandle.IsValid())
+    {
+        return;
+    }
+
+    if (UAssetDownloadSubsystem* DownloadSubsystem = UAssetDownloadSubsystem::Get())
+    {
+        JobStateChangedHandle = DownloadSubsystem->OnJobStateChanged.AddRaw(this, &FAssetImportPipeline::HandleJobStateChanged);
+    }
+}
+
+void FAssetImportPipeline::DownloadAndImport(const FString& FileName, const FString& URL, const FString& MD5, EAssetImportKind Kind)
+{
+    UAssetDownloadSubsystem* DownloadSubsystem = UAssetDownloadSubsystem::Get();
+    const FString FilePath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("RspaceAssetsLibrary"), FileName);
+
+    // A file that is downloaded already is imported right away 已下载的文件直接导入
+    if (FPaths::FileExists(FilePath) && (!DownloadSubsystem || !DownloadSubsystem->IsFileDownloading(FileName)))
+    {
+        ImportFile(FilePath, Kind);
+        return;
+    }
+
+    if (!DownloadSubsystem || URL.IsEmpty())
+    {
+        UE_LOG(LogTemp, Warning, TEXT("Cannot download %s for import."), *FileName);
+        return;
+    }
+
+    // Registered before queueing, since a job served from the content store completes at once 先登记再入队，内容库命中的任务会立即完成
+    BindToDownloads();
+    PendingDownloads.Add(FileName, Kind);
+    SetImportState(FileName, EAssetImportState::WaitingForDownload);
+
+    UAssetDownloadJob* Job = DownloadSubsystem->EnqueueDownload(URL, FileName, MD5, EAssetDownloadPriority::High);
+    if (!Job && PendingDownloads.Remove(FileName) > 0)
+    {
+        SetImportState(FileName, EAssetImportState::None);
+    }
+}
+
+void FAssetImportPipeline::ImportWhenDownloaded(const FString& FileName, EAssetImportKind Kind)
+{
+    UAssetDownloadSubsystem* DownloadSubsystem = UAssetDownloadSubsystem::Get();
+    if (!DownloadSubsystem || !DownloadSubsystem->IsFileDownloading(FileName))
+    {
+        ImportFile(FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("RspaceAssetsLibrary"), FileName), Kind);
+        return;
+    }
+
+    BindToDownloads();
+    PendingDownloads.Add(FileName, Kind);
+    SetImportState(FileName, EAssetImportState::WaitingForDownload);
+}
+
+void FAssetImportPipeline::ImportFile(const FString& FilePath, EAssetImportKind Kind)
+{
+    if (!FPaths::FileExists(FilePath))
+    {
+        UE_LOG(LogTemp, Warning, TEXT("Cannot import %s, the file does not exist."), *FilePath);
+        SetImportState(FPaths::GetCleanFilename(FilePath), EAssetImportState::Failed);
+        return;
+    }
+
+    QueueImport(FilePath, Kind);
+}
+
+void FAssetImportPipeline::DownloadAndImportModelFolder(const FString& Ticket, const FString& Uuid, const FString& ProjectNo, int32 FolderId, const FString& FolderName)
+{
+    if (UAssetDownloadSubsystem* DownloadSubsystem = UAssetDownloadSubsystem::Get())
+    {
+        BindToDownloads();
+        AddBatch(DownloadSubsystem->EnqueueModelFolder(Ticket, Uuid, ProjectNo, FolderId, FolderName));
+    }
+}
+
+void FAssetImportPipeline::DownloadAndImportVideoFolder(const FString& Ticket, const FString& ProjectNo, const FString& FolderNo, const FString& FolderName)
+{
+    if (UAssetDownloadSubsystem* DownloadSubsystem = UAssetDownloadSubsystem::Get())
+    {
+        BindToDownloads();
+        AddBatch(DownloadSubsystem->EnqueueVideoFolder(Ticket, ProjectNo, FolderNo, FolderName));
+    }
+}
+
+void FAssetImportPipeline::AddBatch(UAssetDownloadBatch* Batch)
+{
+    if (Batch)
+    {
+        // Batches the subsystem dropped are forgotten here as well 子系统释放的批次在此一并移除
+        ImportBatches.RemoveAll([](const TWeakObjectPtr<UAssetDownloadBatch>& ImportBatch) { return !ImportBatch.IsValid(); });
+        ImportBatches.AddUnique(Batch);
+    }
+}
+
+EAssetImportState FAssetImportPipeline::GetImportState(const FString& FileName) const
+{
+    const EAssetImportState* State = ImportStates.Find(FileName);
+    return State ? *State : EAssetImportState::None;
+}
+
+bool FAssetImportPipeline::IsImportPending(const FString& FileName) const
+{
+    const EAssetImportState State = GetImportState(FileName);
+    return State == EAssetImportState::WaitingForDownload || State == EAssetImportState::Queued || State == EAssetImportState::Importing;
+}
+
+void FAssetImportPipeline::HandleJobStateChanged(UAssetDownloadJob* Job, EAssetDownloadState PreviousState)
+{
+    const FString& FileName = Job->GetFileName();
+
+    if (Job->GetState() == EAssetDownloadState::Cancelled)
+    {
+        if (PendingDownloads.Remove(FileName) > 0)
+        {
+            SetImportState(FileName, EAssetImportState::None);
+        }
+        return;
+    }
+
+    // A failed job keeps its import, it is imported when the retry completes 失败的任务保留导入，重试完成后导入
+    if (Job->GetState() != EAssetDownloadState::Completed)
+    {
+        return;
+    }
+
+    EAssetImportKind Kind;
+    if (PendingDownloads.RemoveAndCopyValue(FileName, Kind))
+    {
+        QueueImport(Job->GetFilePath(), Kind);
+        return;
+    }
+
+    for (const TWeakObjectPtr<UAssetDownloadBatch>& Batch : ImportBatches)
+    {
+        if (Batch.IsValid() && Batch->ContainsJob(Job))
+        {
+            if (FAssetImporter::GetImportKindForFile(FileName, Kind))
+            {
+                QueueImport(Job->GetFilePath(), Kind);
+            }
+            return;
+        }
+    }
+}
+
+void FAssetImportPipeline::QueueImport(const FString& FilePath, EAssetImportKind Kind)
+{
+    const FString FileName = FPaths::GetCleanFilename(FilePath);
+    auto IsSameFile = [&FilePath](const TSharedRef<FImportTask>& Task) { return Task->FilePath == FilePath; };
+    if (QueuedTasks.ContainsByPredicate(IsSameFile) || PreparingTasks.ContainsByPredicate(IsSameFile))
+    {
+        return;
+    }
+
+    // Nothing is read for a file that was imported before 之前导入过的文件不再读取
+    if (FAssetImporter::IsImported(Kind, FilePath))
+    {
+        UE_LOG(LogTemp, Log, TEXT("Asset already exists, skipping import: %s"), *FAssetImporter::GetPackageName(Kind, FilePath));
+        SetImportState(FileName, EAssetImportState::Imported);
+        return;
+    }
+
+    TSharedRef<FImportTask> Task = MakeShared<FImportTask>();
+    Task->FilePath = FilePath;
+    Task->Kind = Kind;
+    QueuedTasks.Add(Task);
+    ++NumRunTasks;
+    SetImportState(FileName, EAssetImportState::Queued);
+
+    if (!TickerHandle.IsValid())
+    {
+        FAssetImporter::LoadImportModules();
+        TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FAssetImportPipeline::ProcessImportQueue));
+    }
+    StartPrepares();
+    UpdateNotification();
+}
+
+int32 FAssetImportPipeline::GetMaxConcurrentPrepares()
+{
+    const int32 MaxConcurrentPrepares = CVarImportMaxConcurrentPrepares.GetValueOnGameThread();
+    return MaxConcurrentPrepares > 0 ? MaxConcurrentPrepares : FMath::Max(1, FTaskGraphInterface::Get().GetNumWorkerThreads());
+}
+
+void FAssetImportPipeline::StartPrepares()
+{
+    const int32 MaxConcurrentPrepares = GetMaxConcurrentPrepares();
+    while (QueuedTasks.Num() > 0 && PreparingTasks.Num() < MaxConcurrentPrepares)
+    {
+        TSharedRef<FImportTask> Task = QueuedTasks[0];
+        QueuedTasks.RemoveAt(0);
+        PreparingTasks.Add(Task);
+        SetImportState(FPaths::GetCleanFilename(Task->FilePath), EAssetImportState::Importing);
+
+        // The worker only fills the task, the game thread picks it up on its next tick 工作线程只填充任务，游戏线程在下一次 Tick 时取走
+        Async(EAsyncExecution::TaskGraph, [Task]()
+        {
+            if (!Task->bCancelled)
+            {
+                Task->Payload = FAssetImporter::Prepare(Task->Kind, Task->FilePath);
+            }
+            Task->bPrepared = true;
+        });
+    }
+}
+
+bool FAssetImportPipeline::ProcessImportQueue(float DeltaTime)
+{
+    const double Deadline = FPlatformTime::Seconds() + CVarImportFrameBudgetMs.GetValueOnGameThread() / 1000.0;
+
+    // Assets are created in queue order while the frame budget lasts, at least one per frame 在帧预算内按队列顺序创建资产，每帧至少一个
+    bool bCreatedAny = false;
+    for (int32 Index = 0; Index < PreparingTasks.Num(); )
+    {
+        TSharedRef<FImportTask> Task = PreparingTasks[Index];
+        if (!Task->bPrepared)
+        {
+            ++Index;
+            continue;
+        }
+        if (bCreatedAny && FPlatformTime::Seconds() >= Deadline)
+        {
+            break;
+        }
+
+        PreparingTasks.RemoveAt(Index);
+        bCreatedAny = true;
+
+        UPackage* Package = Task->Payload.IsValid() ? FAssetImporter::CreateAsset(*Task->Payload) : nullptr;
+        Task->Payload.Reset();
+        ++NumRunFinished;
+        if (Package)
+        {
+            CreatedPackages.AddUnique(Package);
+            SetImportState(FPaths::GetCleanFilename(Task->FilePath), EAssetImportState::Imported);
+        }
+        else
+        {
+            ++NumRunFailed;
+            SetImportState(FPaths::GetCleanFilename(Task->FilePath), EAssetImportState::Failed);
+        }
+    }
+
+    StartPrepares();
+
+    if (QueuedTasks.Num() == 0 && PreparingTasks.Num() == 0)
+    {
+        FinishRun(false);
+        TickerHandle.Reset();
+        return false;
+    }
+
+    if (bCreatedAny)
+    {
+        UpdateNotification();
+    }
+    return true;
+}
+
+void FAssetImportPipeline::FinishRun(bool bWasCancelled)
+{
+    TArray<UPackage*> Packages;
+    for (const TWeakObjectPtr<UPackage>& Package : CreatedPackages)
+    {
+        if (Package.IsValid())
+        {
+            Packages.Add(Package.Get());
+        }
+    }
+    CreatedPackages.Reset();
+
+    const bool bSaved = FAssetImporter::SavePackages(Packages);
+
+    TSharedPtr<SNotificationItem> Notification = ProgressNotification.Pin();
+    if (Notification.IsValid())
+    {
+        const bool bSucceeded = bSaved && NumRunFailed == 0 && !bWasCancelled;
+        if (bWasCancelled)
+        {
+            Notification->SetText(FText::Format(LOCTEXT("ImportRunCancelled", "Import cancelled, {0} assets imported"), FText::AsNumber(Packages.Num())));
+        }
+        else
+        {
+            Notification->SetText(bSucceeded
+                ? FText::Format(LOCTEXT("ImportRunFinished", "Imported {0} assets"), FText::AsNumber(Packages.Num()))
+                : FText::Format(LOCTEXT("ImportRunFinishedWithErrors", "Imported {0} assets, {1} failed"), FText::AsNumber(Packages.Num()), FText::AsNumber(NumRunFailed)));
+        }
+        Notification->SetCompletionState(bSucceeded ? SNotificationItem::CS_Success : SNotificationItem::CS_Fail);
+        Notification->ExpireAndFadeout();
+    }
+    ProgressNotification.Reset();
+
+    NumRunTasks = 0;
+    NumRunFinished = 0;
+    NumRunFailed = 0;
+}
+
+void FAssetImportPipeline::CancelImports()
+{
+    // Workers that are still reading finish in the background, their result is dropped 仍在读取的工作线程在后台结束，结果被丢弃
+    for (const TSharedRef<FImportTask>& Task : QueuedTasks)
+    {
+        SetImportState(FPaths::GetCleanFilename(Task->FilePath), EAssetImportState::Cancelled);
+    }
+    for (const TSharedRef<FImportTask>& Task : PreparingTasks)
+    {
+        Task->bCancelled = true;
+        SetImportState(FPaths::GetCleanFilename(Task->FilePath), EAssetImportState::Cancelled);
+    }
+    QueuedTasks.Reset();
+    PreparingTasks.Reset();
+
+    if (TickerHandle.IsValid())
+    {
+        FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+        TickerHandle.Reset();
+    }
+    FinishRun(true);
+}
+
+void FAssetImportPipeline::UpdateNotification()
+{
+    const FText ProgressText = FText::Format(LOCTEXT("ImportProgress", "Importing assets ({0}/{1})"), FText::AsNumber(NumRunFinished), FText::AsNumber(NumRunTasks));
+
+    TSharedPtr<SNotificationItem> Notification = ProgressNotification.Pin();
+    if (Notification.IsValid())
+    {
+        Notification->SetText(ProgressText);
+        return;
+    }
+
+    FNotificationInfo Info(ProgressText);
+    Info.bFireAndForget = false;
+    Info.FadeOutDuration = 2.0f;
+    Info.ExpireDuration = 5.0f;
+    Info.ButtonDetails.Add(FNotificationButtonInfo(
+        LOCTEXT("CancelImport", "Cancel"),
+        LOCTEXT("CancelImportTooltip", "Stop importing; assets already created are kept"),
+        FSimpleDelegate::CreateRaw(this, &FAssetImportPipeline::CancelImports),
+        SNotificationItem::CS_Pending));
+
+    Notification = FSlateNotificationManager::Get().AddNotification(Info);
+    if (Notification.IsValid())
+    {
+        Notification->SetCompletionState(SNotificationItem::CS_Pending);
+    }
+    ProgressNotification = Notification;
+}
+
+void FAssetImportPipeline::SetImportState(const FString& FileName, EAssetImportState State)
+{
+    if (State == EAssetImportState::None)
+    {
+        ImportStates.Remove(FileName);
+    }
+    else
+    {
+        ImportStates.Add(FileName, State);
+    }
+    OnImportStateChanged.Broadcast(FileName, State);
+}
+
+void FAssetImportPipeline::Shutdown()
+{
+    if (TickerHandle.IsValid())
+    {
+        FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+        TickerHandle.Reset();
+    }
+
+    if (JobStateChangedHandle.IsValid())
+    {
+        if (UAssetDownloadSubsystem* DownloadSubsystem = UAssetDownloadSubsystem::Get())
+        {
+            DownloadSubsystem->OnJobStateChanged.Remove(JobStateChangedHandle);
+        }
+        JobStateChangedHandle.Reset();
+    }
+
+    for (const TSharedRef<FImportTask>& Task : PreparingTasks)
+    {
+        Task->bCancelled = true;
+    }
+
+    PendingDownloads.Reset();
+    ImportBatches.Reset();
+    QueuedTasks.Reset();
+    PreparingTasks.Reset();
+    CreatedPackages.Reset();
+    ImportStates.Reset();
+    ProgressNotification.Reset();
+    NumRunTasks = 0;
+    NumRunFinished = 0;
+    NumRunFailed = 0;
+    OnImportStateChanged.Clear();
+}
+
+#undef LOCTEXT_NAMESPACE
@@ -0,0 +1,414 @@
+﻿// Copyright (c) 2024 Hunan MangoXR Tech Co., Ltd. All Rights Reserved.
+
+#include "ProjectContent/AssetImport/FAssetImporter.h"
+#include "AssetRegistry/AssetRegistryModule.h"
+#include "Audio.h"
+#include "Engine/StaticMesh.h"
+#include "Engine/Texture2D.h"
+#include "Factories/FbxFactory.h"
+#include "Factories/FbxImportUI.h"
+#include "Factories/FbxStaticMeshImportData.h"
+#include "FileHelpers.h"
+#include "FileMediaSource.h"
+#include "HAL/IConsoleManager.h"
+#include "IImageWrapper.h"
+#include "IImageWrapperModule.h"
+#include "ImageCoreUtils.h"
+#include "Memory/SharedBuffer.h"
+#include "Misc/FileHelper.h"
+#include "Misc/PackageName.h"
+#include "Misc/Paths.h"
+#include "Modules/ModuleManager.h"
+#include "Sound/SoundWave.h"
+#include "UObject/Package.h"
+
+static TAutoConsoleVariable<bool> CVarImportImageMips(
+    TEXT("RSAsset.ImportImageMips"),
+    true,
+    TEXT("Whether imported concept images get a mip chain. Without mips the texture keeps only its full resolution."));
+
+static TAutoConsoleVariable<int32> CVarImportImageCompression(
+    TEXT("RSAsset.ImportImageCompression"),
+    0,
+    TEXT("Compression of imported 8-bit colour concept images: 0 = default (DXT), 1 = BC7, 2 = uncompressed. HDR and grayscale images always use their own settings."));
+
+FString FAssetImporter::GetPackageName(EAssetImportKind Kind, const FString& FilePath)
+{
+    // Dots in the file name are not allowed in asset names 资产名中不能包含文件名里的点
+    const FString BaseName = FPaths::GetBaseFilename(FilePath).Replace(TEXT("."), TEXT("_"));
+
+    switch (Kind)
+    {
+    case EAssetImportKind::Model:
+        return TEXT("/Game/RSpaceImportedAssets/Models/") + BaseName;
+    case EAssetImportKind::Audio:
+        return TEXT("/Game/RSpaceImportedAssets/Audios/") + BaseName.Replace(TEXT(" "), TEXT("_"));
+    case EAssetImportKind::Video:
+        return TEXT("/Game/RSpaceImportedAssets/Videos/") + BaseName.Replace(TEXT(" "), TEXT("_"));
+    case EAssetImportKind::Concept:
+        return TEXT("/Game/RSpaceImportedAssets/Images/") + BaseName;
+    }
+    return FString();
+}
+
+bool FAssetImporter::IsImported(EAssetImportKind Kind, const FString& FilePath)
+{
+    // Packages created by the running batch are not saved yet, so memory is checked as well 当前批次创建的包尚未保存，因此同时检查内存
+    const FString PackageName = GetPackageName(Kind, FilePath);
+    if (UPackage* Package = FindPackage(nullptr, *PackageName))
+    {
+        // A failed import leaves its package behind without the asset 导入失败时包仍然存在，但其中没有资产
+        if (FindObject<UObject>(Package, *FPackageName::GetShortName(PackageName)))
+        {
+            return true;
+        }
+    }
+    return FPackageName::DoesPackageExist(PackageName);
+}
+
+void FAssetImporter::LoadImportModules()
+{
+    FModuleManager::LoadModuleChecked<IImageWrapperModule>(TEXT("ImageWrapper"));
+}
+
+bool FAssetImporter::GetImportKindForFile(const FString& FilePath, EAssetImportKind& OutKind)
+{
+    static const TArray<FString> ModelExtensions = { TEXT("fbx"), TEXT("obj") };
+    static const TArray<FString> AudioExtensions = { TEXT("wav"), TEXT("aiff"), TEXT("flac"), TEXT("ogg"), TEXT("mp3"), TEXT("m4a") };
+    static const TArray<FString> VideoExtensions = { TEXT("mp4"), TEXT("mov"), TEXT("avi"), TEXT("wmv"), TEXT("mkv"), TEXT("webm") };
+    static const TArray<FString> ConceptExtensions = { TEXT("png"), TEXT("jpg"), TEXT("jpeg"), TEXT("bmp"), TEXT("exr") };
+
+    const FString Extension = FPaths::GetExtension(FilePath).ToLower();
+    if (ModelExtensions.Contains(Extension))
+    {
+        OutKind = EAssetImportKind::Model;
+    }
+    else if (AudioExtensions.Contains(Extension))
+    {
+        OutKind = EAssetImportKind::Audio;
+    }
+    else if (VideoExtensions.Contains(Extension))
+    {
+        OutKind = EAssetImportKind::Video;
+    }
+    else if (ConceptExtensions.Contains(Extension))
+    {
+        OutKind = EAssetImportKind::Concept;
+    }
+    else
+    {
+        return false;
+    }
+    return true;
+}
+
+bool FAssetImporter::IsWaveFormat(const FString& FilePath)
+{
+    const FString FileExtension = FPaths::GetExtension(FilePath).ToLower();
+    return FileExtension == TEXT("wav") || FileExtension == TEXT("aiff") || FileExtension == TEXT("flac") || FileExtension == TEXT("ogg");
+}
+
+TSharedPtr<FAssetImportPayload> FAssetImporter::Prepare(EAssetImportKind Kind, const FString& FilePath)
+{
+    TSharedPtr<FAssetImportPayload> Payload = MakeShared<FAssetImportPayload>();
+    Payload->Kind = Kind;
+    Payload->FilePath = FilePath;
+    Payload->PackageName = GetPackageName(Kind, FilePath);
+    Payload->AssetName = FPackageName::GetShortName(Payload->PackageName);
+
+    // Models and media sources have nothing to decode, the game thread does all of their work 模型和媒体源无需解码，全部在游戏线程完成
+    bool bPrepared = true;
+    if (Kind == EAssetImportKind::Audio && IsWaveFormat(FilePath))
+    {
+        bPrepared = PrepareWave(*Payload);
+    }
+    else if (Kind == EAssetImportKind::Concept)
+    {
+        bPrepared = PrepareImage(*Payload);
+    }
+    return bPrepared ? Payload : nullptr;
+}
+
+bool FAssetImporter::PrepareWave(FAssetImportPayload& Payload)
+{
+    // Read audio file data 读取音频文件数据
+    TArray<uint8> AudioData;
+    if (!FFileHelper::LoadFileToArray(AudioData, *Payload.FilePath))
+    {
+        UE_LOG(LogTemp, Error, TEXT("Failed to load audio file: %s"), *Payload.FilePath);
+        return false;
+    }
+
+    // Using FWaveModInfo to parse WAV files, you can continue to extend the parsing logic for other formats 使用 FWaveModInfo 解析 WAV 文件，针对其他格式可以继续扩展解析逻辑
+    FWaveModInfo WaveInfo;
+    if (!WaveInfo.ReadWaveInfo(AudioData.GetData(), AudioData.Num()))
+    {
+        UE_LOG(LogTemp, Error, TEXT("Failed to parse audio file: %s"), *Payload.FilePath);
+        return false;
+    }
+
+    const int32 BitsPerSample = *WaveInfo.pBitsPerSample;
+    const int32 Channels = *WaveInfo.pChannels;
+    const int32 SampleRate = *WaveInfo.pSamplesPerSec;
+    const int32 DataSize = WaveInfo.SampleDataSize;
+
+    if (BitsPerSample / 8 == 0 || Channels == 0 || SampleRate == 0 || DataSize == 0)
+    {
+        UE_LOG(LogTemp, Error, TEXT("Invalid audio file data."));
+        return false;
+    }
+
+    const int32 SizeOfSample = BitsPerSample / 8;
+    const int32 TotalSamples = DataSize / SizeOfSample;
+    const int32 Frames = TotalSamples / Channels;
+
+    Payload.Duration = static_cast<float>(Frames) / SampleRate;
+    Payload.NumChannels = Channels;
+    Payload.SampleRate = SampleRate;
+    Payload.PCMData.Append(WaveInfo.SampleDataStart, DataSize);
+    return true;
+}
+
+bool FAssetImporter::PrepareImage(FAssetImportPayload& Payload)
+{
+    // Load files into memory 加载文件到内存
+    TArray64<uint8> FileData;
+    if (!FFileHelper::LoadFileToArray(FileData, *Payload.FilePath))
+    {
+        UE_LOG(LogTemp, Error, TEXT("Failed to load file: %s"), *Payload.FilePath);
+        return false;
+    }
+
+    // Detection image format 检测图像格式
+    IImageWrapperModule& ImageWrapperModule = FModuleManager::GetModuleChecked<IImageWrapperModule>(TEXT("ImageWrapper"));
+    EImageFormat ImageFormat = ImageWrapperModule.DetectImageFormat(FileData.GetData(), FileData.Num());
+    if (ImageFormat == EImageFormat::Invalid)
+    {
+        UE_LOG(LogTemp, Error, TEXT("Unrecognized image format: %s"), *Payload.FilePath);
+        return false;
+    }
+
+    // Create an image wrapper 创建图像包装
+    TSharedPtr<IImageWrapper> ImageWrapper = ImageWrapperModule.CreateImageWrapper(ImageFormat);
+    if (!ImageWrapper.IsValid() || !ImageWrapper->SetCompressed(FileData.GetData(), FileData.Num()))
+    {
+        UE_LOG(LogTemp, Error, TEXT("Failed to create image wrapper: %s"), *Payload.FilePath);
+        return false;
+    }
+
+    // The wrapper keeps its own copy of the compressed bytes 图像包装持有压缩数据的副本
+    FileData.Empty();
+
+    // Decode in the file's own format, the decoded buffer is moved instead of copied 按文件原始格式解码，解码缓冲区以移动代替复制
+    if (!ImageWrapper->GetRawImage(Payload.Image))
+    {
+        UE_LOG(LogTemp, Error, TEXT("Failed to decompress image data: %s"), *Payload.FilePath);
+        return false;
+    }
+
+    // Texture sources have no layout for a few decoded formats, those are converted here rather than on the game thread 少数解码格式没有对应的纹理源格式，在此转换而不是在游戏线程
+    if (FImageCoreUtils::ConvertToTextureSourceFormat(Payload.Image.Format) == TSF_Invalid)
+    {
+        Payload.Image.ChangeFormat(ERawImageFormat::BGRA8, EGammaSpace::sRGB);
+    }
+    return true;
+}
+
+UPackage* FAssetImporter::CreateAsset(FAssetImportPayload& Payload)
+{
+    check(IsInGameThread());
+
+    switch (Payload.Kind)
+    {
+    case EAssetImportKind::Model:
+        return CreateModel(Payload);
+    case EAssetImportKind::Audio:
+        return IsWaveFormat(Payload.FilePath) ? CreateSoundWave(Payload) : CreateFileMediaSource(Payload);
+    case EAssetImportKind::Video:
+        return CreateFileMediaSource(Payload);
+    case EAssetImportKind::Concept:
+        return CreateTexture(Payload);
+    }
+    return nullptr;
+}
+
+UPackage* FAssetImporter::CreateModel(const FAssetImportPayload& Payload)
+{
+    // Create package 创建包
+    UPackage* Package = CreatePackage(*Payload.PackageName);
+
+    // Configure import options 配置导入选项
+    UFbxFactory* FbxFactory = NewObject<UFbxFactory>(UFbxFactory::StaticClass());
+    FbxFactory->ImportUI->bAutomatedImportShouldDetectType = true; // Automatic detection type 自动检测类型
+    FbxFactory->ImportUI->bImportAsSkeletal = true;               // Nonskeletal model 非骨骼模型
+    FbxFactory->ImportUI->bImportMaterials = true;                // Import material 导入材质
+    FbxFactory->ImportUI->bImportTextures = true;                 // mport texture 导入纹理
+    FbxFactory->ImportUI->bImportAnimations = false;              // Do not import animation 不导入动画
+    FbxFactory->ImportUI->MeshTypeToImport = FBXIT_SkeletalMesh;  // Imported bone model 导入骨骼模型
+    FbxFactory->ImportUI->bImportMesh = true;                     // Lead-in grid 导入网格
+    FbxFactory->ImportUI->bAutoComputeLodDistances = true;
+    FbxFactory->ImportUI->StaticMeshImportData->bCombineMeshes = true;
+    FbxFactory->ImportUI->StaticMeshImportData->ImportUniformScale = 1.0f;
+    FbxFactory->ImportUI->StaticMeshImportData->bAutoGenerateCollision = true;
+
+    // Do not display dialog box, import directly 不显示对话框，直接导入
+    EObjectFlags Flags = RF_Transactional | RF_Public | RF_Standalone;
+
+    // Call the ImportObject method to import the asset 调用 ImportObject 方法导入资产
+    bool bOutCanceled = false;
+    const TCHAR* Parms = nullptr;
+    UObject* ImportedAsset = FbxFactory->ImportObject(UStaticMesh::StaticClass(), Package, FName(*Payload.AssetName), Flags, Payload.FilePath, Parms, bOutCanceled);
+
+    // Check whether the import is successful 检查导入是否成功
+    if (!ImportedAsset || bOutCanceled)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("FBX Import Failed or Canceled!"));
+        return nullptr;
+    }
+
+    UE_LOG(LogTemp, Log, TEXT("FBX Import Successful!"));
+    return Package;
+}
+
+UPackage* FAssetImporter::CreateSoundWave(const FAssetImportPayload& Payload)
+{
+    // Create an audio asset package 创建音频资产包
+    UPackage* Package = CreatePackage(*Payload.PackageName);
+    if (!Package)
+    {
+        UE_LOG(LogTemp, Error, TEXT("Failed to create package: %s"), *Payload.PackageName);
+        return nullptr;
+    }
+
+    // Create a USoundWave object 创建 USoundWave 对象
+    USoundWave* SoundWave = NewObject<USoundWave>(Package, *Payload.AssetName, RF_Public | RF_Standalone);
+    if (!SoundWave)
+    {
+        UE_LOG(LogTemp, Error, TEXT("Failed to create USoundWave asset."));
+        return nullptr;
+    }
+
+    // Fill in audio data and properties 填充音频数据和属性
+    SoundWave->Duration = Payload.Duration;
+    SoundWave->NumChannels = Payload.NumChannels;
+    SoundWave->SetSampleRate(Payload.SampleRate);
+    SoundWave->SoundGroup = ESoundGroup::SOUNDGROUP_Default;
+    SoundWave->DecompressionType = DTYPE_Setup;
+    SoundWave->RawPCMDataSize = Payload.PCMData.Num();
+    SoundWave->RawPCMData = static_cast<uint8*>(FMemory::Malloc(Payload.PCMData.Num()));
+    FMemory::Memcpy(SoundWave->RawPCMData, Payload.PCMData.GetData(), Payload.PCMData.Num());
+
+    // Mark the object as modified 标记对象已修改
+    SoundWave->MarkPackageDirty();
+
+    // Register assets to the asset registry 注册资产到资产注册表
+    FAssetRegistryModule::AssetCreated(SoundWave);
+
+    UE_LOG(LogTemp, Log, TEXT("Successfully imported audio file: %s"), *Payload.FilePath);
+    return Package;
+}
+
+UPackage* FAssetImporter::CreateFileMediaSource(const FAssetImportPayload& Payload)
+{
+    // Create package 创建包
+    UPackage* Package = CreatePackage(*Payload.PackageName);
+    if (!Package)
+    {
+        UE_LOG(LogTemp, Error, TEXT("Failed to create package for: %s"), *Payload.PackageName);
+        return nullptr;
+    }
+
+    // Create a FileMediaSource object 创建 FileMediaSource 对象
+    UFileMediaSource* FileMediaSource = NewObject<UFileMediaSource>(Package, UFileMediaSource::StaticClass(), FName(*Payload.AssetName), RF_Public | RF_Standalone);
+    if (!FileMediaSource)
+    {
+        UE_LOG(LogTemp, Error, TEXT("Failed to create UFileMediaSource object for: %s"), *Payload.FilePath);
+        return nullptr;
+    }
+
+    //Set file path  设置文件路径
+    FileMediaSource->SetFilePath(Payload.FilePath);
+    FileMediaSource->MarkPackageDirty();
+
+    // Register assets to the asset registry 注册资产到资产注册表
+    FAssetRegistryModule::AssetCreated(FileMediaSource);
+    UE_LOG(LogTemp, Log, TEXT("Successfully registered media source: %s"), *Payload.PackageName);
+    return Package;
+}
+
+UPackage* FAssetImporter::CreateTexture(FAssetImportPayload& Payload)
+{
+    // Create package 创建包
+    UPackage* Package = CreatePackage(*Payload.PackageName);
+    if (!Package)
+    {
+        UE_LOG(LogTemp, Error, TEXT("Failed to create package: %s"), *Payload.PackageName);
+        return nullptr;
+    }
+
+    // Create a UTexture2D object 创建 UTexture2D 对象
+    UTexture2D* LoadedTexture = NewObject<UTexture2D>(Package, FName(*Payload.AssetName), RF_Public | RF_Standalone);
+    if (!LoadedTexture)
+    {
+        UE_LOG(LogTemp, Error, TEXT("Failed to create texture object: %s"), *Payload.AssetName);
+        return nullptr;
+    }
+
+    // The decoded pixels become the source data without another copy 解码后的像素直接成为源数据，不再复制
+    FImage& Image = Payload.Image;
+    const ETextureSourceFormat SourceFormat = FImageCoreUtils::ConvertToTextureSourceFormat(Image.Format);
+    const bool bIsHDR = ERawImageFormat::IsHDR(Image.Format);
+    const bool bIsGrayscale = Image.Format == ERawImageFormat::G8 || Image.Format == ERawImageFormat::G16;
+    LoadedTexture->Source.Init(Image.SizeX, Image.SizeY, 1, 1, SourceFormat, MakeSharedBufferFromArray(MoveTemp(Image.RawData)));
+
+    // Set texture properties 设置纹理属性
+    LoadedTexture->SRGB = !bIsHDR && Image.GammaSpace == EGammaSpace::sRGB;
+    if (bIsHDR)
+    {
+        LoadedTexture->CompressionSettings = TC_HDR;
+    }
+    else if (bIsGrayscale)
+    {
+        LoadedTexture->CompressionSettings = TC_Grayscale;
+    }
+    else
+    {
+        switch (CVarImportImageCompression.GetValueOnGameThread())
+        {
+        case 1:
+            LoadedTexture->CompressionSettings = TC_BC7;
+            break;
+        case 2:
+            LoadedTexture->CompressionSettings = TC_EditorIcon;
+            break;
+        default:
+            LoadedTexture->CompressionSettings = TC_Default;
+            break;
+        }
+    }
+    LoadedTexture->MipGenSettings = CVarImportImageMips.GetValueOnGameThread() ? TMGS_FromTextureGroup : TMGS_NoMipmaps;
+
+    // Mips and compression are built by the texture compiler on worker threads 纹理编译器在工作线程上生成 Mip 并压缩
+    LoadedTexture->PostEditChange();
+
+    // Mark the package as dirty 标记包为脏
+    Package->MarkPackageDirty();
+    FAssetRegistryModule::AssetCreated(LoadedTexture);
+    return Package;
+}
+
+bool FAssetImporter::SavePackages(const TArray<UPackage*>& Packages)
+{
+    if (Packages.Num() == 0)
+    {
+        return true;
+    }
+
+    // One save pass for the whole batch instead of one per asset 整批只保存一次，而不是每个资产保存一次
+    const bool bSaved = UEditorLoadingAndSavingUtils::SavePackages(Packages, false);
+    if (!bSaved)
+    {
+        UE_LOG(LogTemp, Error, TEXT("Failed to save some of the %d imported packages."), Packages.Num());
+    }
+    return bSaved;
+}
@@ -3,16 +3,15 @@
 
 
 #include "ProjectContent/AudioAssets/SAudioAssetsWidget.h"
+#include "ProjectContent/AssetImport/FAssetImportPipeline.h"
 
 #include "FileMediaSource.h"
 #include "RSAssetLibraryStyle.h"
-#include "AssetRegistry/AssetRegistryModule.h"
 #include "AudioLibrary/GetAudioAssetLibraryFolderListApi.h"
 #include "AudioLibrary/GetAudioFileDetailApi.h"
 #include "AudioLibrary/GetAudioCommentApi.h"
 #include "Widgets/Layout/SScrollBox.h"
 #include "ProjectContent/MediaPlayer/SVideoPlayerWidget.h"
-#include "Sound/SoundWave.h"
 #include "EditorFramework/AssetImportData.h"
 
 #define LOCTEXT_NAMESPACE "SAudioAssetsWidget"
@@ -1083,7 +1082,14 @@ TSharedRef<SWidget> SAudioAssetsWidget::GenerateDetailsWidget(const FAudioFileDa
                                                     SNew(SButton)
                                                     .Cursor(EMouseCursor::Hand)
                                                     .ButtonStyle(&ImportButtonStyle) 
-                                                    .OnClicked(this, &SAudioAssetsWidget::OnImportAudioFileButtonClicked)
+                                                    .ToolTipText(LOCTEXT("ImportTooltip", "Import into the project, downloading the file first if needed"))
+                                                    .OnClicked_Lambda([this, AudioFileData]()-> FReply
+                                                    {
+                                                        SelectedAudioFileInfo.FileName = AudioFileData.FileName;
+                                                        SelectedAudioFileInfo.FileUrl = AudioFileData.RelativePath;
+                                                        SelectedAudioFileInfo.FileMd5 = AudioFileData.FileMd5;
+                                                        return OnImportAudioFileButtonClicked();
+                                                    })
                                                     .ContentPadding(0) 
                                                     [
                                                         SNew(SBox)
@@ -1183,67 +1189,24 @@ FReply SAudioAssetsWidget::OnImportAudioFileButtonClicked()
 
 void SAudioAssetsWidget::ImportAudioFile(const FString& FilePath)
 {
-    static TSharedPtr<SWindow> ExistingNotificationWindow;
     static TSharedPtr<SWindow> ExistingNotificationWindow2;
     
-    // Check if the file is still being downloaded 检查文件是否仍在下载中
+    // A file that is still downloading is imported once its download completed 仍在下载的文件在下载完成后导入
     if (AssetDownloadWidget.IsValid() && AssetDownloadWidget->IsFileDownloading(FilePath))
     {
-        if (ExistingNotificationWindow.IsValid() && FSlateApplication::Get().FindWidgetWindow(ExistingNotificationWindow.ToSharedRef()))
-        {
-            ExistingNotificationWindow->BringToFront();
-            return;
-        }
-
-        // An error message is displayed indicating that the file is still being downloaded 显示错误消息，提示文件仍在下载中
-        ExistingNotificationWindow = SNew(SWindow)
-            .Title(LOCTEXT("TipTitle", "Notification"))
-            .ClientSize(FVector2D(200, 100))
-            .FocusWhenFirstShown(true)
-            .SupportsMaximize(false)
-            .SupportsMinimize(false)
-            .IsTopmostWindow(false)
-            .Content()
-            [
-                SNew(SVerticalBox)
-                + SVerticalBox::Slot()
-                .AutoHeight()
-                .Padding(10)
-                .HAlign(HAlign_Center)
-                [
-                    SNew(STextBlock)
-                    .Text(LOCTEXT("ResourceDownloading", "Resource is downloading!"))
-                    .Justification(ETextJustify::Center)
-                ]
-                + SVerticalBox::Slot()
-                .AutoHeight()
-                .Padding(10, 20, 10, 10)
-                .HAlign(HAlign_Center)
-                [
-                    SNew(SButton)
-                    .Text(LOCTEXT("Confirm", "OK"))
-                    .OnClicked_Lambda([]() -> FReply {
-                        if (ExistingNotificationWindow.IsValid())
-                        {
-                            FSlateApplication::Get().RequestDestroyWindow(ExistingNotificationWindow.ToSharedRef());
-                            ExistingNotificationWindow.Reset();
-                        }
-                        return FReply::Handled();
-                    })
-                ]
-            ];
-
-        ExistingNotificationWindow->SetOnWindowClosed(FOnWindowClosed::CreateLambda([this](const TSharedRef<SWindow>&)
-        {
-              ExistingNotificationWindow.Reset(); // Reset pointer after window destruction 窗口销毁后重置指针
-        }));
-        
-        FSlateApplication::Get().AddWindow(ExistingNotificationWindow.ToSharedRef());
+        FAssetImportPipeline::Get().ImportWhenDownloaded(FPaths::GetCleanFilename(FilePath), EAssetImportKind::Audio);
         return;
     }
     
     if (!FPaths::FileExists(FilePath))
     {
+        // A file that was never downloaded is downloaded first and imported afterwards 未下载的文件先下载再导入
+        if (!SelectedAudioFileInfo.FileUrl.IsEmpty() && SelectedAudioFileInfo.FileName == FPaths::GetCleanFilename(FilePath))
+        {
+            FAssetImportPipeline::Get().DownloadAndImport(SelectedAudioFileInfo.FileName, SelectedAudioFileInfo.FileUrl, SelectedAudioFileInfo.FileMd5, EAssetImportKind::Audio);
+            return;
+        }
+
         if (ExistingNotificationWindow2.IsValid() && FSlateApplication::Get().FindWidgetWindow(ExistingNotificationWindow2.ToSharedRef()))
         {
             ExistingNotificationWindow2->BringToFront();
@@ -1298,143 +1261,8 @@ void SAudioAssetsWidget::ImportAudioFile(const FString& FilePath)
         
         return;
     }
-    
-    FString FileExtension = FPaths::GetExtension(FilePath).ToLower();
-    
-    if (FileExtension == TEXT("wav") || FileExtension == TEXT("aiff") || FileExtension == TEXT("flac") || FileExtension == TEXT("ogg"))
-    {
-        ImportSupportedAudioFormats(FilePath, FileExtension);
-    }
-    else
-    {
-        FString TargetFileName = FPaths::GetBaseFilename(FilePath).Replace(TEXT(" "), TEXT("_")).Replace(TEXT("."), TEXT("_"));
-        FString SavePath = TEXT("/Game/RSpaceImportedAssets/Audios/") + TargetFileName;
-        
-        if (FPackageName::DoesPackageExist(SavePath))
-        {
-            UE_LOG(LogTemp, Warning, TEXT("Asset already exists at: %s"), *SavePath);
-            return;
-        }
-
-        UPackage* Package = CreatePackage(*SavePath);
-        if (!Package)
-        {
-            UE_LOG(LogTemp, Error, TEXT("Failed to create package for: %s"), *SavePath);
-            return;
-        }
-
-        UFileMediaSource* FileMediaSource = NewObject<UFileMediaSource>(Package, UFileMediaSource::StaticClass(), FName(*TargetFileName), RF_Public | RF_Standalone);
-        if (!FileMediaSource)
-        {
-            UE_LOG(LogTemp, Error, TEXT("Failed to create UFileMediaSource object for: %s"), *FilePath);
-            return;
-        }
-
-        FileMediaSource->SetFilePath(FilePath);
-        FileMediaSource->MarkPackageDirty();
-
-        // Register assets to the asset registry 注册资产到资产注册表
-        FAssetRegistryModule::AssetCreated(FileMediaSource);
-
-        UE_LOG(LogTemp, Log, TEXT("Successfully registered media source: %s"), *SavePath);
-        
-        FString PackageFilePath = FPackageName::LongPackageNameToFilename(SavePath, FPackageName::GetAssetPackageExtension());
-        if (UPackage::SavePackage(Package, FileMediaSource, RF_Public | RF_Standalone, *PackageFilePath, GError, nullptr, true, true, SAVE_None))
-        {
-            UE_LOG(LogTemp, Log, TEXT("Successfully imported audio file as media source: %s"), *SavePath);
-        }
-        else
-        {
-            UE_LOG(LogTemp, Error, TEXT("Failed to save package for: %s"), *SavePath);
-        }
-    }
-}
-
-void SAudioAssetsWidget::ImportSupportedAudioFormats(const FString& FilePath, const FString& FileExtension)
-{
-    //  Define the save path and handle Spaces and dots in file names 定义保存路径并处理文件名中的空格和点
-    FString TargetFileName = FPaths::GetBaseFilename(FilePath).Replace(TEXT(" "), TEXT("_")).Replace(TEXT("."), TEXT("_"));
-    FString SavePath = TEXT("/Game/RSpaceImportedAssets/Audios/") + TargetFileName;
-    
-    if (FPackageName::DoesPackageExist(SavePath))
-    {
-        UE_LOG(LogTemp, Warning, TEXT("Asset already exists at: %s"), *SavePath);
-        return;
-    }
-
-    // Read audio file data 读取音频文件数据
-    TArray<uint8> AudioData;
-    if (!FFileHelper::LoadFileToArray(AudioData, *FilePath))
-    {
-        UE_LOG(LogTemp, Error, TEXT("Failed to load audio file: %s"), *FilePath);
-        return;
-    }
-
-    // Using FWaveModInfo to parse WAV files, you can continue to extend the parsing logic for other formats 使用 FWaveModInfo 解析 WAV 文件，针对其他格式可以继续扩展解析逻辑
-    FWaveModInfo WaveInfo;
-    if (!WaveInfo.ReadWaveInfo(AudioData.GetData(), AudioData.Num()))
-    {
-        UE_LOG(LogTemp, Error, TEXT("Failed to parse audio file: %s"), *FilePath);
-        return;
-    }
-
-    // Create an audio asset package 创建音频资产包
-    FString PackageName = FPackageName::ObjectPathToPackageName(SavePath);
-    UPackage* Package = CreatePackage(*PackageName);
-    if (!Package)
-    {
-        UE_LOG(LogTemp, Error, TEXT("Failed to create package: %s"), *SavePath);
-        return;
-    }
 
-    // Create a USoundWave object 创建 USoundWave 对象
-    USoundWave* SoundWave = NewObject<USoundWave>(Package, *TargetFileName, RF_Public | RF_Standalone);
-    if (!SoundWave)
-    {
-        UE_LOG(LogTemp, Error, TEXT("Failed to create USoundWave asset."));
-        return;
-    }
-
-    // Fill in audio data and properties 填充音频数据和属性
-    const int32 BitsPerSample = *WaveInfo.pBitsPerSample;
-    const int32 Channels = *WaveInfo.pChannels;
-    const int32 SampleRate = *WaveInfo.pSamplesPerSec;
-    const int32 DataSize = WaveInfo.SampleDataSize;
-
-    if (BitsPerSample / 8 == 0 || Channels == 0 || SampleRate == 0 || DataSize == 0)
-    {
-        UE_LOG(LogTemp, Error, TEXT("Invalid audio file data."));
-        return;
-    }
-
-    const int32 SizeOfSample = BitsPerSample / 8;
-    const int32 TotalSamples = DataSize / SizeOfSample;
-    const int32 Frames = TotalSamples / Channels;
-
-    SoundWave->Duration = static_cast<float>(Frames) / SampleRate;
-    SoundWave->NumChannels = Channels;
-    SoundWave->SetSampleRate(SampleRate);
-    SoundWave->SoundGroup = ESoundGroup::SOUNDGROUP_Default;
-    SoundWave->DecompressionType = DTYPE_Setup;
-    SoundWave->RawPCMDataSize = DataSize;
-    SoundWave->RawPCMData = static_cast<uint8*>(FMemory::Malloc(DataSize));
-    FMemory::Memcpy(SoundWave->RawPCMData, WaveInfo.SampleDataStart, DataSize);
-
-    // Mark the object as modified 标记对象已修改
-    SoundWave->MarkPackageDirty();
-
-    // Register assets to the asset registry 注册资产到资产注册表
-    FAssetRegistryModule::AssetCreated(SoundWave);
-
-    // Save asset package 保存资产包
-    if (!UPackage::SavePackage(Package, SoundWave, EObjectFlags::RF_Public | RF_Standalone, *FPackageName::LongPackageNameToFilename(PackageName, FPackageName::GetAssetPackageExtension())))
-    {
-        UE_LOG(LogTemp, Error, TEXT("Failed to save package: %s"), *SavePath);
-    }
-    else
-    {
-        UE_LOG(LogTemp, Log, TEXT("Successfully imported audio file: %s"), *FilePath);
-    }
+    FAssetImportPipeline::Get().ImportFile(FilePath, EAssetImportKind::Audio);
 }
 
 void SAudioAssetsWidget::ImportWithFileMediaSource(const FString& FilePath)
@@ -14,7 +14,7 @@ void SImageDisplayWindow::Construct(const FArguments& InArgs)
 {
     ImagePath = InArgs._ImagePath;
     CurrentZoom = 1.0f;
-    LoadedTexture = nullptr;
+    LoadedTexture.Reset();
     CurrentOffset = FVector2D::ZeroVector;
     bIsDragging = false;
 
@@ -63,23 +63,16 @@ void SImageDisplayWindow::LoadImage(const FString& ProjectImageUrl)
         return;
     }
 
-    FImageLoader::LoadImageFromUrl(ProjectImageUrl, FOnProjectImageReady::CreateLambda([this, ProjectImageUrl](const TArray<uint8>& ImageData)
+    FImageLoader::LoadTextureFromUrl(ProjectImageUrl, FIntPoint::ZeroValue, FOnImageTextureReady::CreateLambda([this](UTexture2D* Texture)
     {
-        if (ImageData.Num() > 0)
+        // The texture belongs to the image cache, the window keeps it alive while it shows it 纹理归图像缓存所有，窗口显示期间保持引用
+        LoadedTexture.Reset(Texture);
+        if (LoadedTexture && ImageBox.IsValid())
         {
-            LoadedTexture = FImageLoader::CreateTextureFromBytes(ImageData);
-            if (LoadedTexture && ImageBox.IsValid())
-            {
-                UpdateImageDisplay();
-            }
-            else
-            {
-                ShowErrorMessage(LOCTEXT("LoadFailed", "Load Failed"));
-            }
+            UpdateImageDisplay();
         }
         else
         {
-            // ShowErrorMessage(FString::Printf(TEXT("Failed to download image from URL: %s"), *ProjectImageUrl));
             ShowErrorMessage(LOCTEXT("LoadFailed", "Load Failed"));
         }
     }));
@@ -109,7 +102,7 @@ void SImageDisplayWindow::UpdateImageDisplay()
     }
 
     FVector2D ImageSize(LoadedTexture->GetSizeX(), LoadedTexture->GetSizeY());
-    ImageBrush = MakeShareable(new FSlateImageBrush(LoadedTexture, ImageSize)); 
+    ImageBrush = MakeShareable(new FSlateImageBrush(LoadedTexture.Get(), ImageSize)); 
     
     if (ImageBox.IsValid() && ImageBrush.IsValid())
     {
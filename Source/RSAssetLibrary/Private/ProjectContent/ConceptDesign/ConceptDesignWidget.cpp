@@ -2,19 +2,16 @@
 
 
 #include "ProjectContent/ConceptDesign/ConceptDesignWidget.h"
+#include "ProjectContent/AssetImport/FAssetImportPipeline.h"
 #include "RSAssetLibraryStyle.h"
 #include "ConceptDesignLibrary/GetConceptDesignLibraryFolderDetailApi.h"
 #include "ConceptDesignLibrary/GetConceptDesignPictureCommentApi.h"
 #include "ConceptDesignLibrary/GetConceptDesignPictureDetailApi.h"
-#include "Misc/FileHelper.h"
 #include "ProjectContent/Imageload/FImageLoader.h"
 #include "Widgets/Layout/SScrollBox.h"
 #include "ProjectContent/ConceptDesign/ConceptDesignDisplay.h"
-#include "IImageWrapperModule.h"
-#include "IImageWrapper.h"
 #include "ConceptDesignLibrary/GetConceptDesignLibMenuData.h"
 #include "ProjectContent/MediaPlayer/SVideoPlayerWidget.h"
-#include "UObject/SavePackage.h"
 #include "Widgets/Layout/SScaleBox.h"
 
 #define LOCTEXT_NAMESPACE "SConceptDesignWidget"
@@ -52,6 +49,8 @@ void SConceptDesignWidget::Construct(const FArguments& InArgs)
             ]
 	];
     InitializeDetailClickedButtonStyle();
+
+    RegisterActiveTimer(FImageVisibilityTracker::UpdateInterval, FWidgetActiveTimerDelegate::CreateSP(this, &SConceptDesignWidget::UpdateThumbnailVisibility));
 }
 
 void SConceptDesignWidget::UpdateConceptDesignTagPageAssets(const TArray<FFileItemDetails> ConceptItems)
@@ -1059,6 +1058,7 @@ TSharedRef<SWidget> SConceptDesignWidget::GenerateDetailsWidget(const FConceptDe
                              SNew(SButton)
                              .Cursor(EMouseCursor::Hand)
                              .ButtonStyle(&ImportButtonStyle)
+                             .ToolTipText(LOCTEXT("ImportTooltip", "Import into the project, downloading the file first if needed"))
                              .OnClicked_Lambda([this, ConceptDesignFileItem]()-> FReply
                             {
                                SelectedConceptFileInfo.FileName = ConceptDesignFileItem.Name;
@@ -1152,24 +1152,9 @@ void SConceptDesignWidget::OnDownloadCompleted(const FString& AssetFileName)
 
 void SConceptDesignWidget::ClearConceptContent()
 {
-    if (LoadedTextures.Num() > 0)
-    {
-        for (UTexture2D* Texture : LoadedTextures)
-        {
-            if (Texture)
-            {
-                Texture->ReleaseResource();
-                Texture->RemoveFromRoot();
-                Texture->MarkAsGarbage();
-            }
-        }
-        LoadedTextures.Empty();
-        
-    }
-    else
-    {
-        // UE_LOG(LogTemp, Warning, TEXT("No loaded textures to clear."));
-    }
+    // Only the grid lets go here; FImageCache keeps the concept images for the next visit of the folder 这里只释放网格的引用；概念图仍保留在 FImageCache 中，供再次打开文件夹时使用
+    LoadedTextures.Empty();
+    ThumbnailVisibility.Reset();
     
     if (ConceptDesignAssetsContainer.IsValid())
     {
@@ -1181,6 +1166,15 @@ void SConceptDesignWidget::ClearConceptContent()
     }
 }
 
+EActiveTimerReturnType SConceptDesignWidget::UpdateThumbnailVisibility(double InCurrentTime, float InDeltaTime)
+{
+    if (ConceptDesignAssetsContainer.IsValid())
+    {
+        ThumbnailVisibility.Update(GetPaintSpaceGeometry(), ConceptDesignAssetsContainer.ToSharedRef());
+    }
+    return EActiveTimerReturnType::Continue;
+}
+
 
 TSharedRef<SWidget> SConceptDesignWidget::ConstructImageItem(const FString& ProjectImageUrl)
 {
@@ -1205,53 +1199,34 @@ TSharedRef<SWidget> SConceptDesignWidget::ConstructImageItem(const FString& Proj
     if (!ProjectImageUrl.IsEmpty())
     {
         // Asynchronously loading picture 异步加载图片
-        FImageLoader::LoadImageFromUrl(ProjectImageUrl, FOnProjectImageReady::CreateLambda([this, ImageBox](const TArray<uint8>& ImageData)
+        const FImageRequestHandle ThumbnailRequest = FImageLoader::LoadTextureFromUrl(ProjectImageUrl, FImageLoader::GetThumbnailSize(), FOnImageTextureReady::CreateLambda([this, ImageBox](UTexture2D* LoadedTexture)
         {
-            if (ImageData.Num() > 0)
+            if (LoadedTexture && ImageBox.IsValid())
             {
-                UTexture2D* LoadedTexture = FImageLoader::CreateTextureFromBytes(ImageData);
-                if (LoadedTexture && ImageBox.IsValid())
-                {
-                    const float TextureWidth = LoadedTexture->GetSizeX();
-                    const float TextureHeight = LoadedTexture->GetSizeY();
-                    const float AspectRatio = TextureWidth / TextureHeight;
-                    
-                    ImageBox->SetWidthOverride(150.f);
-                    ImageBox->SetHeightOverride(150.f / AspectRatio);
-                    
-                    ImageBox->SetContent(
-                        SNew(SBorder)
-                        .BorderBackgroundColor(FLinearColor(0, 0, 0, 1.0f)) 
+                const float TextureWidth = LoadedTexture->GetSizeX();
+                const float TextureHeight = LoadedTexture->GetSizeY();
+                const float AspectRatio = TextureWidth / TextureHeight;
+                
+                ImageBox->SetWidthOverride(150.f);
+                ImageBox->SetHeightOverride(150.f / AspectRatio);
+                
+                ImageBox->SetContent(
+                    SNew(SBorder)
+                    .BorderBackgroundColor(FLinearColor(0, 0, 0, 1.0f)) 
+                    [
+                        SNew(SScaleBox)
+                        .Stretch(EStretch::ScaleToFit) 
+                        .StretchDirection(EStretchDirection::Both)
                         [
-                            SNew(SScaleBox)
-                            .Stretch(EStretch::ScaleToFit) 
-                            .StretchDirection(EStretchDirection::Both)
-                            [
-                                SNew(SImage)
-                                .Image(new FSlateImageBrush(LoadedTexture, FVector2D(TextureWidth, TextureHeight)))
-                            ]
+                            SNew(SImage)
+                            .Image(new FSlateImageBrush(LoadedTexture, FVector2D(TextureWidth, TextureHeight)))
                         ]
-                    );
+                    ]
+                );
 
-                    // Set up lifecycle management for textures to avoid garbage collection issues 设置纹理的生命周期管理，以避免垃圾回收问题
-                    LoadedTextures.Add(LoadedTexture);
-                    LoadedTexture->AddToRoot(); 
-                }
-                else
-                {
-                    ImageBox->SetContent(
-                        SNew(SBorder)
-                        .BorderBackgroundColor(FLinearColor(1.0f, 0.0f, 0.0f, 1.0f))
-                        [
-                            SNew(SBox).HAlign(HAlign_Center).VAlign(VAlign_Center)
-                            [
-                                SNew(STextBlock)
-                                .Text(LOCTEXT("LoadFailed", "Load Failed"))
-                                .Justification(ETextJustify::Center)
-                            ]
-                        ]
-                    );
-                }
+                // Held until ClearConceptContent, the texture itself belongs to FImageCache 引用保持到 ClearConceptContent，纹理本身归 FImageCache 所有
+                LoadedTextures.Add(TStrongObjectPtr<UTexture2D>(LoadedTexture));
+                ThumbnailVisibility.OnThumbnailShown(ImageBox.ToSharedRef());
             }
             else
             {
@@ -1269,6 +1244,7 @@ TSharedRef<SWidget> SConceptDesignWidget::ConstructImageItem(const FString& Proj
                 );
             }
         }));
+        ThumbnailVisibility.Track(ImageBox.ToSharedRef(), ThumbnailRequest);
     }
     else
     {
@@ -1315,67 +1291,24 @@ FReply SConceptDesignWidget::OnImportConceptFileButtonClicked(const FSelectedCon
 
 void SConceptDesignWidget::ImportConceptFile(const FString& FilePath)
 {
-    static TSharedPtr<SWindow> ExistingNotificationWindow;
     static TSharedPtr<SWindow> ExistingNotificationWindow2;
     
-    // Check if the file is still being downloaded 检查文件是否仍在下载中
+    // A file that is still downloading is imported once its download completed 仍在下载的文件在下载完成后导入
     if (AssetDownloadWidget.IsValid() && AssetDownloadWidget->IsFileDownloading(FilePath))
     {
-        if (ExistingNotificationWindow.IsValid() && FSlateApplication::Get().FindWidgetWindow(ExistingNotificationWindow.ToSharedRef()))
-        {
-            ExistingNotificationWindow->BringToFront();
-            return;
-        }
-
-        // An error message is displayed indicating that the file is still being downloaded 显示错误消息，提示文件仍在下载中
-        ExistingNotificationWindow = SNew(SWindow)
-            .Title(LOCTEXT("TipTitle", "Notification"))
-            .ClientSize(FVector2D(200, 100))
-            .FocusWhenFirstShown(true)
-            .SupportsMaximize(false)
-            .SupportsMinimize(false)
-            .IsTopmostWindow(false)
-            .Content()
-            [
-                SNew(SVerticalBox)
-                + SVerticalBox::Slot()
-                .AutoHeight()
-                .Padding(10)
-                .HAlign(HAlign_Center)
-                [
-                    SNew(STextBlock)
-                    .Text(LOCTEXT("ResourceDownloading", "Resource is downloading！"))
-                    .Justification(ETextJustify::Center)
-                ]
-                + SVerticalBox::Slot()
-                .AutoHeight()
-                .Padding(10, 20, 10, 10)
-                .HAlign(HAlign_Center)
-                [
-                    SNew(SButton)
-                    .Text(LOCTEXT("Confirm", "OK"))
-                    .OnClicked_Lambda([]() -> FReply {
-                        if (ExistingNotificationWindow.IsValid())
-                        {
-                            FSlateApplication::Get().RequestDestroyWindow(ExistingNotificationWindow.ToSharedRef());
-                            ExistingNotificationWindow.Reset();
-                        }
-                        return FReply::Handled();
-                    })
-                ]
-            ];
-
-        ExistingNotificationWindow->SetOnWindowClosed(FOnWindowClosed::CreateLambda([this](const TSharedRef<SWindow>&)
-        {
-              ExistingNotificationWindow.Reset();
-        }));
-        
-        FSlateApplication::Get().AddWindow(ExistingNotificationWindow.ToSharedRef());
+        FAssetImportPipeline::Get().ImportWhenDownloaded(FPaths::GetCleanFilename(FilePath), EAssetImportKind::Concept);
         return;
     }
     
     if (!FPaths::FileExists(FilePath))
     {
+        // A file that was never downloaded is downloaded first and imported afterwards 未下载的文件先下载再导入
+        if (!SelectedConceptFileInfo.FileUrl.IsEmpty() && SelectedConceptFileInfo.FileName == FPaths::GetCleanFilename(FilePath))
+        {
+            FAssetImportPipeline::Get().DownloadAndImport(SelectedConceptFileInfo.FileName, SelectedConceptFileInfo.FileUrl, SelectedConceptFileInfo.FileMd5, EAssetImportKind::Concept);
+            return;
+        }
+
         // UE_LOG(LogTemp, Error, TEXT("Concept file does not exist at: %s"), *FilePath);
 
         // If the window already exists and is valid, put it first 如果窗口已存在且有效，将其置于最前
@@ -1433,109 +1366,7 @@ void SConceptDesignWidget::ImportConceptFile(const FString& FilePath)
         return;
     }
 
-    // Handle file names by replacing "." with "_", but keeping the extension 处理文件名，将 "." 替换为 "_"，但保留扩展名
-    FString NewFileName = FPaths::GetBaseFilename(FilePath).Replace(TEXT("."), TEXT("_"));
-    FString PackageName = TEXT("/Game/RSpaceImportedAssets/Images/") + NewFileName;
-
-    // Check whether assets with the same name already exist 检查是否已经存在同名资产
-    if (FPackageName::DoesPackageExist(PackageName))
-    {
-        UE_LOG(LogTemp, Log, TEXT("Texture already exists, skipping import: %s"), *PackageName);
-        return;
-    }
-
-    // Load files into memory 加载文件到内存
-    TArray<uint8> FileData;
-    if (!FFileHelper::LoadFileToArray(FileData, *FilePath))
-    {
-        UE_LOG(LogTemp, Error, TEXT("Failed to load file: %s"), *FilePath);
-        return;
-    }
-
-    // Detection image format 检测图像格式
-    IImageWrapperModule& ImageWrapperModule = FModuleManager::LoadModuleChecked<IImageWrapperModule>(TEXT("ImageWrapper"));
-    EImageFormat ImageFormat = ImageWrapperModule.DetectImageFormat(FileData.GetData(), FileData.Num());
-    if (ImageFormat == EImageFormat::Invalid)
-    {
-        UE_LOG(LogTemp, Error, TEXT("Unrecognized image format: %s"), *FilePath);
-        return;
-    }
-
-    // Create an image wrapper 创建图像包装
-    TSharedPtr<IImageWrapper> ImageWrapper = ImageWrapperModule.CreateImageWrapper(ImageFormat);
-    if (!ImageWrapper.IsValid() || !ImageWrapper->SetCompressed(FileData.GetData(), FileData.Num()))
-    {
-        UE_LOG(LogTemp, Error, TEXT("Failed to create image wrapper: %s"), *FilePath);
-        return;
-    }
-
-    // Unzip image data 解压图像数据
-    TArray<uint8> UncompressedRGBA;
-    if (!ImageWrapper->GetRaw(ERGBFormat::BGRA, 8, UncompressedRGBA))
-    {
-        UE_LOG(LogTemp, Error, TEXT("Failed to decompress image data: %s"), *FilePath);
-        return;
-    }
-
-    // Create package 创建包
-    UPackage* Package = CreatePackage(*PackageName);
-    if (!Package)
-    {
-        UE_LOG(LogTemp, Error, TEXT("Failed to create package: %s"), *PackageName);
-        return;
-    }
-
-    // Create a UTexture2D object 创建 UTexture2D 对象
-    UTexture2D* LoadedTexture = NewObject<UTexture2D>(Package, FName(*NewFileName), RF_Public | RF_Standalone);
-    if (!LoadedTexture)
-    {
-        UE_LOG(LogTemp, Error, TEXT("Failed to create texture object: %s"), *NewFileName);
-        return;
-    }
-
-    // Initialize the texture platform data 初始化纹理平台数据
-    FTexturePlatformData* PlatformData = new FTexturePlatformData();
-    PlatformData->SizeX = ImageWrapper->GetWidth();
-    PlatformData->SizeY = ImageWrapper->GetHeight();
-    PlatformData->PixelFormat = PF_B8G8R8A8;
-
-    // Create MipMap data 创建 MipMap 数据
-    FTexture2DMipMap* Mip = new FTexture2DMipMap();
-    PlatformData->Mips.Add(Mip);
-    Mip->SizeX = ImageWrapper->GetWidth();
-    Mip->SizeY = ImageWrapper->GetHeight();
-    Mip->BulkData.Lock(LOCK_READ_WRITE);
-    void* TextureData = Mip->BulkData.Realloc(UncompressedRGBA.Num());
-    FMemory::Memcpy(TextureData, UncompressedRGBA.GetData(), UncompressedRGBA.Num());
-    Mip->BulkData.Unlock();
-
-    // Set up PlatformData 设置 PlatformData
-    LoadedTexture->SetPlatformData(PlatformData);
-
-    // Set texture properties 设置纹理属性
-    LoadedTexture->SRGB = true;
-    LoadedTexture->CompressionSettings = TC_Default;
-    LoadedTexture->MipGenSettings = TMGS_FromTextureGroup;
-    LoadedTexture->UpdateResource();
-
-    // Mark the package as dirty 标记包为脏
-    Package->MarkPackageDirty();
-
-    // Save the package to disk 保存包到磁盘
-    FString PackageFilePath = FPackageName::LongPackageNameToFilename(PackageName, FPackageName::GetAssetPackageExtension());
-    FSavePackageArgs SaveArgs;
-    SaveArgs.TopLevelFlags = EObjectFlags::RF_Public | RF_Standalone;
-    SaveArgs.Error = GError;
-    SaveArgs.SaveFlags = SAVE_NoError;
-
-    if (UPackage::SavePackage(Package, nullptr, *PackageFilePath, SaveArgs))
-    {
-        UE_LOG(LogTemp, Log, TEXT("Successfully saved texture to package: %s"), *PackageFilePath);
-    }
-    else
-    {
-        UE_LOG(LogTemp, Error, TEXT("Failed to save package: %s"), *PackageFilePath);
-    }
+    FAssetImportPipeline::Get().ImportFile(FilePath, EAssetImportKind::Concept);
 }
 
 
@@ -0,0 +1,514 @@
+﻿// Copyright (c) 2024 Hunan MangoXR Tech Co., Ltd. All Rights Reserved.
+
+#include "ProjectContent/Imageload/FImageCache.h"
+#include "Async/Async.h"
+#include "Downloader/AssetCacheLock.h"
+#include "Downloader/AssetContentStore.h"
+#include "Engine/Texture2D.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Json.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/SecureHash.h"
+
+static TAutoConsoleVariable<int32> CVarThumbnailMemoryCacheMB(
+    TEXT("RSAsset.ThumbnailMemoryCacheMB"),
+    256,
+    TEXT("Megabytes of decoded preview textures kept in memory. The least recently used ones are released first."));
+
+static TAutoConsoleVariable<int32> CVarThumbnailDiskCacheMB(
+    TEXT("RSAsset.ThumbnailDiskCacheMB"),
+    1024,
+    TEXT("Megabytes of downloaded preview images kept on disk. The least recently used ones are deleted first."));
+
+static TAutoConsoleVariable<float> CVarThumbnailCacheMaxAgeHours(
+    TEXT("RSAsset.ThumbnailCacheMaxAgeHours"),
+    24.0f,
+    TEXT("Hours a preview image on disk is used without asking the server. Older images are revalidated with their ETag or Last-Modified."));
+
+double FImageCacheStats::GetHitRate() const
+{
+    const int64 NumHits = MemoryHits + DiskHits + Revalidations + Coalesced;
+    const int64 NumLookups = NumHits + Misses;
+    return NumLookups > 0 ? (double)NumHits / NumLookups : 0.0;
+}
+
+FImageCache& FImageCache::Get()
+{
+    static FImageCache Instance;
+    return Instance;
+}
+
+FImageCache::FImageCache()
+{
+    const FString SharedCacheRoot = FAssetContentStore::GetSharedCacheRoot();
+    const FString CacheRoot = !SharedCacheRoot.IsEmpty() ? SharedCacheRoot : FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("RspaceAssetsLibrary"));
+
+    CacheDirectory = FPaths::Combine(CacheRoot, TEXT("Thumbnails"));
+    IndexPath = FPaths::Combine(CacheDirectory, TEXT("Index.json"));
+    LoadIndex();
+}
+
+UTexture2D* FImageCache::FindTexture(const FString& Key)
+{
+    FMemoryEntry* Entry = MemoryEntries.Find(Key);
+    if (!Entry || !Entry->Texture.IsValid())
+    {
+        return nullptr;
+    }
+
+    Entry->LastUse = ++UseCounter;
+    return Entry->Texture.Get();
+}
+
+void FImageCache::AddTexture(const FString& Key, UTexture2D* Texture)
+{
+    if (!Texture)
+    {
+        return;
+    }
+
+    if (FMemoryEntry* OldEntry = MemoryEntries.Find(Key))
+    {
+        MemoryBytes -= OldEntry->Size;
+    }
+
+    // Preview textures are uncompressed BGRA8 预览纹理为未压缩的 BGRA8
+    FMemoryEntry& Entry = MemoryEntries.Add(Key);
+    Entry.Texture.Reset(Texture);
+    Entry.Size = (int64)Texture->GetSizeX() * Texture->GetSizeY() * 4;
+    Entry.LastUse = ++UseCounter;
+    MemoryBytes += Entry.Size;
+
+    TrimMemory();
+}
+
+void FImageCache::TrimMemory()
+{
+    const int64 MaxBytes = (int64)FMath::Max(0, CVarThumbnailMemoryCacheMB.GetValueOnGameThread()) * 1024 * 1024;
+
+    // The newest texture stays even when it alone is over the budget 最新的纹理即使单独超出预算也会保留
+    while (MemoryBytes > MaxBytes && MemoryEntries.Num() > 1)
+    {
+        const FString* OldestKey = nullptr;
+        uint64 OldestUse = MAX_uint64;
+        for (const TPair<FString, FMemoryEntry>& Pair : MemoryEntries)
+        {
+            if (Pair.Value.LastUse < OldestUse)
+            {
+                OldestUse = Pair.Value.LastUse;
+                OldestKey = &Pair.Key;
+            }
+        }
+
+        // Widgets still showing the texture keep it alive with their own reference 仍在显示该纹理的控件持有自己的引用，纹理不会被回收
+        const FString Key = *OldestKey;
+        MemoryBytes -= MemoryEntries[Key].Size;
+        MemoryEntries.Remove(Key);
+    }
+}
+
+bool FImageCache::FindDiskEntry(const FString& Url, FImageDiskEntry& OutEntry)
+{
+    FImageDiskEntry* Entry = DiskEntries.Find(Url);
+    if (!Entry)
+    {
+        return false;
+    }
+
+    Entry->LastAccess = FDateTime::UtcNow();
+    ScheduleIndexSave();
+    OutEntry = *Entry;
+    return true;
+}
+
+bool FImageCache::IsFresh(const FImageDiskEntry& Entry)
+{
+    const double MaxAgeHours = CVarThumbnailCacheMaxAgeHours.GetValueOnGameThread();
+    return (FDateTime::UtcNow() - Entry.StoredAt).GetTotalHours() < MaxAgeHours;
+}
+
+void FImageCache::LoadBytes(const FString& Url, TFunction<void(const TArray<uint8>&)> OnLoaded)
+{
+    const FImageDiskEntry* Entry = DiskEntries.Find(Url);
+    const FString Path = Entry ? Entry->Path : FString();
+
+    Async(EAsyncExecution::ThreadPool, [Path, OnLoaded = MoveTemp(OnLoaded)]() mutable
+    {
+        TArray<uint8> Bytes;
+        if (!Path.IsEmpty() && !FFileHelper::LoadFileToArray(Bytes, *Path, FILEREAD_Silent))
+        {
+            Bytes.Reset();
+        }
+
+        Async(EAsyncExecution::TaskGraphMainThread, [Bytes = MoveTemp(Bytes), OnLoaded = MoveTemp(OnLoaded)]()
+        {
+            OnLoaded(Bytes);
+        });
+    });
+}
+
+void FImageCache::StoreBytes(const FString& Url, const TArray<uint8>& Bytes, const FString& ETag, const FString& LastModified)
+{
+    if (Bytes.Num() == 0)
+    {
+        return;
+    }
+
+    DroppedEntries.Remove(Url);
+    FImageDiskEntry& Entry = DiskEntries.FindOrAdd(Url);
+    DiskBytes -= Entry.Size;
+    Entry.Url = Url;
+    Entry.Path = GetFilePath(Url);
+    Entry.ETag = ETag;
+    Entry.LastModified = LastModified;
+    Entry.Size = Bytes.Num();
+    Entry.StoredAt = FDateTime::UtcNow();
+    Entry.LastAccess = Entry.StoredAt;
+    DiskBytes += Entry.Size;
+
+    // Written to a temporary file first so a reader never sees half an image 先写入临时文件，读取方不会读到不完整的图像
+    Async(EAsyncExecution::ThreadPool, [Path = Entry.Path, Bytes]()
+    {
+        const FString TempPath = GetTempFilePath(Path);
+        if (FFileHelper::SaveArrayToFile(Bytes, *TempPath))
+        {
+            IFileManager::Get().Move(*Path, *TempPath, true, true);
+        }
+    });
+
+    TrimDisk();
+    ScheduleIndexSave();
+}
+
+void FImageCache::MarkRevalidated(const FString& Url)
+{
+    if (FImageDiskEntry* Entry = DiskEntries.Find(Url))
+    {
+        Entry->StoredAt = FDateTime::UtcNow();
+        ScheduleIndexSave();
+    }
+}
+
+void FImageCache::RemoveDiskEntry(const FString& Url)
+{
+    FImageDiskEntry Entry;
+    if (DiskEntries.RemoveAndCopyValue(Url, Entry))
+    {
+        DiskBytes -= Entry.Size;
+        DroppedEntries.Add(Url);
+        IFileManager::Get().Delete(*Entry.Path, false, true, true);
+        ScheduleIndexSave();
+    }
+}
+
+void FImageCache::TrimDisk()
+{
+    const int64 MaxBytes = (int64)FMath::Max(0, CVarThumbnailDiskCacheMB.GetValueOnGameThread()) * 1024 * 1024;
+    if (DiskBytes <= MaxBytes)
+    {
+        return;
+    }
+
+    TArray<FImageDiskEntry> Entries;
+    DiskEntries.GenerateValueArray(Entries);
+    Entries.Sort([](const FImageDiskEntry& A, const FImageDiskEntry& B)
+    {
+        return A.LastAccess < B.LastAccess;
+    });
+
+    for (const FImageDiskEntry& Entry : Entries)
+    {
+        if (DiskBytes <= MaxBytes)
+        {
+            break;
+        }
+        RemoveDiskEntry(Entry.Url);
+    }
+}
+
+void FImageCache::RecordLookup(EImageCacheResult Result)
+{
+    switch (Result)
+    {
+    case EImageCacheResult::MemoryHit:
+        NumMemoryHits++;
+        break;
+    case EImageCacheResult::DiskHit:
+        NumDiskHits++;
+        break;
+    case EImageCacheResult::Revalidated:
+        NumRevalidations++;
+        break;
+    case EImageCacheResult::Coalesced:
+        NumCoalesced++;
+        break;
+    case EImageCacheResult::Miss:
+        NumMisses++;
+        break;
+    }
+}
+
+void FImageCache::RecordTimeToFirstVisible(double Seconds)
+{
+    TimeToFirstVisible.AddSample(Seconds);
+}
+
+FImageCacheStats FImageCache::GetStats() const
+{
+    FImageCacheStats Stats;
+    Stats.MemoryHits = NumMemoryHits;
+    Stats.DiskHits = NumDiskHits;
+    Stats.Revalidations = NumRevalidations;
+    Stats.Coalesced = NumCoalesced;
+    Stats.Misses = NumMisses;
+    Stats.NumMemoryEntries = MemoryEntries.Num();
+    Stats.MemoryBytes = MemoryBytes;
+    Stats.NumDiskEntries = DiskEntries.Num();
+    Stats.DiskBytes = DiskBytes;
+    Stats.TimeToFirstVisible = TimeToFirstVisible;
+    return Stats;
+}
+
+void FImageCache::LogStats() const
+{
+    const FImageCacheStats Stats = GetStats();
+    UE_LOG(LogTemp, Log, TEXT("Thumbnail cache: hit rate %.1f%% (memory %lld, disk %lld, revalidated %lld, joined %lld, downloaded %lld)"),
+        Stats.GetHitRate() * 100.0, Stats.MemoryHits, Stats.DiskHits, Stats.Revalidations, Stats.Coalesced, Stats.Misses);
+    UE_LOG(LogTemp, Log, TEXT("Thumbnail cache: memory %d textures, %.1f of %d MB; disk %d files, %.1f of %d MB in %s"),
+        Stats.NumMemoryEntries, Stats.MemoryBytes / (1024.0 * 1024.0), CVarThumbnailMemoryCacheMB.GetValueOnGameThread(),
+        Stats.NumDiskEntries, Stats.DiskBytes / (1024.0 * 1024.0), CVarThumbnailDiskCacheMB.GetValueOnGameThread(), *CacheDirectory);
+    UE_LOG(LogTemp, Log, TEXT("Thumbnail cache: first visible thumbnail after %.0f ms p50, %.0f ms p95, %.0f ms max over %d grids"),
+        Stats.TimeToFirstVisible.GetPercentile(0.5) * 1000.0, Stats.TimeToFirstVisible.GetPercentile(0.95) * 1000.0,
+        Stats.TimeToFirstVisible.MaxSeconds * 1000.0, Stats.TimeToFirstVisible.NumSamples);
+}
+
+void FImageCache::Clear()
+{
+    MemoryEntries.Empty();
+    MemoryBytes = 0;
+
+    for (const TPair<FString, FImageDiskEntry>& Pair : DiskEntries)
+    {
+        IFileManager::Get().Delete(*Pair.Value.Path, false, true, true);
+        DroppedEntries.Add(Pair.Key);
+    }
+    DiskEntries.Empty();
+    DiskBytes = 0;
+    SaveIndex();
+}
+
+void FImageCache::Shutdown()
+{
+    if (SaveIndexHandle.IsValid())
+    {
+        FTSTicker::GetCoreTicker().RemoveTicker(SaveIndexHandle);
+        SaveIndexHandle.Reset();
+        SaveIndex();
+
+        // Nothing ticks after shutdown, so a save that met a busy lock is given up 关闭后不再 tick，遇到锁被占用的保存只能放弃
+        if (SaveIndexHandle.IsValid())
+        {
+            FTSTicker::GetCoreTicker().RemoveTicker(SaveIndexHandle);
+            SaveIndexHandle.Reset();
+            UE_LOG(LogTemp, Warning, TEXT("The thumbnail index is locked by another editor, the latest entries are not saved."));
+        }
+    }
+
+    MemoryEntries.Empty();
+    MemoryBytes = 0;
+}
+
+FString FImageCache::GetFilePath(const FString& Url) const
+{
+    return FPaths::Combine(CacheDirectory, FMD5::HashAnsiString(*Url) + TEXT(".img"));
+}
+
+void FImageCache::ScheduleIndexSave()
+{
+    if (SaveIndexHandle.IsValid())
+    {
+        return;
+    }
+
+    SaveIndexHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([this](float DeltaTime)
+    {
+        SaveIndexHandle.Reset();
+        SaveIndex();
+        return false;
+    }), IndexSaveDelay);
+}
+
+void FImageCache::ReadIndex(TMap<FString, FImageDiskEntry>& OutEntries) const
+{
+    FString JsonString;
+    TSharedPtr<FJsonObject> JsonObject;
+    const TArray<TSharedPtr<FJsonValue>>* EntryValues = nullptr;
+    if (!FFileHelper::LoadFileToString(JsonString, *IndexPath)
+        || !FJsonSerializer::Deserialize(TJsonReaderFactory<>::Create(JsonString), JsonObject)
+        || !JsonObject.IsValid()
+        || !JsonObject->TryGetArrayField(TEXT("entries"), EntryValues))
+    {
+        return;
+    }
+
+    for (const TSharedPtr<FJsonValue>& EntryValue : *EntryValues)
+    {
+        const TSharedPtr<FJsonObject>* EntryObject = nullptr;
+        if (!EntryValue.IsValid() || !EntryValue->TryGetObject(EntryObject))
+        {
+            continue;
+        }
+
+        FImageDiskEntry Entry;
+        Entry.Url = (*EntryObject)->GetStringField(TEXT("url"));
+        Entry.ETag = (*EntryObject)->GetStringField(TEXT("etag"));
+        Entry.LastModified = (*EntryObject)->GetStringField(TEXT("lastModified"));
+        LexFromString(Entry.Size, *(*EntryObject)->GetStringField(TEXT("size")));
+        FDateTime::ParseIso8601(*(*EntryObject)->GetStringField(TEXT("storedAt")), Entry.StoredAt);
+        FDateTime::ParseIso8601(*(*EntryObject)->GetStringField(TEXT("lastAccess")), Entry.LastAccess);
+        Entry.Path = GetFilePath(Entry.Url);
+
+        // Entries whose file another editor instance evicted are dropped 另一个编辑器实例已删除文件的条目被丢弃
+        if (!Entry.Url.IsEmpty() && IFileManager::Get().FileExists(*Entry.Path))
+        {
+            OutEntries.Add(Entry.Url, Entry);
+        }
+    }
+}
+
+void FImageCache::AdoptEntries(TMap<FString, FImageDiskEntry>&& Entries)
+{
+    DiskEntries = MoveTemp(Entries);
+    DiskBytes = 0;
+    for (const TPair<FString, FImageDiskEntry>& Pair : DiskEntries)
+    {
+        DiskBytes += Pair.Value.Size;
+    }
+}
+
+void FImageCache::LoadIndex()
+{
+    TMap<FString, FImageDiskEntry> Entries;
+    ReadIndex(Entries);
+    AdoptEntries(MoveTemp(Entries));
+
+    // Under the lock no other instance adds a file to the index meanwhile 持有锁时其他实例不会同时向索引添加文件
+    TUniquePtr<FAssetCacheLock> IndexLock = FAssetCacheLock::TryAcquire(GetIndexLockPath());
+    if (IndexLock.IsValid())
+    {
+        TSet<FString> KnownFiles;
+        for (const TPair<FString, FImageDiskEntry>& Pair : DiskEntries)
+        {
+            KnownFiles.Add(FPaths::GetCleanFilename(Pair.Value.Path));
+        }
+
+        // Another instance may not have indexed its newest files yet, so only old strays are removed 其他实例可能尚未索引最新的文件，只清理较旧的游离文件
+        const FDateTime StrayTime = FDateTime::UtcNow() - FTimespan::FromHours(StrayFileMinAgeHours);
+        for (const TCHAR* Pattern : { TEXT("*.img"), TEXT("*.tmp") })
+        {
+            TArray<FString> Files;
+            IFileManager::Get().FindFiles(Files, *FPaths::Combine(CacheDirectory, Pattern), true, false);
+            for (const FString& File : Files)
+            {
+                const FString FilePath = FPaths::Combine(CacheDirectory, File);
+                if (!KnownFiles.Contains(File) && IFileManager::Get().GetTimeStamp(*FilePath) < StrayTime)
+                {
+                    IFileManager::Get().Delete(*FilePath, false, true, true);
+                }
+            }
+        }
+    }
+
+    TrimDisk();
+}
+
+void FImageCache::SaveIndex()
+{
+    // Instances sharing the cache root write the same index; merge with theirs under the lock 共享缓存目录的实例写入同一个索引，加锁后与其合并
+    TUniquePtr<FAssetCacheLock> IndexLock = FAssetCacheLock::TryAcquire(GetIndexLockPath());
+    if (!IndexLock.IsValid())
+    {
+        // Another instance is saving; the save is retried later instead of waiting on the game thread 其他实例正在保存；稍后重试，不在游戏线程上等待
+        ScheduleIndexSave();
+        return;
+    }
+
+    TMap<FString, FImageDiskEntry> MergedEntries;
+    ReadIndex(MergedEntries);
+    for (const FString& Url : DroppedEntries)
+    {
+        MergedEntries.Remove(Url);
+    }
+    MergedEntries.Append(DiskEntries);
+    DroppedEntries.Empty();
+
+    // Entries of the other instances count against the disk budget here as well 其他实例的条目同样计入本实例的磁盘预算
+    AdoptEntries(MoveTemp(MergedEntries));
+
+    TArray<TSharedPtr<FJsonValue>> EntryValues;
+    for (const TPair<FString, FImageDiskEntry>& Pair : DiskEntries)
+    {
+        TSharedRef<FJsonObject> EntryObject = MakeShared<FJsonObject>();
+        EntryObject->SetStringField(TEXT("url"), Pair.Value.Url);
+        EntryObject->SetStringField(TEXT("etag"), Pair.Value.ETag);
+        EntryObject->SetStringField(TEXT("lastModified"), Pair.Value.LastModified);
+        EntryObject->SetStringField(TEXT("size"), LexToString(Pair.Value.Size));
+        EntryObject->SetStringField(TEXT("storedAt"), Pair.Value.StoredAt.ToIso8601());
+        EntryObject->SetStringField(TEXT("lastAccess"), Pair.Value.LastAccess.ToIso8601());
+        EntryValues.Add(MakeShared<FJsonValueObject>(EntryObject));
+    }
+
+    TSharedRef<FJsonObject> JsonObject = MakeShared<FJsonObject>();
+    JsonObject->SetArrayField(TEXT("entries"), EntryValues);
+
+    FString JsonString;
+    TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&JsonString);
+    if (!FJsonSerializer::Serialize(JsonObject, Writer))
+    {
+        return;
+    }
+
+    const FString TempPath = GetTempFilePath(IndexPath);
+    IFileManager::Get().MakeDirectory(*CacheDirectory, true);
+    if (FFileHelper::SaveStringToFile(JsonString, *TempPath))
+    {
+        IFileManager::Get().Move(*IndexPath, *TempPath, true, true);
+    }
+}
+
+FString FImageCache::GetIndexLockPath() const
+{
+    return FPaths::Combine(CacheDirectory, TEXT("Index.lock"));
+}
+
+FString FImageCache::GetTempFilePath(const FString& Path)
+{
+    // Unique per writer, so two processes never write the same temporary file 每个写入方唯一，两个进程不会写入同一个临时文件
+    return FString::Printf(TEXT("%s.%s.tmp"), *Path, *FGuid::NewGuid().ToString());
+}
+
+namespace ImageCacheCommands
+{
+    static void LogStats()
+    {
+        FImageCache::Get().LogStats();
+    }
+
+    static void Clear()
+    {
+        FImageCache::Get().Clear();
+        UE_LOG(LogTemp, Log, TEXT("Thumbnail cache cleared."));
+    }
+
+    static FAutoConsoleCommand ThumbnailCacheStatsCommand(
+        TEXT("RSAsset.ThumbnailCacheStats"),
+        TEXT("Logs hit rates and sizes of the preview image cache."),
+        FConsoleCommandDelegate::CreateStatic(&LogStats));
+
+    static FAutoConsoleCommand ClearThumbnailCacheCommand(
+        TEXT("RSAsset.ClearThumbnailCache"),
+        TEXT("Drops every cached preview image from memory and disk."),
+        FConsoleCommandDelegate::CreateStatic(&Clear));
+}
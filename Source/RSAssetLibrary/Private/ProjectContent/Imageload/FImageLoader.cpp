@@ -1,6 +1,7 @@
 ﻿// Copyright (c) 2024 Hunan MangoXR Tech Co., Ltd. All Rights Reserved.
 
 #include "ProjectContent/Imageload/FImageLoader.h"
+#include "ProjectContent/Imageload/FImageCache.h"
 #include "IImageWrapperModule.h"
 #include "IImageWrapper.h"
 #include "Engine/Texture2D.h"
@@ -9,129 +10,491 @@
 #include "Interfaces/IHttpResponse.h"
 #include "HttpModule.h"
 #include "Async/Async.h"
+#include "Containers/Ticker.h"
+#include "HAL/IConsoleManager.h"
 
-TMap<FString, FHttpRequestPtr> FImageLoader::ActiveRequests;
+/** One caller waiting for the bytes of an image. */
+struct FImageSubscriber
+{
+    uint64 Id = 0;
+    EImageLoadPriority Priority = EImageLoadPriority::Normal;
+    TFunction<void(const TArray<uint8>&)> OnImageData;
+};
+
+/** One fetch of an image URL, shared by every caller waiting for that URL. */
+struct FImageRequest
+{
+    FString Url;
+
+    TArray<FImageSubscriber> Subscribers;
+
+    // Highest priority of the subscribers 订阅者中的最高优先级
+    EImageLoadPriority Priority = EImageLoadPriority::Normal;
+
+    // Set while the download runs 下载进行中时有效
+    FHttpRequestPtr HttpRequest;
+
+    // Stale disk entry the download revalidates 下载时需重新验证的过期磁盘条目
+    bool bIsCached = false;
+    FImageDiskEntry CachedEntry;
+};
+
+static TMap<FString, TSharedPtr<FImageRequest>> ActiveRequests; // Fetches in flight by URL 以 URL 为键的进行中请求
+static TArray<TSharedPtr<FImageRequest>> ImageRequestQueue;     // Request task queue, in arrival order 请求任务队列，按到达顺序
+static int32 ActiveImageRequests = 0;                           // The number of requests currently active 当前活动的请求数
+static TMap<uint64, TWeakPtr<FImageRequest>> SubscribedRequests; // Fetch each handle waits for 每个句柄等待的请求
+static int32 ImageRequestGeneration = 0;                        // Bumped by CancelAllImageRequests so pending decodes are dropped 取消全部请求时递增，丢弃未完成的解码
+static uint64 NextImageRequestId = 1;
+static TSet<uint64> LiveImageRequests;                          // Handles that have neither called back nor been cancelled 尚未回调也未取消的句柄
+
+static TAutoConsoleVariable<int32> CVarImageMaxConcurrentRequests(
+    TEXT("RSAsset.ImageMaxConcurrentRequests"),
+    6,
+    TEXT("Maximum number of preview image downloads running at once. Queued downloads start by visibility of their tiles, then in arrival order."));
+
+static TAutoConsoleVariable<float> CVarImageUploadBudgetMs(
+    TEXT("RSAsset.ImageUploadBudgetMs"),
+    2.0f,
+    TEXT("Game thread time in milliseconds spent creating preview textures from decoded images per frame. At least one texture is created each frame."));
+
+static TAutoConsoleVariable<int32> CVarThumbnailSize(
+    TEXT("RSAsset.ThumbnailSize"),
+    300,
+    TEXT("Longest side in pixels of the preview textures of the asset grids, twice the 150 pixel tiles for high-DPI screens. 0 keeps the full resolution."));
+
+/** A decoded image waiting for the game thread to turn it into a texture. */
+struct FPendingTextureUpload
+{
+    TSharedPtr<FDecodedImage> Image;
+    TFunction<void(UTexture2D*)> OnTextureCreated;
+    int32 Generation = 0;
+};
 
-static TQueue<TFunction<void()>> ImageRequestQueue; // Request task queue 请求任务队列
-static FThreadSafeCounter ActiveImageRequests;      // The number of requests currently active 当前活动的请求数
-static const int32 MaxConcurrentImageRequests = 5; // Maximum number of concurrent requests 最大并发请求数
+static TArray<FPendingTextureUpload> PendingTextureUploads;
+static FTSTicker::FDelegateHandle TextureUploadTickerHandle;
 
-void FImageLoader::LoadImageFromUrl(const FString& Url, FOnProjectImageReady OnImageReadyDelegate)
+static bool ProcessTextureUploads(float DeltaTime)
 {
-    // Add the request to the task queue 将请求加入任务队列
-    ImageRequestQueue.Enqueue([Url, OnImageReadyDelegate]()
+    const double Deadline = FPlatformTime::Seconds() + CVarImageUploadBudgetMs.GetValueOnGameThread() / 1000.0;
+
+    // At least one texture per frame so a small budget still makes progress 每帧至少创建一个纹理，预算很小时也能推进
+    int32 NumProcessed = 0;
+    while (NumProcessed < PendingTextureUploads.Num() && (NumProcessed == 0 || FPlatformTime::Seconds() < Deadline))
     {
-        TSharedRef<IHttpRequest, ESPMode::ThreadSafe> HttpRequest = FHttpModule::Get().CreateRequest();
-        HttpRequest->SetURL(Url);
-        HttpRequest->SetVerb(TEXT("GET"));
+        // Moved out because the callback may queue further uploads 先移出，因为回调可能加入新的上传
+        FPendingTextureUpload Upload = MoveTemp(PendingTextureUploads[NumProcessed++]);
+        if (Upload.Generation == ImageRequestGeneration)
+        {
+            Upload.OnTextureCreated(FImageLoader::CreateTextureFromImage(*Upload.Image));
+        }
+    }
+    PendingTextureUploads.RemoveAt(0, NumProcessed);
 
-        // Save the request for subsequent cancellation 保存请求以便后续取消
-        ActiveRequests.Add(Url, HttpRequest);
+    if (PendingTextureUploads.Num() == 0)
+    {
+        TextureUploadTickerHandle.Reset();
+        return false;
+    }
+    return true;
+}
 
-        // Callback when the binding request completes 绑定请求完成时的回调
-        HttpRequest->OnProcessRequestComplete().BindStatic(&FImageLoader::OnImageRequestComplete, OnImageReadyDelegate, Url);
-        HttpRequest->ProcessRequest();
-    });
+static bool IsImageRequestActive(const TSharedPtr<FImageRequest>& Request)
+{
+    return ActiveRequests.FindRef(Request->Url) == Request;
+}
+
+static void CompleteImageRequest(const TSharedPtr<FImageRequest>& Request, const TArray<uint8>& ImageData, EImageCacheResult Result)
+{
+    ActiveRequests.Remove(Request->Url);
 
-    // Check if you can handle the next task 检查是否可以处理下一个任务
-    ProcessNextImageRequest();
+    // Every subscriber gets the same bytes; only the first one counts as the lookup that fetched them 所有订阅者获得相同的数据，只有第一个计为实际获取的查找
+    const TArray<FImageSubscriber> Subscribers = MoveTemp(Request->Subscribers);
+    for (const FImageSubscriber& Subscriber : Subscribers)
+    {
+        SubscribedRequests.Remove(Subscriber.Id);
+    }
+    for (int32 Index = 0; Index < Subscribers.Num(); ++Index)
+    {
+        FImageCache::Get().RecordLookup(Index == 0 ? Result : EImageCacheResult::Coalesced);
+        Subscribers[Index].OnImageData(ImageData);
+    }
 }
 
-void FImageLoader::ProcessNextImageRequest()
+/** Stops the fetch and forgets its subscribers; a running download gives its slot back at once. */
+static void AbortImageRequest(const TSharedPtr<FImageRequest>& Request)
 {
-    if (ActiveImageRequests.GetValue() >= MaxConcurrentImageRequests)
+    ActiveRequests.Remove(Request->Url);
+    ImageRequestQueue.Remove(Request);
+    for (const FImageSubscriber& Subscriber : Request->Subscribers)
+    {
+        LiveImageRequests.Remove(Subscriber.Id);
+        SubscribedRequests.Remove(Subscriber.Id);
+    }
+    Request->Subscribers.Empty();
+
+    if (Request->HttpRequest.IsValid())
     {
-        return; // Reach the maximum number of concurrent requests and wait for idle 达到最大并发数，等待空闲
+        ActiveImageRequests--; // Reduce the active request count 减少活动请求计数
+        FHttpRequestPtr HttpRequest = MoveTemp(Request->HttpRequest);
+        HttpRequest->CancelRequest();
     }
+}
 
-    TFunction<void()> Task;
-    if (ImageRequestQueue.Dequeue(Task))
+static void UpdateImageRequestPriority(FImageRequest& Request)
+{
+    Request.Priority = EImageLoadPriority::OffScreen;
+    for (const FImageSubscriber& Subscriber : Request.Subscribers)
     {
-        ActiveImageRequests.Increment(); // Increase the active request count 增加活动请求计数
-        Task(); // Execute request 执行请求
+        Request.Priority = FMath::Max(Request.Priority, Subscriber.Priority);
     }
 }
 
-void FImageLoader::OnImageRequestComplete(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful, FOnProjectImageReady OnImageReadyDelegate, FString Url)
+static void QueueImageDownload(const TSharedPtr<FImageRequest>& Request)
+{
+    ImageRequestQueue.Add(Request);
+    FImageLoader::ProcessNextImageRequest();
+}
+
+static void ReadImageFromDisk(const TSharedPtr<FImageRequest>& Request, EImageCacheResult Result)
+{
+    FImageCache::Get().LoadBytes(Request->Url, [Request, Result](const TArray<uint8>& ImageData)
+    {
+        if (!IsImageRequestActive(Request))
+        {
+            return;
+        }
+
+        if (ImageData.Num() == 0)
+        {
+            // The file was deleted behind the cache's back, download it again 文件已被外部删除，重新下载
+            FImageCache::Get().RemoveDiskEntry(Request->Url);
+            Request->bIsCached = false;
+            QueueImageDownload(Request);
+            return;
+        }
+
+        CompleteImageRequest(Request, ImageData, Result);
+    });
+}
+
+static void OnImageRequestComplete(FHttpRequestPtr HttpRequest, FHttpResponsePtr Response, bool bWasSuccessful, TWeakPtr<FImageRequest> WeakRequest)
 {
-    // Removed from the active request list 从活动请求列表中移除
-    ActiveRequests.Remove(Url);
-    ActiveImageRequests.Decrement(); // Reduce the active request count 减少活动请求计数
+    // A cancelled request already gave its slot back 已取消的请求已归还并发名额
+    TSharedPtr<FImageRequest> Request = WeakRequest.Pin();
+    if (!Request.IsValid() || !IsImageRequestActive(Request))
+    {
+        return;
+    }
 
-    if (bWasSuccessful && Response.IsValid())
+    Request->HttpRequest.Reset();
+    ActiveImageRequests--; // Reduce the active request count 减少活动请求计数
+
+    if (bWasSuccessful && Response.IsValid() && Response->GetResponseCode() == EHttpResponseCodes::NotModified)
+    {
+        FImageCache::Get().MarkRevalidated(Request->Url);
+        ReadImageFromDisk(Request, EImageCacheResult::Revalidated);
+    }
+    else if (bWasSuccessful && Response.IsValid())
     {
         const TArray<uint8>& ImageData = Response->GetContent();
-        // UE_LOG(LogTemp, Log, TEXT("Image download successful for URL: %s. Data size: %d"), *Url, ImageData.Num());
-        
-        if (OnImageReadyDelegate.IsBound())
+        if (EHttpResponseCodes::IsOk(Response->GetResponseCode()))
         {
-            Async(EAsyncExecution::TaskGraphMainThread, [OnImageReadyDelegate, ImageData]()
-            {
-                OnImageReadyDelegate.Execute(ImageData);
-            });
+            FImageCache::Get().StoreBytes(Request->Url, ImageData, Response->GetHeader(TEXT("ETag")), Response->GetHeader(TEXT("Last-Modified")));
         }
+        // UE_LOG(LogTemp, Log, TEXT("Image download successful for URL: %s. Data size: %d"), *Request->Url, ImageData.Num());
+
+        CompleteImageRequest(Request, ImageData, EImageCacheResult::Miss);
     }
     else
     {
-        // UE_LOG(LogTemp, Error, TEXT("Failed to load image from URL: %s"), *Url);
+        // UE_LOG(LogTemp, Error, TEXT("Failed to load image from URL: %s"), *Request->Url);
+        AbortImageRequest(Request);
     }
 
     // Try to tackle the next task 尝试处理下一个任务
-    ProcessNextImageRequest();
+    FImageLoader::ProcessNextImageRequest();
+}
+
+static void StartImageDownload(const TSharedPtr<FImageRequest>& Request)
+{
+    TSharedRef<IHttpRequest, ESPMode::ThreadSafe> HttpRequest = FHttpModule::Get().CreateRequest();
+    HttpRequest->SetURL(Request->Url);
+    HttpRequest->SetVerb(TEXT("GET"));
+
+    // A stale entry is revalidated, the server answers 304 when it is unchanged 过期条目需重新验证，未变化时服务器返回 304
+    if (Request->bIsCached && !Request->CachedEntry.ETag.IsEmpty())
+    {
+        HttpRequest->SetHeader(TEXT("If-None-Match"), Request->CachedEntry.ETag);
+    }
+    if (Request->bIsCached && !Request->CachedEntry.LastModified.IsEmpty())
+    {
+        HttpRequest->SetHeader(TEXT("If-Modified-Since"), Request->CachedEntry.LastModified);
+    }
+
+    // Save the request for subsequent cancellation 保存请求以便后续取消
+    Request->HttpRequest = HttpRequest;
+
+    // Callback when the binding request completes 绑定请求完成时的回调
+    HttpRequest->OnProcessRequestComplete().BindStatic(&OnImageRequestComplete, TWeakPtr<FImageRequest>(Request));
+    HttpRequest->ProcessRequest();
+}
+
+/** Adds the caller to the fetch of Url, starting one when none is in flight. */
+static void SubscribeToImage(const FString& Url, uint64 RequestId, TFunction<void(const TArray<uint8>&)> OnImageData)
+{
+    LiveImageRequests.Add(RequestId);
+
+    FImageSubscriber Subscriber;
+    Subscriber.Id = RequestId;
+    Subscriber.OnImageData = MoveTemp(OnImageData);
+
+    // A later caller for the same URL joins the fetch in flight 同一 URL 的后续调用方加入进行中的请求
+    if (TSharedPtr<FImageRequest>* ActiveRequest = ActiveRequests.Find(Url))
+    {
+        (*ActiveRequest)->Subscribers.Add(MoveTemp(Subscriber));
+        UpdateImageRequestPriority(**ActiveRequest);
+        SubscribedRequests.Add(RequestId, *ActiveRequest);
+        return;
+    }
+
+    TSharedPtr<FImageRequest> Request = MakeShared<FImageRequest>();
+    Request->Url = Url;
+    Request->Subscribers.Add(MoveTemp(Subscriber));
+    ActiveRequests.Add(Url, Request);
+    SubscribedRequests.Add(RequestId, Request);
+
+    // Fresh bytes on disk are used without asking the server 磁盘上未过期的数据无需请求服务器
+    Request->bIsCached = FImageCache::Get().FindDiskEntry(Url, Request->CachedEntry);
+    if (Request->bIsCached && FImageCache::IsFresh(Request->CachedEntry))
+    {
+        ReadImageFromDisk(Request, EImageCacheResult::DiskHit);
+    }
+    else
+    {
+        // Add the request to the task queue 将请求加入任务队列
+        QueueImageDownload(Request);
+    }
+}
+
+FImageRequestHandle FImageLoader::LoadImageFromUrl(const FString& Url, FOnProjectImageReady OnImageReadyDelegate)
+{
+    const uint64 RequestId = NextImageRequestId++;
+    SubscribeToImage(Url, RequestId, [RequestId, OnImageReadyDelegate](const TArray<uint8>& ImageData)
+    {
+        if (LiveImageRequests.Remove(RequestId) > 0)
+        {
+            OnImageReadyDelegate.ExecuteIfBound(ImageData);
+        }
+    });
+    return FImageRequestHandle(RequestId);
+}
+
+void FImageLoader::ProcessNextImageRequest()
+{
+    // Reach the maximum number of concurrent requests and wait for idle 达到最大并发数，等待空闲
+    const int32 MaxConcurrentImageRequests = FMath::Max(1, CVarImageMaxConcurrentRequests.GetValueOnGameThread());
+    while (ActiveImageRequests < MaxConcurrentImageRequests && ImageRequestQueue.Num() > 0)
+    {
+        // The most urgent request first, the oldest among equals 先处理最紧急的请求，同级中最早的优先
+        int32 NextIndex = 0;
+        for (int32 Index = 1; Index < ImageRequestQueue.Num(); ++Index)
+        {
+            if (ImageRequestQueue[Index]->Priority > ImageRequestQueue[NextIndex]->Priority)
+            {
+                NextIndex = Index;
+            }
+        }
+
+        TSharedPtr<FImageRequest> Request = ImageRequestQueue[NextIndex];
+        ImageRequestQueue.RemoveAt(NextIndex);
+
+        ActiveImageRequests++; // Increase the active request count 增加活动请求计数
+        StartImageDownload(Request); // Execute request 执行请求
+    }
+}
+
+void FImageLoader::CancelImageRequest(FImageRequestHandle Handle)
+{
+    if (LiveImageRequests.Remove(Handle.Id) == 0)
+    {
+        return;
+    }
+
+    TWeakPtr<FImageRequest> WeakRequest;
+    SubscribedRequests.RemoveAndCopyValue(Handle.Id, WeakRequest);
+    TSharedPtr<FImageRequest> Request = WeakRequest.Pin();
+    if (!Request.IsValid())
+    {
+        return;
+    }
+
+    Request->Subscribers.RemoveAll([&Handle](const FImageSubscriber& Subscriber)
+    {
+        return Subscriber.Id == Handle.Id;
+    });
+    UpdateImageRequestPriority(*Request);
+
+    // The fetch only stops once nobody waits for it any more 只有无人等待时才停止请求
+    if (Request->Subscribers.Num() == 0)
+    {
+        AbortImageRequest(Request);
+        ProcessNextImageRequest();
+    }
 }
 
 void FImageLoader::CancelImageRequest(const FString& Url)
 {
-    TSharedPtr<IHttpRequest> HttpRequest = ActiveRequests.FindRef(Url);
-    if (HttpRequest.IsValid())
+    TSharedPtr<FImageRequest> Request = ActiveRequests.FindRef(Url);
+    if (Request.IsValid())
     {
-        HttpRequest->CancelRequest();
-        ActiveRequests.Remove(Url);
-        ActiveImageRequests.Decrement(); // Reduce the active request count 减少活动请求计数
+        AbortImageRequest(Request);
+        ProcessNextImageRequest();
         // UE_LOG(LogTemp, Log, TEXT("Cancelled image request for URL: %s"), *Url);
     }
 }
 
-void FImageLoader::CancelAllImageRequests()
+void FImageLoader::SetImageRequestPriority(FImageRequestHandle Handle, EImageLoadPriority Priority)
 {
-    // Cancel a request in progress 取消正在进行的请求
-    for (auto& Pair : ActiveRequests)
+    TSharedPtr<FImageRequest> Request = SubscribedRequests.FindRef(Handle.Id).Pin();
+    if (!Request.IsValid())
     {
-        if (Pair.Value.IsValid())
+        return;
+    }
+
+    for (FImageSubscriber& Subscriber : Request->Subscribers)
+    {
+        if (Subscriber.Id == Handle.Id)
         {
-            Pair.Value->CancelRequest();
+            Subscriber.Priority = Priority;
         }
     }
+    UpdateImageRequestPriority(*Request);
+}
 
-    // Clear the activity request mapping table 清空活动请求映射表
-    ActiveRequests.Empty();
+void FImageLoader::CancelAllImageRequests()
+{
+    // Cancel a request in progress 取消正在进行的请求
+    TArray<TSharedPtr<FImageRequest>> Requests;
+    ActiveRequests.GenerateValueArray(Requests);
+    for (const TSharedPtr<FImageRequest>& Request : Requests)
+    {
+        AbortImageRequest(Request);
+    }
 
     // Stop all queued requests 停止所有排队的请求
-    TFunction<void()> Dummy;
-    while (ImageRequestQueue.Dequeue(Dummy)) {}
+    ImageRequestQueue.Empty();
+    LiveImageRequests.Empty();
+    SubscribedRequests.Empty();
 
     // Reset count 重置计数
-    ActiveImageRequests.Reset();
+    ActiveImageRequests = 0;
+
+    // Drop decodes that have not called back yet 丢弃尚未回调的解码
+    ImageRequestGeneration++;
+}
+
+FIntPoint FImageLoader::GetThumbnailSize()
+{
+    const int32 ThumbnailSize = FMath::Max(0, CVarThumbnailSize.GetValueOnGameThread());
+    return FIntPoint(ThumbnailSize, ThumbnailSize);
+}
+
+FImageRequestHandle FImageLoader::LoadTextureFromUrl(const FString& Url, FIntPoint TargetSize, FOnImageTextureReady OnTextureReady)
+{
+    const FString CacheKey = TargetSize.X > 0 && TargetSize.Y > 0 ? FString::Printf(TEXT("%s#%dx%d"), *Url, TargetSize.X, TargetSize.Y) : Url;
+    if (UTexture2D* CachedTexture = FImageCache::Get().FindTexture(CacheKey))
+    {
+        FImageCache::Get().RecordLookup(EImageCacheResult::MemoryHit);
+        OnTextureReady.ExecuteIfBound(CachedTexture);
+        return FImageRequestHandle();
+    }
+
+    const uint64 RequestId = NextImageRequestId++;
+    SubscribeToImage(Url, RequestId, [RequestId, CacheKey, TargetSize, OnTextureReady](const TArray<uint8>& ImageData)
+    {
+        CreateTextureAsync(ImageData, TargetSize, [RequestId, CacheKey, OnTextureReady](UTexture2D* Texture)
+        {
+            // Another tile showing the same image may have decoded it meanwhile 显示同一图像的其他控件可能已完成解码
+            if (UTexture2D* CachedTexture = FImageCache::Get().FindTexture(CacheKey))
+            {
+                Texture = CachedTexture;
+            }
+            else
+            {
+                FImageCache::Get().AddTexture(CacheKey, Texture);
+            }
+
+            if (LiveImageRequests.Remove(RequestId) > 0)
+            {
+                OnTextureReady.ExecuteIfBound(Texture);
+            }
+        });
+    });
+    return FImageRequestHandle(RequestId);
+}
+
+void FImageLoader::CreateTextureAsync(const TArray<uint8>& ImageData, FIntPoint TargetSize, TFunction<void(UTexture2D*)> OnTextureCreated)
+{
+    // Workers only look the module up, loading it is left to the game thread 工作线程只查找模块，加载由游戏线程完成
+    FModuleManager::LoadModuleChecked<IImageWrapperModule>(TEXT("ImageWrapper"));
+
+    const int32 Generation = ImageRequestGeneration;
+    Async(EAsyncExecution::ThreadPool, [ImageData, TargetSize, OnTextureCreated = MoveTemp(OnTextureCreated), Generation]() mutable
+    {
+        TSharedPtr<FDecodedImage> Image = MakeShared<FDecodedImage>();
+        if (!DecodeImage(ImageData, *Image, TargetSize))
+        {
+            Image.Reset();
+        }
+
+        Async(EAsyncExecution::TaskGraphMainThread, [Image, OnTextureCreated = MoveTemp(OnTextureCreated), Generation]()
+        {
+            if (Generation != ImageRequestGeneration)
+            {
+                return;
+            }
+
+            if (!Image.IsValid())
+            {
+                OnTextureCreated(nullptr);
+                return;
+            }
+
+            PendingTextureUploads.Add({ Image, OnTextureCreated, Generation });
+            if (!TextureUploadTickerHandle.IsValid())
+            {
+                TextureUploadTickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateStatic(&ProcessTextureUploads));
+            }
+        });
+    });
 }
 
 
 
 
 UTexture2D* FImageLoader::CreateTextureFromBytes(const TArray<uint8>& ImageData)
+{
+    FModuleManager::LoadModuleChecked<IImageWrapperModule>(TEXT("ImageWrapper"));
+
+    FDecodedImage Image;
+    return DecodeImage(ImageData, Image) ? CreateTextureFromImage(Image) : nullptr;
+}
+
+bool FImageLoader::DecodeImage(const TArray<uint8>& ImageData, FDecodedImage& OutImage, FIntPoint TargetSize)
 {
     if (ImageData.Num() == 0)
     {
         // UE_LOG(LogTemp, Error, TEXT("Image data is empty, cannot create texture."));
-        return nullptr;
+        return false;
     }
 
     // Get the ImageWrapper module 获取 ImageWrapper 模块
-    IImageWrapperModule& ImageWrapperModule = FModuleManager::LoadModuleChecked<IImageWrapperModule>(TEXT("ImageWrapper"));
+    IImageWrapperModule& ImageWrapperModule = FModuleManager::GetModuleChecked<IImageWrapperModule>(TEXT("ImageWrapper"));
     EImageFormat ImageFormat = ImageWrapperModule.DetectImageFormat(ImageData.GetData(), ImageData.Num());
     if (ImageFormat == EImageFormat::Invalid)
     {
         // UE_LOG(LogTemp, Error, TEXT("Unrecognized image format."));
-        return nullptr;
+        return false;
     }
 
     // Create an ImageWrapper 创建 ImageWrapper
@@ -139,19 +502,127 @@ UTexture2D* FImageLoader::CreateTextureFromBytes(const TArray<uint8>& ImageData)
     if (!ImageWrapper.IsValid() || !ImageWrapper->SetCompressed(ImageData.GetData(), ImageData.Num()))
     {
         // UE_LOG(LogTemp, Error, TEXT("Failed to create or set compressed data for ImageWrapper."));
-        return nullptr;
+        return false;
     }
 
     // Get raw image data 获取原始图像数据
-    TArray<uint8> RawData;
-    if (!ImageWrapper->GetRaw(ERGBFormat::BGRA, 8, RawData))
+    if (!ImageWrapper->GetRaw(ERGBFormat::BGRA, 8, OutImage.Pixels))
     {
         // UE_LOG(LogTemp, Error, TEXT("Failed to get raw image data."));
-        return nullptr;
+        return false;
+    }
+
+    OutImage.Width = ImageWrapper->GetWidth();
+    OutImage.Height = ImageWrapper->GetHeight();
+
+    // Fit into the target size, keeping the aspect ratio; images are never scaled up 缩放到目标尺寸以内并保持宽高比，不放大
+    if (TargetSize.X > 0 && TargetSize.Y > 0 && (OutImage.Width > TargetSize.X || OutImage.Height > TargetSize.Y))
+    {
+        const double Scale = FMath::Min((double)TargetSize.X / OutImage.Width, (double)TargetSize.Y / OutImage.Height);
+        const int32 Width = FMath::Max(1, FMath::RoundToInt(OutImage.Width * Scale));
+        const int32 Height = FMath::Max(1, FMath::RoundToInt(OutImage.Height * Scale));
+
+        FDecodedImage Thumbnail;
+        ResizeImage(OutImage, Thumbnail, Width, Height);
+        OutImage = MoveTemp(Thumbnail);
+    }
+    return true;
+}
+
+/** Source samples and weights a box filter averages for each destination sample along one axis. */
+struct FBoxFilterTaps
+{
+    TArray<int32> FirstTap;
+    TArray<int32> SourceIndices;
+    TArray<float> Weights;
+
+    FBoxFilterTaps(int32 SourceSize, int32 DestSize)
+    {
+        const double Scale = (double)SourceSize / DestSize;
+        FirstTap.SetNumUninitialized(DestSize + 1);
+        for (int32 Dest = 0; Dest < DestSize; ++Dest)
+        {
+            FirstTap[Dest] = SourceIndices.Num();
+            const double Start = Dest * Scale;
+            const double End = Start + Scale;
+            const int32 LastSource = FMath::Min(FMath::CeilToInt(End), SourceSize);
+            for (int32 Source = FMath::FloorToInt(Start); Source < LastSource; ++Source)
+            {
+                // Share of the destination sample the source sample covers 源采样覆盖目标采样的比例
+                const double Coverage = FMath::Min(End, Source + 1.0) - FMath::Max(Start, (double)Source);
+                if (Coverage > 0.0)
+                {
+                    SourceIndices.Add(Source);
+                    Weights.Add((float)(Coverage / Scale));
+                }
+            }
+        }
+        FirstTap[DestSize] = SourceIndices.Num();
     }
+};
+
+void FImageLoader::ResizeImage(const FDecodedImage& Source, FDecodedImage& OutImage, int32 Width, int32 Height)
+{
+    const FBoxFilterTaps ColumnTaps(Source.Width, Width);
+    const FBoxFilterTaps RowTaps(Source.Height, Height);
+    const VectorRegister4Float Half = VectorSetFloat1(0.5f);
+
+    // Rows are narrowed first, so the second pass only touches the much smaller intermediate image 先缩小行宽，第二遍只处理小得多的中间图像
+    TArray<uint8> Narrowed;
+    Narrowed.SetNumUninitialized(Width * Source.Height * 4);
+    for (int32 Y = 0; Y < Source.Height; ++Y)
+    {
+        const uint8* SourceRow = Source.Pixels.GetData() + (int64)Y * Source.Width * 4;
+        uint8* NarrowedRow = Narrowed.GetData() + (int64)Y * Width * 4;
+        for (int32 X = 0; X < Width; ++X)
+        {
+            VectorRegister4Float Sum = VectorZeroFloat();
+            for (int32 Tap = ColumnTaps.FirstTap[X]; Tap < ColumnTaps.FirstTap[X + 1]; ++Tap)
+            {
+                Sum = VectorMultiplyAdd(VectorLoadByte4(SourceRow + ColumnTaps.SourceIndices[Tap] * 4), VectorSetFloat1(ColumnTaps.Weights[Tap]), Sum);
+            }
+            VectorStoreByte4(VectorAdd(Sum, Half), NarrowedRow + X * 4);
+        }
+    }
+
+    OutImage.Width = Width;
+    OutImage.Height = Height;
+    OutImage.Pixels.SetNumUninitialized(Width * Height * 4);
+
+    TArray<VectorRegister4Float> RowSums;
+    RowSums.SetNumUninitialized(Width);
+    for (int32 Y = 0; Y < Height; ++Y)
+    {
+        for (int32 X = 0; X < Width; ++X)
+        {
+            RowSums[X] = VectorZeroFloat();
+        }
+
+        // Whole rows are accumulated so the intermediate image is read in memory order 按整行累加，按内存顺序读取中间图像
+        for (int32 Tap = RowTaps.FirstTap[Y]; Tap < RowTaps.FirstTap[Y + 1]; ++Tap)
+        {
+            const uint8* NarrowedRow = Narrowed.GetData() + (int64)RowTaps.SourceIndices[Tap] * Width * 4;
+            const VectorRegister4Float Weight = VectorSetFloat1(RowTaps.Weights[Tap]);
+            for (int32 X = 0; X < Width; ++X)
+            {
+                RowSums[X] = VectorMultiplyAdd(VectorLoadByte4(NarrowedRow + X * 4), Weight, RowSums[X]);
+            }
+        }
+
+        uint8* DestRow = OutImage.Pixels.GetData() + (int64)Y * Width * 4;
+        for (int32 X = 0; X < Width; ++X)
+        {
+            VectorStoreByte4(VectorAdd(RowSums[X], Half), DestRow + X * 4);
+        }
+    }
+}
+
+UTexture2D* FImageLoader::CreateTextureFromImage(const FDecodedImage& Image)
+{
+    check(IsInGameThread());
 
     // Create a UTexture2D object 创建 UTexture2D 对象
-    UTexture2D* Texture = UTexture2D::CreateTransient(ImageWrapper->GetWidth(), ImageWrapper->GetHeight(), PF_B8G8R8A8);
+    UTexture2D* Texture = UTexture2D::CreateTransient(Image.Width, Image.Height, PF_B8G8R8A8);
     if (!Texture)
     {
         // UE_LOG(LogTemp, Error, TEXT("Failed to create transient texture."));
@@ -160,7 +631,7 @@ UTexture2D* FImageLoader::CreateTextureFromBytes(const TArray<uint8>& ImageData)
 
     // Lock texture data 锁定纹理数据
     void* TextureData = Texture->GetPlatformData()->Mips[0].BulkData.Lock(LOCK_READ_WRITE);
-    FMemory::Memcpy(TextureData, RawData.GetData(), RawData.Num());
+    FMemory::Memcpy(TextureData, Image.Pixels.GetData(), Image.Pixels.Num());
     Texture->GetPlatformData()->Mips[0].BulkData.Unlock();
 
     // Update texture resources 更新纹理资源
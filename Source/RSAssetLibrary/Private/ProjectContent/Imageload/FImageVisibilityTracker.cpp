@@ -0,0 +1,123 @@
+﻿// Copyright (c) 2024 Hunan MangoXR Tech Co., Ltd. All Rights Reserved.
+
+#include "ProjectContent/Imageload/FImageVisibilityTracker.h"
+#include "ProjectContent/Imageload/FImageCache.h"
+#include "HAL/IConsoleManager.h"
+#include "Layout/ArrangedWidget.h"
+#include "Widgets/SWidget.h"
+
+static TAutoConsoleVariable<float> CVarThumbnailPrefetchScreens(
+    TEXT("RSAsset.ThumbnailPrefetchScreens"),
+    1.0f,
+    TEXT("Thumbnails of tiles up to this many viewport sizes away from the visible part of an asset grid are prefetched before the rest."));
+
+void FImageVisibilityTracker::Reset()
+{
+    Tiles.Empty();
+    ResetTime = FPlatformTime::Seconds();
+    bFirstVisibleRecorded = false;
+}
+
+void FImageVisibilityTracker::Track(const TSharedRef<SWidget>& Tile, FImageRequestHandle Handle)
+{
+    FTrackedTile& TrackedTile = Tiles.AddDefaulted_GetRef();
+    TrackedTile.Tile = Tile;
+    TrackedTile.Handle = Handle;
+    TrackedTile.bShown = !Handle.IsValid();
+}
+
+void FImageVisibilityTracker::OnThumbnailShown(const TSharedRef<SWidget>& Tile)
+{
+    // A thumbnail from the memory cache is shown before its tile is tracked 内存缓存中的缩略图在控件被跟踪前即已显示
+    FTrackedTile* TrackedTile = FindTile(Tile);
+    if (TrackedTile == nullptr)
+    {
+        return;
+    }
+
+    TrackedTile->bShown = true;
+    if (TrackedTile->Priority == EImageLoadPriority::Visible)
+    {
+        RecordFirstVisible();
+    }
+}
+
+void FImageVisibilityTracker::Update(const FGeometry& ViewportGeometry, const TSharedRef<SWidget>& Content)
+{
+    if (Tiles.Num() == 0)
+    {
+        return;
+    }
+
+    TSet<TSharedRef<SWidget>> TileWidgets;
+    for (const FTrackedTile& TrackedTile : Tiles)
+    {
+        if (TSharedPtr<SWidget> Tile = TrackedTile.Tile.Pin())
+        {
+            TileWidgets.Add(Tile.ToSharedRef());
+        }
+    }
+
+    // Arranging from the content finds tiles the scroll box culled as well 从内容控件排列子项，被滚动框裁剪的控件也能找到
+    TMap<TSharedRef<SWidget>, FArrangedWidget> TileGeometries;
+    Content->FindChildGeometries(Content->GetPaintSpaceGeometry(), TileWidgets, TileGeometries);
+
+    const FSlateRect Viewport = ViewportGeometry.GetLayoutBoundingRect();
+    const float PrefetchScreens = FMath::Max(0.0f, CVarThumbnailPrefetchScreens.GetValueOnGameThread());
+    const FSlateRect PrefetchArea = Viewport.ExtendBy(FMargin((Viewport.Right - Viewport.Left) * PrefetchScreens, (Viewport.Bottom - Viewport.Top) * PrefetchScreens));
+
+    for (FTrackedTile& TrackedTile : Tiles)
+    {
+        TSharedPtr<SWidget> Tile = TrackedTile.Tile.Pin();
+        const FArrangedWidget* ArrangedTile = Tile.IsValid() ? TileGeometries.Find(Tile.ToSharedRef()) : nullptr;
+        if (ArrangedTile == nullptr)
+        {
+            continue;
+        }
+
+        const FSlateRect TileRect = ArrangedTile->Geometry.GetLayoutBoundingRect();
+        EImageLoadPriority Priority = EImageLoadPriority::OffScreen;
+        if (FSlateRect::DoRectanglesIntersect(TileRect, Viewport))
+        {
+            Priority = EImageLoadPriority::Visible;
+        }
+        else if (FSlateRect::DoRectanglesIntersect(TileRect, PrefetchArea))
+        {
+            Priority = EImageLoadPriority::NearViewport;
+        }
+
+        if (Priority != TrackedTile.Priority)
+        {
+            TrackedTile.Priority = Priority;
+            FImageLoader::SetImageRequestPriority(TrackedTile.Handle, Priority);
+        }
+
+        if (Priority == EImageLoadPriority::Visible && TrackedTile.bShown)
+        {
+            RecordFirstVisible();
+        }
+    }
+
+    // Tiles removed from the grid no longer need a rank 已从网格移除的控件无需排序
+    Tiles.RemoveAll([](const FTrackedTile& TrackedTile)
+    {
+        return !TrackedTile.Tile.IsValid();
+    });
+}
+
+FImageVisibilityTracker::FTrackedTile* FImageVisibilityTracker::FindTile(const TSharedRef<SWidget>& Tile)
+{
+    return Tiles.FindByPredicate([&Tile](const FTrackedTile& TrackedTile)
+    {
+        return TrackedTile.Tile.HasSameObject(&Tile.Get());
+    });
+}
+
+void FImageVisibilityTracker::RecordFirstVisible()
+{
+    if (!bFirstVisibleRecorded)
+    {
+        bFirstVisibleRecorded = true;
+        FImageCache::Get().RecordTimeToFirstVisible(FPlatformTime::Seconds() - ResetTime);
+    }
+}
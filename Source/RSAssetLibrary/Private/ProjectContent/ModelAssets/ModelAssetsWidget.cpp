@@ -1,12 +1,10 @@
 ﻿// Copyright (c) 2024 Hunan MangoXR Tech Co., Ltd. All Rights Reserved.
 
 #include "ProjectContent/ModelAssets/ModelAssetsWidget.h"
+#include "ProjectContent/AssetImport/FAssetImportPipeline.h"
 #include "DesktopPlatformModule.h"
 #include "RSpaceAssetLibApi/Public/ModelLibrary/GetModelLibraryData.h"
 #include "RSAssetLibraryStyle.h"
-#include "Factories/FbxFactory.h"
-#include "Factories/FbxImportUI.h"
-#include "Factories/FbxStaticMeshImportData.h"
 #include "ModelLibrary/GetModelFileHistoryApi.h"
 #include "ModelLibrary/GetModelFileTagApi.h"
 #include "ProjectContent/Imageload/FImageLoader.h"
@@ -57,6 +55,8 @@ void SModelAssetsWidget::Construct(const FArguments& InArgs)
 	];
 
     InitializeDetailClickedButtonStyle();
+
+    RegisterActiveTimer(FImageVisibilityTracker::UpdateInterval, FWidgetActiveTimerDelegate::CreateSP(this, &SModelAssetsWidget::UpdateThumbnailVisibility));
 }
 
 
@@ -784,7 +784,14 @@ TSharedRef<SWidget> SModelAssetsWidget::GenerateDetailsWidget(const FModelFileDe
                                  .Cursor(EMouseCursor::Hand)
                                  .ButtonStyle(&ImportButtonStyle)
                                  .ContentPadding(0) 
-                                 .OnClicked(this, &SModelAssetsWidget::OnImportFBXButtonClicked)
+                                 .ToolTipText(LOCTEXT("ImportTooltip", "Import into the project, downloading the file first if needed"))
+                                 .OnClicked_Lambda([this, FileDetailsItem]()-> FReply
+                                 {
+                                     SelectedModelFileInfo.FileName = ModelFileName;
+                                     SelectedModelFileInfo.FileUrl = SelectedRelativePath.IsValid() ? *SelectedRelativePath : FString();
+                                     SelectedModelFileInfo.FileMd5 = FileDetailsItem.fileMd5;
+                                     return OnImportFBXButtonClicked();
+                                 })
                                  [
                                      SNew(SBox)
                                      .WidthOverride(40)
@@ -896,25 +903,23 @@ void SModelAssetsWidget::OnVersionSelected(TSharedPtr<FString> NewSelection, ESe
 
 void SModelAssetsWidget::ClearModelContent()
 {
-    if (LoadedTextures.Num() > 0)
+    // FImageCache still holds the model previews, so returning to the folder needs no reload FImageCache 仍持有模型预览图，返回该文件夹时无需重新加载
+    LoadedTextures.Empty();
+    ThumbnailVisibility.Reset();
+
+    if (ModelAssetsContainer.IsValid())
     {
-        for (UTexture2D* Texture : LoadedTextures)
-        {
-            if (Texture)
-            {
-                Texture->ReleaseResource();
-                Texture->RemoveFromRoot();
-                Texture->MarkAsGarbage();
-            }
-        }
-        LoadedTextures.Empty();
-        
+        ModelAssetsContainer->ClearChildren();
     }
+}
 
+EActiveTimerReturnType SModelAssetsWidget::UpdateThumbnailVisibility(double InCurrentTime, float InDeltaTime)
+{
     if (ModelAssetsContainer.IsValid())
     {
-        ModelAssetsContainer->ClearChildren();
+        ThumbnailVisibility.Update(GetPaintSpaceGeometry(), ModelAssetsContainer.ToSharedRef());
     }
+    return EActiveTimerReturnType::Continue;
 }
 
 
@@ -971,67 +976,25 @@ FReply SModelAssetsWidget::OnImportFBXButtonClicked()
 
 void SModelAssetsWidget::ImportFBXFile(const FString& FilePath)
 {
-    static TSharedPtr<SWindow> ExistingNotificationWindow;
     static TSharedPtr<SWindow> ExistingNotificationWindow2;
     
-    // Check if the file is still being downloaded 检查文件是否仍在下载中
+    // A file that is still downloading is imported once its download completed 仍在下载的文件在下载完成后导入
     if (AssetDownloadWidget.IsValid() && AssetDownloadWidget->IsFileDownloading(FilePath))
     {
-        if (ExistingNotificationWindow.IsValid() && FSlateApplication::Get().FindWidgetWindow(ExistingNotificationWindow.ToSharedRef()))
-        {
-            ExistingNotificationWindow->BringToFront();
-            return;
-        }
-        
-        ExistingNotificationWindow = SNew(SWindow)
-            .Title(LOCTEXT("TipTitle", "Notification"))
-            .ClientSize(FVector2D(200, 100))
-            .FocusWhenFirstShown(true)
-            .SupportsMaximize(false)
-            .SupportsMinimize(false)
-            .IsTopmostWindow(false)
-            .Content()
-            [
-                SNew(SVerticalBox)
-                + SVerticalBox::Slot()
-                .AutoHeight()
-                .Padding(10)
-                .HAlign(HAlign_Center)
-                [
-                    SNew(STextBlock)
-                    .Text(LOCTEXT("ResourceDownloading", "Resource is downloading！"))
-                    .Justification(ETextJustify::Center)
-                ]
-                + SVerticalBox::Slot()
-                .AutoHeight()
-                .Padding(10, 20, 10, 10)
-                .HAlign(HAlign_Center)
-                [
-                    SNew(SButton)
-                    .Text(LOCTEXT("Confirm", "OK"))
-                    .OnClicked_Lambda([]() -> FReply {
-                        if (ExistingNotificationWindow.IsValid())
-                        {
-                            FSlateApplication::Get().RequestDestroyWindow(ExistingNotificationWindow.ToSharedRef());
-                            ExistingNotificationWindow.Reset();
-                        }
-                        return FReply::Handled();
-                    })
-                ]
-            ];
-
-        ExistingNotificationWindow->SetOnWindowClosed(FOnWindowClosed::CreateLambda([this](const TSharedRef<SWindow>&)
-        {
-              ExistingNotificationWindow.Reset(); // Reset pointer after window destruction 窗口销毁后重置指针
-        }));
-        
-        FSlateApplication::Get().AddWindow(ExistingNotificationWindow.ToSharedRef());
+        FAssetImportPipeline::Get().ImportWhenDownloaded(FPaths::GetCleanFilename(FilePath), EAssetImportKind::Model);
         return;
     }
 
     // Check whether the file exists 检查文件是否存在
     if (!FPaths::FileExists(FilePath))
     {
+        // A file that was never downloaded is downloaded first and imported afterwards 未下载的文件先下载再导入
+        if (!SelectedModelFileInfo.FileUrl.IsEmpty() && SelectedModelFileInfo.FileName == FPaths::GetCleanFilename(FilePath))
+        {
+            FAssetImportPipeline::Get().DownloadAndImport(SelectedModelFileInfo.FileName, SelectedModelFileInfo.FileUrl, SelectedModelFileInfo.FileMd5, EAssetImportKind::Model);
+            return;
+        }
+
         // UE_LOG(LogTemp, Error, TEXT("Concept file does not exist at: %s"), *FilePath);
 
         // If the window already exists and is valid, put it first 如果窗口已存在且有效，将其置于最前
@@ -1090,70 +1053,7 @@ void SModelAssetsWidget::ImportFBXFile(const FString& FilePath)
         return;
     }
 
-    // Creating an import path 创建导入路径
-    FString ImportPath = TEXT("/Game/RSpaceImportedAssets/Models");
-
-    // Gets the file name (including the extension) and finds the location of the last '. ' 获取文件名（包含扩展名）并找到最后一个 `.` 的位置
-    FString FileNameWithExtension = FPaths::GetCleanFilename(FilePath);
-    int32 LastDotIndex;
-    if (FileNameWithExtension.FindLastChar('.', LastDotIndex))
-    {
-        // Separate file name and extension 分离文件名和扩展名
-        FString NamePart = FileNameWithExtension.Left(LastDotIndex).Replace(TEXT("."), TEXT("_")); // Replace all '. 'in the file name 替换文件名中的所有 `.`
-        FString ExtensionPart = FileNameWithExtension.RightChop(LastDotIndex); // Keep the extension (including the last '. ') 保留扩展名（包括最后的 `.`）
-
-        // Combine new file names 组合新的文件名
-        FileNameWithExtension = NamePart + ExtensionPart;
-    }
-
-    // Gets the file name used for the display (remove the extension and replace '. 'with' _ ') 获取显示用的文件名（去掉扩展名，替换 `.` 为 `_`）
-    FString DisplayFileName = FPaths::GetBaseFilename(FileNameWithExtension).Replace(TEXT("."), TEXT("_"));
-
-    // Construct package name 构造包名称
-    FString PackageName = ImportPath + TEXT("/") + DisplayFileName;
-
-    // Check whether the package already exists 检查包是否已经存在
-    UPackage* ExistingPackage = FindPackage(nullptr, *PackageName);
-    if (ExistingPackage)
-    {
-        UE_LOG(LogTemp, Warning, TEXT("Package already exists: %s"), *PackageName);
-        return;
-    }
-
-    // Create package 创建包
-    UPackage* Package = CreatePackage(*PackageName);
-
-    // Configure import options 配置导入选项
-    UFbxFactory* FbxFactory = NewObject<UFbxFactory>(UFbxFactory::StaticClass());
-    FbxFactory->ImportUI->bAutomatedImportShouldDetectType = true; // Automatic detection type 自动检测类型
-    FbxFactory->ImportUI->bImportAsSkeletal = true;               // Nonskeletal model 非骨骼模型
-    FbxFactory->ImportUI->bImportMaterials = true;                // Import material 导入材质
-    FbxFactory->ImportUI->bImportTextures = true;                 // mport texture 导入纹理
-    FbxFactory->ImportUI->bImportAnimations = false;              // Do not import animation 不导入动画
-    FbxFactory->ImportUI->MeshTypeToImport = FBXIT_SkeletalMesh;  // Imported bone model 导入骨骼模型
-    FbxFactory->ImportUI->bImportMesh = true;                     // Lead-in grid 导入网格
-    FbxFactory->ImportUI->bAutoComputeLodDistances = true;
-    FbxFactory->ImportUI->StaticMeshImportData->bCombineMeshes = true;
-    FbxFactory->ImportUI->StaticMeshImportData->ImportUniformScale = 1.0f;
-    FbxFactory->ImportUI->StaticMeshImportData->bAutoGenerateCollision = true;
-
-    // Do not display dialog box, import directly 不显示对话框，直接导入
-    EObjectFlags Flags = RF_Transactional | RF_Public | RF_Standalone;
-
-    // Call the ImportObject method to import the asset 调用 ImportObject 方法导入资产
-    bool bOutCanceled = false;
-    const TCHAR* Parms = nullptr;
-    UObject* ImportedAsset = FbxFactory->ImportObject(UStaticMesh::StaticClass(), Package, FName(*DisplayFileName), Flags, FilePath, Parms, bOutCanceled);
-
-    // Check whether the import is successful 检查导入是否成功
-    if (ImportedAsset && !bOutCanceled)
-    {
-        UE_LOG(LogTemp, Log, TEXT("FBX Import Successful!"));
-    }
-    else
-    {
-        UE_LOG(LogTemp, Warning, TEXT("FBX Import Failed or Canceled!"));
-    }
+    FAssetImportPipeline::Get().ImportFile(FilePath, EAssetImportKind::Model);
 }
 
 TSharedRef<SWidget> SModelAssetsWidget::LoadImageFromUrl(const FString& GifUrl)
@@ -1180,47 +1080,26 @@ TSharedRef<SWidget> SModelAssetsWidget::LoadImageFromUrl(const FString& GifUrl)
     if (!GifUrl.IsEmpty())
     {
   
-        FImageLoader::LoadImageFromUrl(GifUrl, FOnProjectImageReady::CreateLambda([this, GifUrl, ImageBox](const TArray<uint8>& ImageData)
+        const FImageRequestHandle ThumbnailRequest = FImageLoader::LoadTextureFromUrl(GifUrl, FImageLoader::GetThumbnailSize(), FOnImageTextureReady::CreateLambda([this, GifUrl, ImageBox](UTexture2D* LoadedTexture)
         {
-            if (ImageData.Num() > 0)
+            if (LoadedTexture && ImageBox.IsValid())
             {
-                UTexture2D* LoadedTexture = FImageLoader::CreateTextureFromBytes(ImageData);
-                if (LoadedTexture && ImageBox.IsValid())
-                {
-                    // UE_LOG(LogTemp, Log, TEXT("Image loaded successfully"));
-       
-                    ImageBox->SetContent(
-                        SNew(SImage)
-                        .Image(new FSlateImageBrush(LoadedTexture, FVector2D(150, 150)))
-                    );
+                // UE_LOG(LogTemp, Log, TEXT("Image loaded successfully"));
+   
+                ImageBox->SetContent(
+                    SNew(SImage)
+                    .Image(new FSlateImageBrush(LoadedTexture, FVector2D(150, 150)))
+                );
 
-                    LoadedTextures.Add(LoadedTexture);
-                    LoadedTexture->AddToRoot();
-                }
-                else
-                {
-                    // UE_LOG(LogTemp, Warning, TEXT("Failed to load texture from bytes or ImageBox is invalid: %s"), *GifUrl);
-                    
-           
-                    ImageBox->SetContent(
-                        SNew(SBorder)
-                        .BorderBackgroundColor(FLinearColor(1.0f, 0.0f, 0.0f, 1.0f))
-                        [
-                            SNew(SBox).HAlign(HAlign_Center).VAlign(VAlign_Center)
-                            [
-                                SNew(STextBlock)
-                                .Text(LOCTEXT("ImageLoadFailed", "Load Failed"))
-                                .Justification(ETextJustify::Center)
-                            ]
-                        ]
-                    );
-                }
+                // A model preview may be evicted from FImageCache, so the tile keeps its own reference 模型预览图可能被 FImageCache 淘汰，因此控件自己保持引用
+                LoadedTextures.Add(TStrongObjectPtr<UTexture2D>(LoadedTexture));
+                ThumbnailVisibility.OnThumbnailShown(ImageBox.ToSharedRef());
             }
             else
             {
-                // UE_LOG(LogTemp, Error, TEXT("Image data is empty, failed to download or decode image from URL: %s"), *GifUrl);
+                // UE_LOG(LogTemp, Warning, TEXT("Failed to load texture from bytes or ImageBox is invalid: %s"), *GifUrl);
                 
-    
+       
                 ImageBox->SetContent(
                     SNew(SBorder)
                     .BorderBackgroundColor(FLinearColor(1.0f, 0.0f, 0.0f, 1.0f))
@@ -1235,6 +1114,7 @@ TSharedRef<SWidget> SModelAssetsWidget::LoadImageFromUrl(const FString& GifUrl)
                 );
             }
         }));
+        ThumbnailVisibility.Track(ImageBox.ToSharedRef(), ThumbnailRequest);
 
     }
     else
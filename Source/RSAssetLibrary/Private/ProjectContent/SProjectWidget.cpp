@@ -22,6 +22,12 @@
 #include "ProjectContent/ProjectList/SProjectlistWidget.h"
 #include "Widgets/Layout/SScrollBox.h"
 #include "ProjectContent/AssetDownloader/SAssetDownloadWidget.h"
+#include "Downloader/AssetDownloadSubsystem.h"
+#include "Downloader/AssetBandwidthLimiter.h"
+#include "Downloader/AssetDownloadBatch.h"
+#include "ProjectContent/AssetImport/FAssetImportPipeline.h"
+#include "Framework/MultiBox/MultiBoxBuilder.h"
+#include "Widgets/Input/SSpinBox.h"
 #include "TimerManager.h"
 #include "ConceptDesignLibrary/GetConceptDesignLibMenuApi.h"
 #include "ProjectContent/AudioAssets/SAudioTagWidget.h"
@@ -29,6 +35,7 @@
 #include "ProjectContent/Imageload/FImageLoader.h"
 #include "ProjectContent/ModelAssets/SModelTagWidget.h"
 #include "ProjectList/FindProjectListApi.h"
+#include "GenericPlatform/GenericPlatformHttp.h"
 
 
 #define LOCTEXT_NAMESPACE "ProjectWidget"
@@ -52,6 +59,18 @@ void SProjectWidget::Construct(const FArguments& InArgs)
 	ProjectListAnimationSequence = FCurveSequence();
 	ProjectListAnimationCurve = ProjectListAnimationSequence.AddCurve(0.f, 0.3f, ECurveEaseFunction::QuadOut);
 
+	// Downloads outlive this widget, rows are rebuilt for jobs that are still running 下载任务不依赖此控件，为仍在进行的任务重建行
+	if (UAssetDownloadSubsystem* DownloadSubsystem = UAssetDownloadSubsystem::Get())
+	{
+		DownloadSubsystem->OnJobAdded.AddSP(this, &SProjectWidget::AddDownloadJobRow);
+		DownloadSubsystem->OnJobStateChanged.AddSP(this, &SProjectWidget::HandleDownloadJobStateChanged);
+		DownloadSubsystem->OnJobsProgress.AddSP(this, &SProjectWidget::HandleDownloadJobsProgress);
+		for (UAssetDownloadJob* Job : DownloadSubsystem->GetJobs())
+		{
+			AddDownloadJobRow(Job);
+		}
+	}
+
 	ChildSlot
 	[
 		SNew(SBox)
@@ -557,17 +576,17 @@ void SProjectWidget::LoadAndDisplayUserAvatar()
 		return;
 	}
 
-	// Defines the callback delegate after the image is loaded 定义加载图片后的回调委托
-	FOnProjectImageReady OnImageReadyDelegate = FOnProjectImageReady::CreateLambda([this](const TArray<uint8>& ImageData)
+	// Defines the callback delegate after the texture is created 定义纹理创建后的回调委托
+	FOnImageTextureReady OnTextureReadyDelegate = FOnImageTextureReady::CreateLambda([this](UTexture2D* Texture)
 	{
-		UTexture2D* UserAvatarTexture = FImageLoader::CreateTextureFromBytes(ImageData);
-		UserAvatarTexture->AddToRoot();
-
-		if (UserAvatarTexture)
+		if (Texture)
 		{
+			// The texture belongs to the image cache, the widget keeps it alive while it shows it 纹理归图像缓存所有，控件显示期间保持引用
+			UserAvatarTexture.Reset(Texture);
+
 			UserAvatarBrush = MakeShared<FSlateBrush>();
-			UserAvatarBrush->SetResourceObject(UserAvatarTexture);
-			UserAvatarBrush->ImageSize = FVector2D(UserAvatarTexture->GetSizeX(), UserAvatarTexture->GetSizeY());
+			UserAvatarBrush->SetResourceObject(Texture);
+			UserAvatarBrush->ImageSize = FVector2D(Texture->GetSizeX(), Texture->GetSizeY());
 			
 			if (UserAvatarImageWidget.IsValid())
 			{
@@ -576,7 +595,7 @@ void SProjectWidget::LoadAndDisplayUserAvatar()
 		}
 	});
 	
-	FImageLoader::LoadImageFromUrl(UserAvatarUrl, OnImageReadyDelegate);
+	FImageLoader::LoadTextureFromUrl(UserAvatarUrl, FIntPoint::ZeroValue, OnTextureReadyDelegate);
 }
 
 bool SProjectWidget::CheckProjectIsSelected()
@@ -1053,58 +1072,64 @@ void SProjectWidget::GenerateVideoAssetTree(int32 CurrentFileId, TSharedPtr<SVer
                     .AutoHeight()
                     .Padding(20, 0, 0, 0)
                     [
-                        SNew(SButton)
-                        .Cursor(EMouseCursor::Hand)
-                        .ButtonStyle(FolderButtonStyle.Get())
-                        .HAlign(HAlign_Left) 
-                        .OnClicked_Lambda([this, VideoFileItem, ChildBox, FolderButtonStyle, MaxLength]() -> FReply
-                        {
-                        	FImageLoader::CancelAllImageRequests();
-                        	ClearAllCachedTextures();
-                        	// ResetSlateWidgets();
-                        	ResetToggleTagContainer();
-                            if (SelectedButtonStyle.IsValid())
+                        SNew(SBorder)
+                        .Padding(0)
+                        .BorderImage(FCoreStyle::Get().GetBrush("NoBrush"))
+                        .OnMouseButtonUp(this, &SProjectWidget::OnFolderMouseButtonUp, FSimpleDelegate::CreateSP(this, &SProjectWidget::DownloadVideoFolder, VideoFileItem.fileNo, VideoFileItem.fileName), FSimpleDelegate::CreateSP(this, &SProjectWidget::DownloadAndImportVideoFolder, VideoFileItem.fileNo, VideoFileItem.fileName))
+                        [
+                            SNew(SButton)
+                            .Cursor(EMouseCursor::Hand)
+                            .ButtonStyle(FolderButtonStyle.Get())
+                            .HAlign(HAlign_Left) 
+                            .OnClicked_Lambda([this, VideoFileItem, ChildBox, FolderButtonStyle, MaxLength]() -> FReply
                             {
-                                ResetSelectedTag();
-                            }
-
-                            FolderButtonStyle->SetNormal(*FRSAssetLibraryStyle::Get().GetBrush("RSAssetLibrary.IconTab.AssetSelected"));
-                            FolderButtonStyle->SetHovered(*FRSAssetLibraryStyle::Get().GetBrush("RSAssetLibrary.IconTab.AssetSelected"));
+                            	FImageLoader::CancelAllImageRequests();
+                            	ClearAllCachedTextures();
+                            	// ResetSlateWidgets();
+                            	ResetToggleTagContainer();
+                                if (SelectedButtonStyle.IsValid())
+                                {
+                                    ResetSelectedTag();
+                                }
+
+                                FolderButtonStyle->SetNormal(*FRSAssetLibraryStyle::Get().GetBrush("RSAssetLibrary.IconTab.AssetSelected"));
+                                FolderButtonStyle->SetHovered(*FRSAssetLibraryStyle::Get().GetBrush("RSAssetLibrary.IconTab.AssetSelected"));
                         	
-                            SelectedButtonStyle = FolderButtonStyle;
-                            TagClick = ETagClick::VideoTag;
+                                SelectedButtonStyle = FolderButtonStyle;
+                                TagClick = ETagClick::VideoTag;
 
-                        	int32 NewMaxLength = FMath::Max(MaxLength - 4, 6);
+                            	int32 NewMaxLength = FMath::Max(MaxLength - 4, 6);
 
-                            // Recursive calls generate sublevels 递归调用生成子层级
-                            GenerateVideoAssetTree(VideoFileItem.id, ChildBox, VideoFileItem.fileNo, NewMaxLength);
+                                // Recursive calls generate sublevels 递归调用生成子层级
+                                GenerateVideoAssetTree(VideoFileItem.id, ChildBox, VideoFileItem.fileNo, NewMaxLength);
 
-                            return FReply::Handled();
-                        })
-                        [
-                            SNew(SBox)
-                            .HeightOverride(40)
-                            .WidthOverride(200)
-                            .Padding(FMargin(36, 0, 0, 0)) 
+                                return FReply::Handled();
+                            })
                             [
-                                SNew(SHorizontalBox)
-                                
-                                + SHorizontalBox::Slot()
-                                .AutoWidth()
-                                .VAlign(VAlign_Center)
-                                .Padding(FMargin(5, 0, 10, 0))
+                                SNew(SBox)
+                                .HeightOverride(40)
+                                .WidthOverride(200)
+                                .Padding(FMargin(36, 0, 0, 0)) 
                                 [
-                                    SNew(SImage)
-                                    .Image(FRSAssetLibraryStyle::Get().GetBrush("PluginIcon.SmallFolder.Icon"))
-                                ]
+                                    SNew(SHorizontalBox)
                                 
-                                + SHorizontalBox::Slot()
-                                .AutoWidth()
-                                .VAlign(EVerticalAlignment::VAlign_Center)
-                                .HAlign(HAlign_Center)
-                                [
-                                    SNew(STextBlock)
-                                    .Text(FText::FromString(TruncateText(VideoFileItem.fileName, MaxLength)))
+                                    + SHorizontalBox::Slot()
+                                    .AutoWidth()
+                                    .VAlign(VAlign_Center)
+                                    .Padding(FMargin(5, 0, 10, 0))
+                                    [
+                                        SNew(SImage)
+                                        .Image(FRSAssetLibraryStyle::Get().GetBrush("PluginIcon.SmallFolder.Icon"))
+                                    ]
+                                
+                                    + SHorizontalBox::Slot()
+                                    .AutoWidth()
+                                    .VAlign(EVerticalAlignment::VAlign_Center)
+                                    .HAlign(HAlign_Center)
+                                    [
+                                        SNew(STextBlock)
+                                        .Text(FText::FromString(TruncateText(VideoFileItem.fileName, MaxLength)))
+                                    ]
                                 ]
                             ]
                         ]
@@ -1268,59 +1293,65 @@ void SProjectWidget::GenerateModelAssetTree(int32 CurrentFileId, TSharedPtr<SVer
                     .AutoHeight()
                     .Padding(20, 0, 0, 0)
                     [
-                        SNew(SButton)
-                        .Cursor(EMouseCursor::Hand)
-                        .ButtonStyle(FolderButtonStyle.Get())
-                        .HAlign(HAlign_Left) 
-                        .OnClicked_Lambda([this, FileItem, ChildBox, FolderButtonStyle, MaxLength]() -> FReply
-                        {
-                        	FImageLoader::CancelAllImageRequests();
-                        	ClearAllCachedTextures();
-                        	ResetToggleTagContainer();
-                        	CurrentActiveWidget = EActiveWidget::ModelAssets;
-                            if (SelectedButtonStyle.IsValid())
+                        SNew(SBorder)
+                        .Padding(0)
+                        .BorderImage(FCoreStyle::Get().GetBrush("NoBrush"))
+                        .OnMouseButtonUp(this, &SProjectWidget::OnFolderMouseButtonUp, FSimpleDelegate::CreateSP(this, &SProjectWidget::DownloadModelFolder, FileItem.id, FileItem.fileName), FSimpleDelegate::CreateSP(this, &SProjectWidget::DownloadAndImportModelFolder, FileItem.id, FileItem.fileName))
+                        [
+                            SNew(SButton)
+                            .Cursor(EMouseCursor::Hand)
+                            .ButtonStyle(FolderButtonStyle.Get())
+                            .HAlign(HAlign_Left) 
+                            .OnClicked_Lambda([this, FileItem, ChildBox, FolderButtonStyle, MaxLength]() -> FReply
                             {
-                                ResetSelectedTag();
-                            }
-
-                            FolderButtonStyle->SetNormal(*FRSAssetLibraryStyle::Get().GetBrush("RSAssetLibrary.IconTab.AssetSelected"));
-                            FolderButtonStyle->SetHovered(*FRSAssetLibraryStyle::Get().GetBrush("RSAssetLibrary.IconTab.AssetSelected"));
+                            	FImageLoader::CancelAllImageRequests();
+                            	ClearAllCachedTextures();
+                            	ResetToggleTagContainer();
+                            	CurrentActiveWidget = EActiveWidget::ModelAssets;
+                                if (SelectedButtonStyle.IsValid())
+                                {
+                                    ResetSelectedTag();
+                                }
+
+                                FolderButtonStyle->SetNormal(*FRSAssetLibraryStyle::Get().GetBrush("RSAssetLibrary.IconTab.AssetSelected"));
+                                FolderButtonStyle->SetHovered(*FRSAssetLibraryStyle::Get().GetBrush("RSAssetLibrary.IconTab.AssetSelected"));
                         	
-                            SelectedButtonStyle = FolderButtonStyle;
-                            TagClick = ETagClick::ModelTag;
+                                SelectedButtonStyle = FolderButtonStyle;
+                                TagClick = ETagClick::ModelTag;
 
-                        	int32 NewMaxLength = FMath::Max(MaxLength - 4, 6);
+                            	int32 NewMaxLength = FMath::Max(MaxLength - 4, 6);
                         	
-                            GenerateModelAssetTree(FileItem.id, ChildBox, NewMaxLength);
+                                GenerateModelAssetTree(FileItem.id, ChildBox, NewMaxLength);
 
-                            GEditor->GetEditorSubsystem<UUSMSubsystem>()->SetCurrentModelRootID(FileItem.id);
-                            return FReply::Handled();
-                        })
-                        [
-                            SNew(SBox)
-                            .HeightOverride(40)
-                            .WidthOverride(200)
-                            .Padding(FMargin(36, 0, 0, 0)) 
+                                GEditor->GetEditorSubsystem<UUSMSubsystem>()->SetCurrentModelRootID(FileItem.id);
+                                return FReply::Handled();
+                            })
                             [
-                                SNew(SHorizontalBox)
-                                
-                                + SHorizontalBox::Slot()
-                                .AutoWidth()
-                                .VAlign(VAlign_Center)
-                                .Padding(FMargin(5, 0, 10, 0)) 
+                                SNew(SBox)
+                                .HeightOverride(40)
+                                .WidthOverride(200)
+                                .Padding(FMargin(36, 0, 0, 0)) 
                                 [
-                                    SNew(SImage)
-                                    .Image(FRSAssetLibraryStyle::Get().GetBrush("PluginIcon.SmallFolder.Icon")) 
-                                ]
+                                    SNew(SHorizontalBox)
                                 
-                                + SHorizontalBox::Slot()
-                                .AutoWidth()
-                                .VAlign(EVerticalAlignment::VAlign_Center)
-                                .HAlign(HAlign_Center)
-                                .Padding(0, 1, 0, 0) 
-                                [
-                                    SNew(STextBlock)
-                                    .Text(FText::FromString(TruncateText(FileItem.fileName, MaxLength)))
+                                    + SHorizontalBox::Slot()
+                                    .AutoWidth()
+                                    .VAlign(VAlign_Center)
+                                    .Padding(FMargin(5, 0, 10, 0)) 
+                                    [
+                                        SNew(SImage)
+                                        .Image(FRSAssetLibraryStyle::Get().GetBrush("PluginIcon.SmallFolder.Icon")) 
+                                    ]
+                                
+                                    + SHorizontalBox::Slot()
+                                    .AutoWidth()
+                                    .VAlign(EVerticalAlignment::VAlign_Center)
+                                    .HAlign(HAlign_Center)
+                                    .Padding(0, 1, 0, 0) 
+                                    [
+                                        SNew(STextBlock)
+                                        .Text(FText::FromString(TruncateText(FileItem.fileName, MaxLength)))
+                                    ]
                                 ]
                             ]
                         ]
@@ -1835,6 +1866,141 @@ void SProjectWidget::HandleVideoAssetDownloadClicked(const FString& InName, cons
 	AddToDownloadQueue(InName, InURL, InMD5);
 }
 
+FReply SProjectWidget::OnFolderMouseButtonUp(const FGeometry& Geometry, const FPointerEvent& MouseEvent, FSimpleDelegate OnDownloadFolder, FSimpleDelegate OnDownloadAndImportFolder)
+{
+	if (MouseEvent.GetEffectingButton() != EKeys::RightMouseButton)
+	{
+		return FReply::Unhandled();
+	}
+
+	FMenuBuilder MenuBuilder(true, nullptr);
+	MenuBuilder.AddMenuEntry(
+		LOCTEXT("DownloadFolder", "Download Folder"),
+		LOCTEXT("DownloadFolderTooltip", "Download every file in this folder and its sub folders"),
+		FSlateIcon(),
+		FUIAction(FExecuteAction::CreateLambda([OnDownloadFolder]()
+		{
+			OnDownloadFolder.ExecuteIfBound();
+		})));
+	MenuBuilder.AddMenuEntry(
+		LOCTEXT("DownloadAndImportFolder", "Download and Import Folder"),
+		LOCTEXT("DownloadAndImportFolderTooltip", "Download every file in this folder and its sub folders and import each one as soon as it is downloaded"),
+		FSlateIcon(),
+		FUIAction(FExecuteAction::CreateLambda([OnDownloadAndImportFolder]()
+		{
+			OnDownloadAndImportFolder.ExecuteIfBound();
+		})));
+
+	const FWidgetPath WidgetPath = MouseEvent.GetEventPath() != nullptr ? *MouseEvent.GetEventPath() : FWidgetPath();
+	FSlateApplication::Get().PushMenu(AsShared(), WidgetPath, MenuBuilder.MakeWidget(), MouseEvent.GetScreenSpacePosition(), FPopupTransitionEffect(FPopupTransitionEffect::ContextMenu));
+	return FReply::Handled();
+}
+
+void SProjectWidget::DownloadModelFolder(int32 FolderId, FString FolderName)
+{
+	if (UAssetDownloadSubsystem* DownloadSubsystem = UAssetDownloadSubsystem::Get())
+	{
+		SetUserAndProjectParams();
+		DownloadSubsystem->EnqueueModelFolder(Ticket, Uuid, ProjectNo, FolderId, FolderName);
+	}
+}
+
+void SProjectWidget::DownloadVideoFolder(FString FolderNo, FString FolderName)
+{
+	if (UAssetDownloadSubsystem* DownloadSubsystem = UAssetDownloadSubsystem::Get())
+	{
+		SetUserAndProjectParams();
+		DownloadSubsystem->EnqueueVideoFolder(Ticket, ProjectNo, FolderNo, FolderName);
+	}
+}
+
+void SProjectWidget::DownloadAndImportModelFolder(int32 FolderId, FString FolderName)
+{
+	SetUserAndProjectParams();
+	FAssetImportPipeline::Get().DownloadAndImportModelFolder(Ticket, Uuid, ProjectNo, FolderId, FolderName);
+}
+
+void SProjectWidget::DownloadAndImportVideoFolder(FString FolderNo, FString FolderName)
+{
+	SetUserAndProjectParams();
+	FAssetImportPipeline::Get().DownloadAndImportVideoFolder(Ticket, ProjectNo, FolderNo, FolderName);
+}
+
+void SProjectWidget::HandleDownloadJobsProgress(const TArray<UAssetDownloadJob*>& Jobs)
+{
+	RefreshDownloadSummaryTexts();
+}
+
+void SProjectWidget::HandleDownloadJobStateChanged(UAssetDownloadJob* Job, EAssetDownloadState PreviousState)
+{
+	RefreshDownloadSummaryTexts();
+}
+
+// The bottom bar only changes with subsystem events, so its texts are built there instead of every paint 底栏仅随子系统事件变化，因此在事件中生成文本而不是每帧生成
+void SProjectWidget::RefreshDownloadSummaryTexts()
+{
+	BatchProgressText = BuildBatchProgressText();
+	DownloadStatsText = BuildDownloadStatsText();
+}
+
+FText SProjectWidget::BuildBatchProgressText() const
+{
+	const UAssetDownloadSubsystem* DownloadSubsystem = UAssetDownloadSubsystem::Get();
+	if (!DownloadSubsystem || DownloadSubsystem->GetBatches().Num() == 0)
+	{
+		return FText::GetEmpty();
+	}
+
+	// Summed over all folder batches of the current run 当前所有文件夹批次的汇总进度
+	const FAssetDownloadBatchProgress Progress = DownloadSubsystem->GetBatchProgress();
+	const FText FilesText = Progress.bIsListing
+		? FText::Format(LOCTEXT("BatchFilesListing", "{0}/{1}+ files"), FText::AsNumber(Progress.NumCompletedFiles), FText::AsNumber(Progress.NumFiles))
+		: FText::Format(LOCTEXT("BatchFiles", "{0}/{1} files"), FText::AsNumber(Progress.NumCompletedFiles), FText::AsNumber(Progress.NumFiles));
+
+	FText Result = FText::Format(LOCTEXT("BatchProgress", "Folders: {0}, {1} / {2}"), FilesText, FText::AsMemory(Progress.DownloadedBytes), FText::AsMemory(Progress.TotalBytes));
+	if (Progress.NumFailedFiles > 0)
+	{
+		Result = FText::Format(LOCTEXT("BatchProgressFailed", "{0}, {1} failed"), Result, FText::AsNumber(Progress.NumFailedFiles));
+	}
+	return Result;
+}
+
+FText SProjectWidget::BuildDownloadStatsText() const
+{
+	UAssetDownloadSubsystem* DownloadSubsystem = UAssetDownloadSubsystem::Get();
+	if (!DownloadSubsystem || DownloadSubsystem->GetNumDownloadingJobs() == 0)
+	{
+		return FText::GetEmpty();
+	}
+
+	const FAssetDownloadStats Stats = DownloadSubsystem->GetAggregateStats();
+	const double EtaSeconds = Stats.GetEtaSeconds(DownloadSubsystem->GetRemainingBytes());
+	const FText EtaText = EtaSeconds >= 0.0
+		? FText::AsTimespan(FTimespan::FromSeconds(FMath::CeilToDouble(EtaSeconds)))
+		: LOCTEXT("EtaUnknown", "--");
+
+	return FText::Format(LOCTEXT("DownloadStats", "{0}/s, {1} left, {2} retries"),
+		FText::AsMemory((uint64)Stats.SmoothedBytesPerSecond), EtaText, FText::AsNumber(Stats.NumRetries));
+}
+
+FText SProjectWidget::GetDownloadStatsToolTipText() const
+{
+	UAssetDownloadSubsystem* DownloadSubsystem = UAssetDownloadSubsystem::Get();
+	if (!DownloadSubsystem)
+	{
+		return FText::GetEmpty();
+	}
+
+	// Latencies over every job of the session 本次会话所有任务的延迟统计
+	const FAssetDownloadStats Stats = DownloadSubsystem->GetAggregateStats();
+	auto Milliseconds = [](double Seconds) { return FText::AsNumber(FMath::RoundToInt(Seconds * 1000.0)); };
+	return FText::Format(LOCTEXT("DownloadStatsTooltip", "Current: {0}/s\nTime to first byte: {1} ms p50, {2} ms p95\nRange latency: {3} ms p50, {4} ms p95, {5} ranges\nRun RSAsset.DumpDownloadStats to export a CSV."),
+		FText::AsMemory((uint64)Stats.InstantBytesPerSecond),
+		Milliseconds(Stats.TimeToFirstByte.GetPercentile(0.5)), Milliseconds(Stats.TimeToFirstByte.GetPercentile(0.95)),
+		Milliseconds(Stats.RangeLatency.GetPercentile(0.5)), Milliseconds(Stats.RangeLatency.GetPercentile(0.95)),
+		FText::AsNumber(Stats.RangeLatency.NumSamples));
+}
+
 
 void SProjectWidget::UpdateModelAssetsWidget(const TArray<FModelFileItem>& ModelAssetsData)
 {
@@ -2833,51 +2999,44 @@ void SProjectWidget::UpdateScrollBoxContent(const TSharedRef<SWidget>& NewConten
 // Add a download queue item 添加下载队列项
 void SProjectWidget::AddToDownloadQueue(const FString& SelectedFileName, const FString& SelectedURL, const FString& SelectedMD5)
 {
-	// Check the number of tasks in the current queue 检查当前队列中的任务数量
-	int32 CurrentQueueSize = DownloadQueueContainer.IsValid() ? DownloadQueueContainer->GetChildren()->Num() : 0;
-
-	if (CurrentQueueSize >= MaxDownloadQueueSize)
+	UAssetDownloadSubsystem* DownloadSubsystem = UAssetDownloadSubsystem::Get();
+	if (!DownloadSubsystem)
 	{
-		// If the queue is full, a dialog box is displayed 如果队列已满，弹出提示框
-		FMessageDialog::Open(EAppMsgType::Ok, FText::FromString(TEXT("下载队列已达到最大限度，无法添加更多任务！")));
 		return;
 	}
-	
+
+	// The row is added by AddDownloadJobRow when the subsystem reports the new job 子系统通知新任务时由 AddDownloadJobRow 添加行
+	DownloadSubsystem->EnqueueDownload(SelectedURL, SelectedFileName, SelectedMD5);
+}
+
+// Add a row that follows a download job 添加跟随下载任务的行
+void SProjectWidget::AddDownloadJobRow(UAssetDownloadJob* Job)
+{
     if (!DownloadQueueContainer.IsValid())
     {
         DownloadQueueContainer = SNew(SVerticalBox);
     }
 
-    if (DownloadQueueContainer.IsValid())
+    if (!DownloadCompleteWidget.IsValid())
     {
-    	ShowDownloadingQueue();
-    	
-        TSharedPtr<SAssetDownloadWidget> LocalAssetDownloadWidget;
+        DownloadCompleteWidget = SNew(SDownloadCompleteWidget)
+            .OnResumeDownload(this, &SProjectWidget::HandleResumeInterruptedDownload);
+    }
 
-        DownloadQueueContainer->AddSlot()
-        .AutoHeight()
-        .Padding(5)
-        [
-            SAssignNew(LocalAssetDownloadWidget, SAssetDownloadWidget)
-            .URL(SelectedURL)
-            .FileName(SelectedFileName)
-            .MD5(SelectedMD5)
-            .ParentContainer(DownloadQueueContainer)
-            .DownloadCompleteWidget(DownloadCompleteWidget)  // Pass the DownloadCompleteWidget to the download item 将 DownloadCompleteWidget 传递给下载项
-        ];
+	ShowDownloadingQueue();
+	RefreshDownloadSummaryTexts();
 
-        if (LocalAssetDownloadWidget.IsValid())
-        {
-            LocalAssetDownloadWidget->SetDownloadParameters(SelectedURL, SelectedFileName, SelectedMD5);
-            LocalAssetDownloadWidget->OnStartOrResumeClicked();
-        }
-        else
-        {
-            // UE_LOG(LogTemp, Error, TEXT("Failed to create SAssetDownloadWidget in AddToDownloadQueue."));
-        }
+    DownloadQueueContainer->AddSlot()
+    .AutoHeight()
+    .Padding(5)
+    [
+        SNew(SAssetDownloadWidget)
+        .Job(Job)
+        .ParentContainer(DownloadQueueContainer)
+        .DownloadCompleteWidget(DownloadCompleteWidget)  // Pass the DownloadCompleteWidget to the download item 将 DownloadCompleteWidget 传递给下载项
+    ];
 
-    	UpdateScrollBoxContent(DownloadQueueContainer.ToSharedRef());
-    }
+	UpdateScrollBoxContent(DownloadQueueContainer.ToSharedRef());
 }
 
 
@@ -2891,7 +3050,8 @@ void SProjectWidget::ShowDownloadQueue()
 	
     if (!DownloadCompleteWidget.IsValid())
     {
-        DownloadCompleteWidget = SNew(SDownloadCompleteWidget);
+        DownloadCompleteWidget = SNew(SDownloadCompleteWidget)
+            .OnResumeDownload(this, &SProjectWidget::HandleResumeInterruptedDownload);
     }
 
     // Will DownloadCompleteWidget CompletedDownloadContainer assignment 将 DownloadCompleteWidget 赋值给 CompletedDownloadContainer
@@ -3067,9 +3227,65 @@ void SProjectWidget::ShowDownloadQueue()
 						.BorderImage(FRSAssetLibraryStyle::Get().GetBrush("RSAssetLibrary.DownloadBottom"))
 						[
 							SNew(SHorizontalBox)
+							// Global bandwidth cap, applied to running downloads at once 全局限速，立即作用于正在进行的下载
+							+ SHorizontalBox::Slot()
+							.AutoWidth()
+							.VAlign(VAlign_Center)
+							.Padding(20, 5, 5, 5)
+							[
+								SNew(STextBlock)
+								.Text(LOCTEXT("SpeedLimitText", "Speed Limit (MB/s)"))
+								.Font(FCoreStyle::GetDefaultFontStyle("Regular", 10))
+								.ColorAndOpacity(FSlateColor(FLinearColor::White))
+							]
+							+ SHorizontalBox::Slot()
+							.AutoWidth()
+							.VAlign(VAlign_Center)
+							.Padding(0, 5, 5, 5)
+							[
+								SNew(SBox)
+								.WidthOverride(80.0f)
+								[
+									SNew(SSpinBox<float>)
+									.MinValue(0.0f)
+									.MaxSliderValue(100.0f)
+									.Delta(0.5f)
+									.ToolTipText(LOCTEXT("SpeedLimitTooltip", "Total download bandwidth, 0 = unlimited"))
+									.Value_Lambda([]()
+									{
+										return FAssetBandwidthLimiter::Get().GetBandwidthLimit() / (1024.0f * 1024.0f);
+									})
+									.OnValueCommitted_Lambda([](float NewValue, ETextCommit::Type CommitType)
+									{
+										FAssetBandwidthLimiter::Get().SetBandwidthLimit((int64)(NewValue * 1024.0f * 1024.0f));
+									})
+								]
+							]
+							// Aggregated progress of folder downloads and queue throughput 文件夹下载的汇总进度和队列吞吐量
 							+ SHorizontalBox::Slot()
-							.HAlign(HAlign_Right)
 							.FillWidth(1)
+							.VAlign(VAlign_Center)
+							.Padding(10, 5, 5, 5)
+							[
+								SNew(SVerticalBox)
+								+ SVerticalBox::Slot()
+								.AutoHeight()
+								[
+									SNew(STextBlock)
+									.Text_Lambda([this]() { return BatchProgressText; })
+									.Font(FCoreStyle::GetDefaultFontStyle("Regular", 10))
+									.ColorAndOpacity(FSlateColor(FLinearColor::White))
+								]
+								+ SVerticalBox::Slot()
+								.AutoHeight()
+								[
+									SNew(STextBlock)
+									.Text_Lambda([this]() { return DownloadStatsText; })
+									.ToolTipText(this, &SProjectWidget::GetDownloadStatsToolTipText)
+									.Font(FCoreStyle::GetDefaultFontStyle("Regular", 9))
+									.ColorAndOpacity(FSlateColor(FLinearColor(0.7f, 0.7f, 0.7f, 1.0f)))
+								]
+							]
 							
 							+ SHorizontalBox::Slot()
 							.HAlign(HAlign_Right)
@@ -3283,6 +3499,21 @@ void SProjectWidget::OnDownloadComplete(const FString& InFileName, const FString
 }
 
 
+// Put a download interrupted in an earlier session back into the queue 将上次会话中断的下载重新加入队列
+void SProjectWidget::HandleResumeInterruptedDownload(const FString& InFileName, const FString& InURL, const FString& InMD5)
+{
+	// The journal keeps the encoded URL, the queue expects the original one 日志保存的是编码后的 URL，队列需要原始 URL
+	FString OriginalURL = InURL;
+	int32 LastSlashIndex;
+	if (InURL.FindLastChar('/', LastSlashIndex))
+	{
+		OriginalURL = InURL.Left(LastSlashIndex + 1) + FGenericPlatformHttp::UrlDecode(InURL.Mid(LastSlashIndex + 1));
+	}
+
+	AddToDownloadQueue(InFileName, OriginalURL, InMD5);
+}
+
+
 // Close the download queue window 关闭下载队列窗口
 void SProjectWidget::OnDownloadQueueWindowClosed(const TSharedRef<SWindow>& ClosedWindow)
 {
@@ -3292,154 +3523,29 @@ void SProjectWidget::OnDownloadQueueWindowClosed(const TSharedRef<SWindow>& Clos
 
 /*+++++++++++++++++++++++++Multitask download related  多任务下载相关+++++++++++++++++++++++++*/
 
-void SProjectWidget::CleanInvalidPausedTasks()
-{
-	FScopeLock PausedTasksLock(&SAssetDownloadWidget::PausedTasksMutex);
-
-	// Use a local array to store the index to be deleted 使用局部数组存储要删除的索引
-	TArray<int32> ToRemoveIndices;
-
-	// Iterate over the suspended task to check whether each weak reference is valid 遍历已暂停任务，检查每个弱引用是否有效
-	for (int32 i = SAssetDownloadWidget::PausedTasks.Num() - 1; i >= 0; --i)
-	{
-		TWeakPtr<SAssetDownloadWidget> DownloadWidgetWeakPtr = SAssetDownloadWidget::PausedTasks[i];
-		if (DownloadWidgetWeakPtr.Pin() == nullptr)  // Use Pin() to check if the weak reference is valid 使用 Pin() 检查弱引用是否有效
-			{
-			ToRemoveIndices.Add(i);  // Adds an invalid index to the removal list 将无效的索引添加到移除列表
-			}
-	}
-
-	// Perform the removal of invalid elements 执行移除无效元素
-	for (int32 Index : ToRemoveIndices)
-	{
-		SAssetDownloadWidget::PausedTasks.RemoveAt(Index);
-	}
-}
-
-
 void SProjectWidget::StartAllDownloads()
 {
+	if (UAssetDownloadSubsystem* DownloadSubsystem = UAssetDownloadSubsystem::Get())
 	{
-		FScopeLock PendingTasksLock(&SAssetDownloadWidget::PendingTasksMutex);
-
-		TSharedPtr<SAssetDownloadWidget> PendingWidget;
-		while (SAssetDownloadWidget::PendingTasks.Dequeue(PendingWidget))
-		{
-			if (PendingWidget.IsValid())
-			{
-				PendingWidget->OnStartOrResumeClicked();
-			}
-		}
-	}
-	
-	{
-		FScopeLock PausedTasksLock(&SAssetDownloadWidget::PausedTasksMutex);
-		
-		TArray<int32> ToRemoveIndices;
-
-		for (int32 i = SAssetDownloadWidget::PausedTasks.Num() - 1; i >= 0; --i)
-		{
-			TWeakPtr<SAssetDownloadWidget> DownloadWidgetWeakPtr = SAssetDownloadWidget::PausedTasks[i];
-			if (auto DownloadWidget = DownloadWidgetWeakPtr.Pin())
-			{
-				DownloadWidget->OnStartOrResumeClicked();
-				ToRemoveIndices.Add(i);
-			}
-			else
-			{
-				ToRemoveIndices.Add(i);  // An invalid index was recorded 记录无效的索引
-			}
-		}
-
-		// Removes invalid or started tasks from PausedTasks 从 PausedTasks 中删除无效或已启动的任务
-		for (int32 Index : ToRemoveIndices)
-		{
-			SAssetDownloadWidget::PausedTasks.RemoveAt(Index);
-		}
+		DownloadSubsystem->ResumeAll();
 	}
 }
 
-// Improve PauseAllDownloads to ensure validity checks are performed before each visit 改进 PauseAllDownloads，确保每次访问前进行有效性检查
 void SProjectWidget::PauseAllDownloads()
 {
+	if (UAssetDownloadSubsystem* DownloadSubsystem = UAssetDownloadSubsystem::Get())
 	{
-		FScopeLock ActiveTasksLock(&SAssetDownloadWidget::ActiveTasksMutex);
-
-		TArray<TWeakPtr<SAssetDownloadWidget>> ToPauseTasks;
-
-		for (int32 i = SAssetDownloadWidget::ActiveTasks.Num() - 1; i >= 0; --i)
-		{
-			TWeakPtr<SAssetDownloadWidget> DownloadWidgetWeakPtr = SAssetDownloadWidget::ActiveTasks[i];
-			if (TSharedPtr<SAssetDownloadWidget> DownloadWidgetSharedPtr = DownloadWidgetWeakPtr.Pin())
-			{
-				DownloadWidgetSharedPtr->SetPausedAllDownloads(true);
-				DownloadWidgetSharedPtr->OnPauseClicked();
-
-				if (!SAssetDownloadWidget::PausedTasks.Contains(DownloadWidgetWeakPtr))
-				{
-					SAssetDownloadWidget::PausedTasks.Add(DownloadWidgetWeakPtr);
-				}
-			}
-		}
-
-		SAssetDownloadWidget::ActiveTasks.Empty();
+		DownloadSubsystem->PauseAll();
 	}
-
-	CleanInvalidPausedTasks(); 
 }
 
 
 void SProjectWidget::CancelAllDownloads()
 {
+	if (UAssetDownloadSubsystem* DownloadSubsystem = UAssetDownloadSubsystem::Get())
 	{
-		FScopeLock ActiveTasksLock(&SAssetDownloadWidget::ActiveTasksMutex);
-        
-		for (int32 i = SAssetDownloadWidget::ActiveTasks.Num() - 1; i >= 0; --i)
-		{
-			TWeakPtr<SAssetDownloadWidget> DownloadWidgetWeakPtr = SAssetDownloadWidget::ActiveTasks[i];
-			if (TSharedPtr<SAssetDownloadWidget> DownloadWidgetSharedPtr = DownloadWidgetWeakPtr.Pin())
-			{
-				DownloadWidgetSharedPtr->OnCancelClicked();
-			}
-		}
-
-		SAssetDownloadWidget::ActiveTasks.Empty();
-	}
-	{
-		FScopeLock PendingTasksLock(&SAssetDownloadWidget::PendingTasksMutex);
-        
-		TSharedPtr<SAssetDownloadWidget> PendingWidget;
-		while (SAssetDownloadWidget::PendingTasks.Dequeue(PendingWidget))
-		{
-			if (PendingWidget.IsValid())
-			{
-				PendingWidget->OnCancelClicked();
-			}
-		}
+		DownloadSubsystem->CancelAll();
 	}
-	{
-		FScopeLock Lock(&SAssetDownloadWidget::PendingTasksMutex);
-		for (auto& DownloadWidgetWeakPtr : SAssetDownloadWidget::PausedTasks)
-		{
-			if (auto DownloadWidget = DownloadWidgetWeakPtr.Pin())
-			{
-				DownloadWidget->OnCancelClicked();
-			}
-		}
-		SAssetDownloadWidget::PausedTasks.Empty();
-	}
-	{
-		FScopeLock Lock(&SAssetDownloadWidget::PendingTasksMutex);
-		for (auto& DownloadWidgetSharedPtr : SAssetDownloadWidget::FailedTasks) 
-			{
-			if (DownloadWidgetSharedPtr.IsValid())
-			{
-				DownloadWidgetSharedPtr->OnCancelClicked();
-			}
-			}
-		SAssetDownloadWidget::FailedTasks.Empty();
-	}
-
 }
 
 
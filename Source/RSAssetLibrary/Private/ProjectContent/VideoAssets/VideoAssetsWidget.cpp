@@ -1,12 +1,11 @@
 ﻿// Copyright (c) 2024 Hunan MangoXR Tech Co., Ltd. All Rights Reserved.
 
 #include "ProjectContent/VideoAssets/VideoAssetsWidget.h"
+#include "ProjectContent/AssetImport/FAssetImportPipeline.h"
 #include "RSAssetLibraryStyle.h"
 #include "ProjectContent/Imageload/FImageLoader.h"
 #include "VideoLibrary/GetVideoCommentListApi.h"
 #include "Widgets/Layout/SScrollBox.h"
-#include "FileMediaSource.h"
-#include "AssetRegistry/AssetRegistryModule.h"
 #include "GenericPlatform/GenericPlatformHttp.h"
 #include "ProjectContent/MediaPlayer/SVideoPlayerWidget.h"
 #include "VideoLibrary/GetVideoAssetLibraryListInfoApi.h"
@@ -48,6 +47,8 @@ void SVideoAssetsWidget::Construct(const FArguments& InArgs)
 	];
 
     InitializeDetailButtonStyle();
+
+    RegisterActiveTimer(FImageVisibilityTracker::UpdateInterval, FWidgetActiveTimerDelegate::CreateSP(this, &SVideoAssetsWidget::UpdateThumbnailVisibility));
 }
 
 
@@ -997,7 +998,14 @@ TSharedRef<SWidget> SVideoAssetsWidget::GenerateDetailsWidget(UGetVideoVersionFi
                              SNew(SButton)
                              .Cursor(EMouseCursor::Hand)
                              .ButtonStyle(&ImportButtonStyle) 
-                             .OnClicked(this, &SVideoAssetsWidget::OnImportVideoFileButtonClicked)
+                             .ToolTipText(LOCTEXT("ImportTooltip", "Import into the project, downloading the file first if needed"))
+                             .OnClicked_Lambda([this, VideoVersionFileDetail]()-> FReply
+                             {
+                                 SelectedVideoFileInfo.FileName = VideoVersionFileDetail->data.VideoFileName;
+                                 SelectedVideoFileInfo.FileUrl = VideoVersionFileDetail->data.VideoFilePath;
+                                 SelectedVideoFileInfo.FileMd5 = VideoVersionFileDetail->data.FileInfo.FileMd5;
+                                 return OnImportVideoFileButtonClicked();
+                             })
                              .ContentPadding(0) 
                              [
                                  SNew(SBox)
@@ -1136,67 +1144,24 @@ FReply SVideoAssetsWidget::OnImportVideoFileButtonClicked()
 
 void SVideoAssetsWidget::ImportVideoFile(const FString& FilePath)
 {
-    static TSharedPtr<SWindow> ExistingNotificationWindow;
     static TSharedPtr<SWindow> ExistingNotificationWindow2;
     
-    // Check if the file is still being downloaded 检查文件是否仍在下载中
+    // A file that is still downloading is imported once its download completed 仍在下载的文件在下载完成后导入
     if (AssetDownloadWidget.IsValid() && AssetDownloadWidget->IsFileDownloading(FilePath))
     {
-        if (ExistingNotificationWindow.IsValid() && FSlateApplication::Get().FindWidgetWindow(ExistingNotificationWindow.ToSharedRef()))
-        {
-            ExistingNotificationWindow->BringToFront();
-            return;
-        }
-
-        // An error message is displayed indicating that the file is still being downloaded 显示错误消息，提示文件仍在下载中
-        ExistingNotificationWindow = SNew(SWindow)
-            .Title(LOCTEXT("TipTitle", "Notification"))
-            .ClientSize(FVector2D(200, 100))
-            .FocusWhenFirstShown(true)
-            .SupportsMaximize(false)
-            .SupportsMinimize(false)
-            .IsTopmostWindow(false)
-            .Content()
-            [
-                SNew(SVerticalBox)
-                + SVerticalBox::Slot()
-                .AutoHeight()
-                .Padding(10)
-                .HAlign(HAlign_Center)
-                [
-                    SNew(STextBlock)
-                    .Text(LOCTEXT("ResourceDownloading", "Resource is downloading!"))
-                    .Justification(ETextJustify::Center)
-                ]
-                + SVerticalBox::Slot()
-                .AutoHeight()
-                .Padding(10, 20, 10, 10)
-                .HAlign(HAlign_Center)
-                [
-                    SNew(SButton)
-                    .Text(LOCTEXT("Confirm", "OK"))
-                    .OnClicked_Lambda([]() -> FReply {
-                        if (ExistingNotificationWindow.IsValid())
-                        {
-                            FSlateApplication::Get().RequestDestroyWindow(ExistingNotificationWindow.ToSharedRef());
-                            ExistingNotificationWindow.Reset();
-                        }
-                        return FReply::Handled();
-                    })
-                ]
-            ];
-
-        ExistingNotificationWindow->SetOnWindowClosed(FOnWindowClosed::CreateLambda([this](const TSharedRef<SWindow>&)
-        {
-              ExistingNotificationWindow.Reset(); 
-        }));
-        
-        FSlateApplication::Get().AddWindow(ExistingNotificationWindow.ToSharedRef());
+        FAssetImportPipeline::Get().ImportWhenDownloaded(FPaths::GetCleanFilename(FilePath), EAssetImportKind::Video);
         return;
     }
     
     if (!FPaths::FileExists(FilePath))
     {
+        // A file that was never downloaded is downloaded first and imported afterwards 未下载的文件先下载再导入
+        if (!SelectedVideoFileInfo.FileUrl.IsEmpty() && SelectedVideoFileInfo.FileName == FPaths::GetCleanFilename(FilePath))
+        {
+            FAssetImportPipeline::Get().DownloadAndImport(SelectedVideoFileInfo.FileName, SelectedVideoFileInfo.FileUrl, SelectedVideoFileInfo.FileMd5, EAssetImportKind::Video);
+            return;
+        }
+
         // UE_LOG(LogTemp, Error, TEXT("Concept file does not exist at: %s"), *FilePath);
         
         if (ExistingNotificationWindow2.IsValid() && FSlateApplication::Get().FindWidgetWindow(ExistingNotificationWindow2.ToSharedRef()))
@@ -1253,59 +1218,7 @@ void SVideoAssetsWidget::ImportVideoFile(const FString& FilePath)
         return;
     }
 
-    // Gets the destination file name and replaces illegal characters (Spaces replaced with underscores) 获取目标文件名并替换非法字符（空格替换为下划线）
-    FString TargetFileName = FPaths::GetBaseFilename(FilePath).Replace(TEXT(" "), TEXT("_")).Replace(TEXT("."), TEXT("_"));
-
-    // Construct save path 构造保存路径
-    FString SavePath = TEXT("/Game/RSpaceImportedAssets/Videos/") + TargetFileName;
-
-    // Check whether the package already exists 检查包是否已经存在
-    if (FPackageName::DoesPackageExist(SavePath))
-    {
-        UE_LOG(LogTemp, Warning, TEXT("Asset already exists at: %s"), *SavePath);
-        return;
-    }
-
-    // Create package 创建包
-    UPackage* Package = CreatePackage(*SavePath);
-    if (!Package)
-    {
-        UE_LOG(LogTemp, Error, TEXT("Failed to create package for: %s"), *SavePath);
-        return;
-    }
-
-    // Create a FileMediaSource object 创建 FileMediaSource 对象
-    UFileMediaSource* FileMediaSource = NewObject<UFileMediaSource>(Package, UFileMediaSource::StaticClass(), FName(*TargetFileName), RF_Public | RF_Standalone);
-    if (!FileMediaSource)
-    {
-        UE_LOG(LogTemp, Error, TEXT("Failed to create UFileMediaSource object for: %s"), *FilePath);
-        return;
-    }
-
-    //Set file path  设置文件路径
-    FileMediaSource->FilePath = FilePath;
-    FileMediaSource->MarkPackageDirty();
-
-    // Saves a reference to a member variable 保存引用到成员变量
-    SavedMediaSource = FileMediaSource;
-
-    // Register assets to the asset registry 注册资产到资产注册表
-    FAssetRegistryModule::AssetCreated(SavedMediaSource);
-    UE_LOG(LogTemp, Log, TEXT("Successfully registered media source: %s"), *SavePath);
-
-    // Save package 保存包
-    FString PackageFilePath = FPackageName::LongPackageNameToFilename(SavePath, FPackageName::GetAssetPackageExtension());
-    if (UPackage::SavePackage(Package, FileMediaSource, RF_Public | RF_Standalone, *PackageFilePath, GError, nullptr, true, true, SAVE_None))
-    {
-        UE_LOG(LogTemp, Log, TEXT("Successfully imported video file as asset: %s"), *SavePath);
-        SavedMediaSource = nullptr;
-    }
-    else
-    {
-        UE_LOG(LogTemp, Error, TEXT("Failed to save package for: %s"), *SavePath);
-        SavedMediaSource = nullptr;
-    }
-
+    FAssetImportPipeline::Get().ImportFile(FilePath, EAssetImportKind::Video);
 }
 
 
@@ -1331,53 +1244,34 @@ TSharedRef<SWidget> SVideoAssetsWidget::ConstructImageItem(const FString& Projec
     
     if (!ProjectImageUrl.IsEmpty())
     {
-        FImageLoader::LoadImageFromUrl(ProjectImageUrl, FOnProjectImageReady::CreateLambda([this, ImageBox](const TArray<uint8>& ImageData)
+        const FImageRequestHandle ThumbnailRequest = FImageLoader::LoadTextureFromUrl(ProjectImageUrl, FImageLoader::GetThumbnailSize(), FOnImageTextureReady::CreateLambda([this, ImageBox](UTexture2D* LoadedTexture)
         {
-            if (ImageData.Num() > 0)
+            if (LoadedTexture && ImageBox.IsValid())
             {
-                UTexture2D* LoadedTexture = FImageLoader::CreateTextureFromBytes(ImageData);
-                if (LoadedTexture && ImageBox.IsValid())
-                {
-                    const float TextureWidth = LoadedTexture->GetSizeX();
-                    const float TextureHeight = LoadedTexture->GetSizeY();
-                    const float AspectRatio = TextureWidth / TextureHeight;
-                    
-                    ImageBox->SetWidthOverride(150.f);
-                    ImageBox->SetHeightOverride(150.f / AspectRatio);
-                    
-                    ImageBox->SetContent(
-                        SNew(SBorder)
-                        .BorderBackgroundColor(FLinearColor(0, 0, 0, 1.0f)) 
+                const float TextureWidth = LoadedTexture->GetSizeX();
+                const float TextureHeight = LoadedTexture->GetSizeY();
+                const float AspectRatio = TextureWidth / TextureHeight;
+                
+                ImageBox->SetWidthOverride(150.f);
+                ImageBox->SetHeightOverride(150.f / AspectRatio);
+                
+                ImageBox->SetContent(
+                    SNew(SBorder)
+                    .BorderBackgroundColor(FLinearColor(0, 0, 0, 1.0f)) 
+                    [
+                        SNew(SScaleBox)
+                        .Stretch(EStretch::ScaleToFit) 
+                        .StretchDirection(EStretchDirection::Both)
                         [
-                            SNew(SScaleBox)
-                            .Stretch(EStretch::ScaleToFit) 
-                            .StretchDirection(EStretchDirection::Both)
-                            [
-                                SNew(SImage)
-                                .Image(new FSlateImageBrush(LoadedTexture, FVector2D(TextureWidth, TextureHeight)))
-                            ]
+                            SNew(SImage)
+                            .Image(new FSlateImageBrush(LoadedTexture, FVector2D(TextureWidth, TextureHeight)))
                         ]
-                    );
+                    ]
+                );
 
-                    // Set up lifecycle management for textures to avoid garbage collection issues 设置纹理的生命周期管理，以避免垃圾回收问题
-                    LoadedTextures.Add(LoadedTexture);
-                    LoadedTexture->AddToRoot(); // Make sure it doesn't get recycled 确保不会被垃圾回收
-                }
-                else
-                {
-                    ImageBox->SetContent(
-                        SNew(SBorder)
-                        .BorderBackgroundColor(FLinearColor(1.0f, 0.0f, 0.0f, 1.0f))
-                        [
-                            SNew(SBox).HAlign(HAlign_Center).VAlign(VAlign_Center)
-                            [
-                                SNew(STextBlock)
-                                .Text(LOCTEXT("LoadFailed", "Load Failed"))
-                                .Justification(ETextJustify::Center)
-                            ]
-                        ]
-                    );
-                }
+                // The video tile references its cover frame while it is listed 视频控件在列表中时保持对封面帧的引用
+                LoadedTextures.Add(TStrongObjectPtr<UTexture2D>(LoadedTexture));
+                ThumbnailVisibility.OnThumbnailShown(ImageBox.ToSharedRef());
             }
             else
             {
@@ -1388,13 +1282,14 @@ TSharedRef<SWidget> SVideoAssetsWidget::ConstructImageItem(const FString& Projec
                         SNew(SBox).HAlign(HAlign_Center).VAlign(VAlign_Center)
                         [
                             SNew(STextBlock)
-                            .Text(FText::FromString(TEXT("Load Failed")))
+                            .Text(LOCTEXT("LoadFailed", "Load Failed"))
                             .Justification(ETextJustify::Center)
                         ]
                     ]
                 );
             }
         }));
+        ThumbnailVisibility.Track(ImageBox.ToSharedRef(), ThumbnailRequest);
     }
     else
     {
@@ -1418,24 +1313,9 @@ TSharedRef<SWidget> SVideoAssetsWidget::ConstructImageItem(const FString& Projec
 
 void SVideoAssetsWidget::ClearVideoContent()
 {
-    if (LoadedTextures.Num() > 0)
-    {
-        for (UTexture2D* Texture : LoadedTextures)
-        {
-            if (Texture)
-            {
-                Texture->ReleaseResource();
-                Texture->RemoveFromRoot();
-                Texture->MarkAsGarbage();
-            }
-        }
-        LoadedTextures.Empty();
-        
-    }
-    else
-    {
-        // UE_LOG(LogTemp, Warning, TEXT("No loaded textures to clear."));
-    }
+    // Cover frames remain in FImageCache, ready when this folder is opened again 封面帧仍保留在 FImageCache 中，再次打开该文件夹时可直接使用
+    LoadedTextures.Empty();
+    ThumbnailVisibility.Reset();
     
     if (VideoAssetsContainer.IsValid())
     {
@@ -1447,6 +1327,15 @@ void SVideoAssetsWidget::ClearVideoContent()
     }
 }
 
+EActiveTimerReturnType SVideoAssetsWidget::UpdateThumbnailVisibility(double InCurrentTime, float InDeltaTime)
+{
+    if (VideoAssetsContainer.IsValid())
+    {
+        ThumbnailVisibility.Update(GetPaintSpaceGeometry(), VideoAssetsContainer.ToSharedRef());
+    }
+    return EActiveTimerReturnType::Continue;
+}
+
 
 void SVideoAssetsWidget::SearchVideoFileByName(const FText& InputFileName)
 {
@@ -1,4 +1,4 @@
-// Copyright (c) 2024 Hunan MangoXR Tech Co., Ltd. All Rights Reserved.
+﻿// Copyright (c) 2024 Hunan MangoXR Tech Co., Ltd. All Rights Reserved.
 
 #include "RSAssetLibrary.h"
 #include "RSAssetLibraryStyle.h"
@@ -9,6 +9,8 @@
 #include "ProjectContent/SProjectWidget.h"
 #include "Tickable.h"
 #include "ProjectContent/Imageload/FImageLoader.h"
+#include "ProjectContent/Imageload/FImageCache.h"
+#include "ProjectContent/AssetImport/FAssetImportPipeline.h"
 
 
 static const FName RSAssetLibraryTabName("RSAssetLibrary");
@@ -86,6 +88,8 @@ void FRSAssetLibraryModule::ShutdownModule()
 	// we call this function before unloading the module.
 
 	FImageLoader::CancelAllImageRequests();
+	FImageCache::Get().Shutdown();
+	FAssetImportPipeline::Get().Shutdown();
 	
 	DockTab.Reset();
 
@@ -4,24 +4,21 @@
 
 #include "CoreMinimal.h"
 #include "Widgets/SCompoundWidget.h"
-#include "AssetDownloader.h"
-#include "Async/AsyncWork.h"
-#include "Containers/Queue.h"
+#include "Downloader/AssetDownloadSubsystem.h"
+#include "ProjectContent/AssetImport/FAssetImportPipeline.h"
 #include "Widgets/Notifications/SProgressBar.h"
 #include "ProjectContent/AssetDownloader/SDownloadCompleteWidget.h"
 
 DECLARE_DELEGATE_OneParam(FOnDownloadCompleted, const FString& /*FileName*/);
 
 
+/** One row of the download list, showing a job owned by UAssetDownloadSubsystem. */
 class SAssetDownloadWidget : public SCompoundWidget
 {
 public:
 	SLATE_BEGIN_ARGS(SAssetDownloadWidget)
-	: _URL(TEXT("")), _FileName(TEXT("")), _MD5(TEXT(""))
 	{}
-	SLATE_ARGUMENT(FString, URL)
-	SLATE_ARGUMENT(FString, FileName)
-	SLATE_ARGUMENT(FString, MD5)
+	SLATE_ARGUMENT(TWeakObjectPtr<UAssetDownloadJob>, Job)
 	SLATE_ARGUMENT(TWeakPtr<SVerticalBox>, ParentContainer)
 	SLATE_ARGUMENT(TWeakPtr<SDownloadCompleteWidget>, DownloadCompleteWidget)
 	SLATE_END_ARGS()
@@ -29,42 +26,33 @@ public:
 	void Construct(const FArguments& InArgs);
 
 
-	void SetDownloadParameters(const FString& InURL, const FString& InFileName, const FString& InMD5);
-
-
 	FReply OnStartOrResumeClicked();
 	FReply OnPauseClicked();  
 	FReply OnCancelClicked(); 
 
 
-	void OnDownloadProgress(float Progress, int64 BytesDownloaded, int64 InTotalBytes);
+	void OnDownloadProgress(UAssetDownloadJob* InJob);
+	void OnJobStateChanged(UAssetDownloadJob* InJob, EAssetDownloadState PreviousState);
 	void OnDownloadComplete();
 	void OnDownloadError();
-	void StartDownload();
+
+	/** Follows the import chained to this download by Download & Import. */
+	void OnImportStateChanged(const FString& FileName, EAssetImportState State);
 
 
 	FText GetStartOrResumeButtonText() const;
+	FText GetStatusToolTipText() const;
 
 
-	bool IsPaused() const { return AssetDownloader->IsPaused(); }
+	bool IsPaused() const;
 
 	bool IsFileDownloading(const FString& FilePath);
 
+	TWeakObjectPtr<UAssetDownloadJob> GetJob() const { return Job; }
 
-	void ProcessPendingTasks();
 	TWeakPtr<SVerticalBox> ParentContainer;
 
 
-	static TQueue<TSharedPtr<SAssetDownloadWidget>> PendingTasks; 
-	static TArray<TSharedPtr<SAssetDownloadWidget>> ActiveTasks;  
-	static TArray<TWeakPtr<SAssetDownloadWidget>> PausedTasks; 
-	static TArray<TSharedPtr<SAssetDownloadWidget>> FailedTasks;   
-	
-	static FCriticalSection ActiveTasksMutex;
-	static FCriticalSection PendingTasksMutex;
-	static FCriticalSection PausedTasksMutex;  
-
-
 	FOnDownloadCompleted OnDownloadCompleted;
 
 
@@ -75,22 +63,14 @@ public:
 
 	FString TruncateText(const FString& OriginalText, int32 MaxLength);
 
-	bool bIsPausedAllDownloads = false; 
-
-	void SetPausedAllDownloads(bool bPaused);
-
 
 private:
 
-	
-	FString OriginalURL;
-	FString AssetURL;
-	FString AssetFileName;
-	FString AssetMD5;
+	void UpdateButtonStyles();
 
+	FString AssetFileName;
 
-	UPROPERTY()
-	UAssetDownloader* AssetDownloader;
+	TWeakObjectPtr<UAssetDownloadJob> Job;
 
 
 	TSharedPtr<STextBlock> DownloadStatusText;
@@ -104,11 +84,18 @@ private:
 	FButtonStyle PauseButtonStyle;
 	FButtonStyle CancelButtonStyle;
 
-	bool bIsPaused = false; 
-
 	TWeakPtr<SDownloadCompleteWidget> DownloadCompleteWidget; 
 	
-	int64 TotalBytes; 
+	int64 TotalBytes = 0; 
+
+	// Last values shown, so unchanged progress does not invalidate the row 上次显示的值，进度未变化时不刷新此行
+	int32 LastProgressPermille = -1;
+	FString LastStatus;
+	int64 LastSpeedKB = -1;
+	int64 LastEtaSeconds = -1;
+
+	// Part of the bar filled by the download when an import follows it 有后续导入时下载占进度条的比例
+	static constexpr float DownloadShareOfImport = 0.9f;
 	
 };
 
@@ -4,7 +4,9 @@
 #pragma once
 
 #include "CoreMinimal.h"
+#include "Downloader/DownloadJournal.h"
 
+DECLARE_DELEGATE_ThreeParams(FOnResumeInterruptedDownload, const FString& /*FileName*/, const FString& /*URL*/, const FString& /*MD5*/);
 
 struct FCompletedDownloadEntry
 {
@@ -17,6 +19,7 @@ class SDownloadCompleteWidget : public SCompoundWidget
 {
 public:
 	SLATE_BEGIN_ARGS(SDownloadCompleteWidget) {}
+	SLATE_EVENT(FOnResumeInterruptedDownload, OnResumeDownload)
 	SLATE_END_ARGS()
 
 	void Construct(const FArguments& InArgs);
@@ -24,6 +27,9 @@ public:
 
 	void AddCompletedDownload(const FString& FileName, const FString& FilePath, const FString& FileSizeText);
 
+	/** Lists a partial download left by an earlier session, with a button to resume it. */
+	void AddInterruptedDownload(const FDownloadJournal& InJournal);
+
 	void RemoveFileEntryFromCSV(const FString& FileName);
 
 	FString TruncateText(const FString& OriginalText, int32 MaxLength);
@@ -33,8 +39,13 @@ private:
 
 	void LoadCompletedDownloadsFromFolder();
 
+	void LoadInterruptedDownloadsFromFolder();
+
 	TArray<FCompletedDownloadEntry> CompletedDownloads; 
 
+	FOnResumeInterruptedDownload OnResumeDownload;
+
 	FButtonStyle DeleteButtonStyle;
 	FButtonStyle SearchButtonStyle;
+	FButtonStyle ResumeButtonStyle;
 };
\ No newline at end of file
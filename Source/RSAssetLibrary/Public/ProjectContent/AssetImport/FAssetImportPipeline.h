@@ -0,0 +1,117 @@
+﻿// Copyright (c) 2024 Hunan MangoXR Tech Co., Ltd. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "Downloader/AssetDownloadSubsystem.h"
+#include "ProjectContent/AssetImport/FAssetImporter.h"
+
+class UAssetDownloadBatch;
+class UPackage;
+class SNotificationItem;
+
+/** Where a file of the Download & Import action currently is. */
+enum class EAssetImportState : uint8
+{
+	None,
+	WaitingForDownload,
+	Queued,
+	Importing,
+	Imported,
+	Failed,
+	Cancelled
+};
+
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnAssetImportStateChanged, const FString& /*FileName*/, EAssetImportState /*State*/);
+
+/**
+ * Chains downloads of UAssetDownloadSubsystem to FAssetImporter. A file registered for import is
+ * imported as soon as its job completes, which only happens after the MD5 check passed, so a folder
+ * download imports its first files while the rest are still downloading. Cancelling the download
+ * drops the import, a failed download keeps it for the retry.
+ *
+ * Files are read and decoded in parallel on the task graph, one per worker thread unless
+ * RSAsset.ImportMaxConcurrentPrepares says otherwise. The game thread creates the assets within a
+ * frame budget set by RSAsset.ImportFrameBudgetMs, and the packages of a run are saved together once
+ * the queue drained. A notification shows the progress of the run and can cancel it.
+ */
+class FAssetImportPipeline
+{
+public:
+	static FAssetImportPipeline& Get();
+
+	/** Imports the file when it is already downloaded, otherwise queues the download and imports it once it completed. */
+	void DownloadAndImport(const FString& FileName, const FString& URL, const FString& MD5, EAssetImportKind Kind);
+
+	/** Imports the file once its running download completed. */
+	void ImportWhenDownloaded(const FString& FileName, EAssetImportKind Kind);
+
+	/** Queues the import of a downloaded file. */
+	void ImportFile(const FString& FilePath, EAssetImportKind Kind);
+
+	/** Queues a folder download whose files are each imported once downloaded; files that cannot be imported are only downloaded. */
+	void DownloadAndImportModelFolder(const FString& Ticket, const FString& Uuid, const FString& ProjectNo, int32 FolderId, const FString& FolderName);
+	void DownloadAndImportVideoFolder(const FString& Ticket, const FString& ProjectNo, const FString& FolderNo, const FString& FolderName);
+
+	/** Drops every import that has not created its asset yet; assets already created are still saved. */
+	void CancelImports();
+
+	EAssetImportState GetImportState(const FString& FileName) const;
+
+	/** True while the file waits for its download or its import. */
+	bool IsImportPending(const FString& FileName) const;
+
+	void Shutdown();
+
+	FOnAssetImportStateChanged OnImportStateChanged;
+
+private:
+	/** One file on its way through the import; shared with the worker that prepares it. */
+	struct FImportTask
+	{
+		FString FilePath;
+		EAssetImportKind Kind = EAssetImportKind::Model;
+		TSharedPtr<FAssetImportPayload> Payload;
+		TAtomic<bool> bPrepared { false };
+		TAtomic<bool> bCancelled { false };
+	};
+
+	void BindToDownloads();
+	void HandleJobStateChanged(UAssetDownloadJob* Job, EAssetDownloadState PreviousState);
+	void AddBatch(UAssetDownloadBatch* Batch);
+
+	void QueueImport(const FString& FilePath, EAssetImportKind Kind);
+	// Files read and decoded at the same time; decoded images are held in memory until the game thread takes them 同时读取解码的文件数，解码后的图像在游戏线程取走前常驻内存
+	static int32 GetMaxConcurrentPrepares();
+	void StartPrepares();
+	bool ProcessImportQueue(float DeltaTime);
+	void FinishRun(bool bWasCancelled);
+	void SetImportState(const FString& FileName, EAssetImportState State);
+
+	void UpdateNotification();
+
+	// Files waiting for their download, by file name 等待下载完成的文件，以文件名为键
+	TMap<FString, EAssetImportKind> PendingDownloads;
+
+	// Folder downloads whose files are imported 需要导入文件的文件夹下载
+	TArray<TWeakObjectPtr<UAssetDownloadBatch>> ImportBatches;
+
+	// Waiting for a worker, then being prepared, in queue order 等待工作线程的任务，以及正在准备的任务，按入队顺序
+	TArray<TSharedRef<FImportTask>> QueuedTasks;
+	TArray<TSharedRef<FImportTask>> PreparingTasks;
+
+	// Packages created by the current run, saved when it finished 当前批次创建的包，批次结束时保存
+	TArray<TWeakObjectPtr<UPackage>> CreatedPackages;
+
+	int32 NumRunTasks = 0;
+	int32 NumRunFinished = 0;
+	int32 NumRunFailed = 0;
+
+	TMap<FString, EAssetImportState> ImportStates;
+
+	TWeakPtr<SNotificationItem> ProgressNotification;
+
+	FDelegateHandle JobStateChangedHandle;
+	FTSTicker::FDelegateHandle TickerHandle;
+};
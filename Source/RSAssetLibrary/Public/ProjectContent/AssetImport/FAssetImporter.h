@@ -0,0 +1,76 @@
+﻿// Copyright (c) 2024 Hunan MangoXR Tech Co., Ltd. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ImageCore.h"
+
+class UPackage;
+
+/** Which library a downloaded file belongs to, and therefore how it is imported. */
+enum class EAssetImportKind : uint8
+{
+	Model,
+	Audio,
+	Video,
+	Concept
+};
+
+/** What the worker thread read and decoded for one import, handed to the game thread to create the asset. */
+struct FAssetImportPayload
+{
+	EAssetImportKind Kind = EAssetImportKind::Model;
+	FString FilePath;
+	FString PackageName;
+	FString AssetName;
+
+	// Audio: PCM samples of a wave file 音频：波形文件的 PCM 采样
+	TArray<uint8> PCMData;
+	int32 NumChannels = 0;
+	int32 SampleRate = 0;
+	float Duration = 0.0f;
+
+	// Concept: decoded image in the file's own pixel format, moved into the texture source 原画：按文件原始像素格式解码的图像，直接移入纹理源数据
+	FImage Image;
+};
+
+/**
+ * Imports downloaded library files into /Game/RSpaceImportedAssets. An import runs in three steps so
+ * FAssetImportPipeline can spread a batch over threads and frames: Prepare reads and decodes the file
+ * on any thread, CreateAsset creates the UObjects on the game thread, and SavePackages writes every
+ * created package in one go.
+ */
+class FAssetImporter
+{
+public:
+	/** Package the file is imported to. */
+	static FString GetPackageName(EAssetImportKind Kind, const FString& FilePath);
+
+	/** True when the file was imported before, in this session or an earlier one. Game thread only. */
+	static bool IsImported(EAssetImportKind Kind, const FString& FilePath);
+
+	/** Loads the modules Prepare uses; call on the game thread before the first Prepare. */
+	static void LoadImportModules();
+
+	/** Reads and decodes the file. Runs on any thread; returns null when the file cannot be imported. */
+	static TSharedPtr<FAssetImportPayload> Prepare(EAssetImportKind Kind, const FString& FilePath);
+
+	/** Creates the asset without saving it and consumes the decoded data of the payload. Returns the package to save, or null when the import failed. */
+	static UPackage* CreateAsset(FAssetImportPayload& Payload);
+
+	static bool SavePackages(const TArray<UPackage*>& Packages);
+
+	/** Picks the import for a file of a folder download from its extension; false when it is not importable. */
+	static bool GetImportKindForFile(const FString& FilePath, EAssetImportKind& OutKind);
+
+private:
+	static bool IsWaveFormat(const FString& FilePath);
+
+	static bool PrepareWave(FAssetImportPayload& Payload);
+	static bool PrepareImage(FAssetImportPayload& Payload);
+
+	static UPackage* CreateModel(const FAssetImportPayload& Payload);
+	static UPackage* CreateSoundWave(const FAssetImportPayload& Payload);
+	static UPackage* CreateFileMediaSource(const FAssetImportPayload& Payload);
+	static UPackage* CreateTexture(FAssetImportPayload& Payload);
+};
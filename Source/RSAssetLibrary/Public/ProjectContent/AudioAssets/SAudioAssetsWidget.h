@@ -107,8 +107,6 @@ private:
 
 	void ImportAudioFile(const FString& FilePath);
 
-	void ImportSupportedAudioFormats(const FString& FilePath, const FString& FileExtension);
-
 	void ImportWithFileMediaSource(const FString& FilePath);
 
 	FOnSelectedAudioDownloadClicked OnSelectedAudioDownloadClicked;
@@ -6,6 +6,7 @@
 #include "Widgets/SCompoundWidget.h"
 #include "Brushes/SlateImageBrush.h"
 #include "Widgets/DeclarativeSyntaxSupport.h"
+#include "UObject/StrongObjectPtr.h"
 
 
 class SImageDisplayWindow : public SCompoundWidget
@@ -47,7 +48,7 @@ private:
     float CurrentZoom;
 
 
-    UTexture2D* LoadedTexture;
+    TStrongObjectPtr<UTexture2D> LoadedTexture;
 
 
     TSharedPtr<FSlateImageBrush> ImageBrush;
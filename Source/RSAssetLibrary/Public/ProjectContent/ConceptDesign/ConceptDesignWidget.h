@@ -5,6 +5,8 @@
 
 #include "CoreMinimal.h"
 #include "Widgets/SCompoundWidget.h"
+#include "UObject/StrongObjectPtr.h"
+#include "ProjectContent/Imageload/FImageVisibilityTracker.h"
 #include "Subsystem/USMSubsystem.h"
 #include "ConceptDesignLibrary/GetConceptDesignLibraryApi.h"
 #include "ProjectContent/AssetDownloader/SAssetDownloadWidget.h"
@@ -54,7 +56,12 @@ public:
 
 	void ClearConceptContent();
 
-	TArray<UTexture2D*> LoadedTextures; 
+	TArray<TStrongObjectPtr<UTexture2D>> LoadedTextures;
+
+	// Concept images in view of ConceptDesignAssetsContainer are loaded before the ones scrolled away 先加载 ConceptDesignAssetsContainer 可见区域内的概念图
+	FImageVisibilityTracker ThumbnailVisibility;
+
+	EActiveTimerReturnType UpdateThumbnailVisibility(double InCurrentTime, float InDeltaTime);
 private:
 	
 	TSharedPtr<SVerticalBox> ConceptDesignAssetsContainer;
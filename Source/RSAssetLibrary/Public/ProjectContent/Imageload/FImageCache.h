@@ -0,0 +1,171 @@
+﻿// Copyright (c) 2024 Hunan MangoXR Tech Co., Ltd. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "Downloader/AssetDownloadStats.h"
+#include "UObject/StrongObjectPtr.h"
+
+class UTexture2D;
+
+/** How a preview image lookup was served. */
+enum class EImageCacheResult : uint8
+{
+	MemoryHit,
+	DiskHit,
+	// A stale disk entry the server confirmed unchanged 服务器确认未变化的过期磁盘条目
+	Revalidated,
+	// Joined a fetch of the same URL that was already in flight 加入了同一 URL 正在进行的请求
+	Coalesced,
+	Miss
+};
+
+/** Hit counters and sizes of the thumbnail cache, logged by RSAsset.ThumbnailCacheStats. */
+struct FImageCacheStats
+{
+	int64 MemoryHits = 0;
+	int64 DiskHits = 0;
+	int64 Revalidations = 0;
+	int64 Coalesced = 0;
+	int64 Misses = 0;
+
+	int32 NumMemoryEntries = 0;
+	int64 MemoryBytes = 0;
+	int32 NumDiskEntries = 0;
+	int64 DiskBytes = 0;
+
+	/** From clearing an asset grid to the first thumbnail shown inside its viewport. */
+	FAssetLatencyHistogram TimeToFirstVisible;
+
+	/** Share of lookups served without downloading the image again, from 0 to 1. */
+	double GetHitRate() const;
+};
+
+/** What the disk tier knows about one cached image. */
+struct FImageDiskEntry
+{
+	FString Url;
+
+	/** Absolute path of the cached bytes. */
+	FString Path;
+
+	// Validators of the response, sent back when the entry is revalidated 响应的校验信息，重新验证时回传给服务器
+	FString ETag;
+	FString LastModified;
+
+	int64 Size = 0;
+
+	/** When the server last sent or confirmed the bytes. */
+	FDateTime StoredAt;
+
+	FDateTime LastAccess;
+};
+
+/**
+ * Two-tier cache for preview images. The memory tier keeps decoded textures in LRU order up to
+ * RSAsset.ThumbnailMemoryCacheMB, so reopening a folder paints its tiles at once. The disk tier keeps
+ * the downloaded bytes together with the ETag and Last-Modified of the response up to
+ * RSAsset.ThumbnailDiskCacheMB. Disk entries younger than RSAsset.ThumbnailCacheMaxAgeHours are used
+ * without asking the server, older ones are revalidated with a conditional request.
+ *
+ * The disk tier lives in Thumbnails/ under the cache root of FAssetContentStore, so a machine-wide
+ * cache root shares thumbnails as well. Instances sharing it merge their entries into one index under
+ * an FAssetCacheLock, like the content store manifest. Game thread only; files are read and written
+ * on the thread pool.
+ */
+class FImageCache
+{
+public:
+	static FImageCache& Get();
+
+	/** Returns the cached texture and marks it as most recently used, or null. */
+	UTexture2D* FindTexture(const FString& Key);
+
+	/** Keeps the texture until it is the least recently used one over the memory budget. */
+	void AddTexture(const FString& Key, UTexture2D* Texture);
+
+	/** Looks up the cached bytes of Url and marks them as most recently used. */
+	bool FindDiskEntry(const FString& Url, FImageDiskEntry& OutEntry);
+
+	/** True when the entry may be used without revalidating it with the server. */
+	static bool IsFresh(const FImageDiskEntry& Entry);
+
+	/** Reads the cached bytes on the thread pool and calls back on the game thread; the bytes are empty when the file is gone. */
+	void LoadBytes(const FString& Url, TFunction<void(const TArray<uint8>&)> OnLoaded);
+
+	/** Stores downloaded bytes with the validators of their response; the file is written on the thread pool. */
+	void StoreBytes(const FString& Url, const TArray<uint8>& Bytes, const FString& ETag, const FString& LastModified);
+
+	/** Restarts the freshness period after the server answered 304 Not Modified. */
+	void MarkRevalidated(const FString& Url);
+
+	void RemoveDiskEntry(const FString& Url);
+
+	void RecordLookup(EImageCacheResult Result);
+
+	void RecordTimeToFirstVisible(double Seconds);
+
+	FImageCacheStats GetStats() const;
+
+	void LogStats() const;
+
+	/** Drops both tiers and deletes the cached files. */
+	void Clear();
+
+	/** Saves the disk index and releases the cached textures; called when the module shuts down. */
+	void Shutdown();
+
+private:
+	FImageCache();
+
+	struct FMemoryEntry
+	{
+		TStrongObjectPtr<UTexture2D> Texture;
+		int64 Size = 0;
+		uint64 LastUse = 0;
+	};
+
+	FString GetFilePath(const FString& Url) const;
+
+	void TrimMemory();
+	void TrimDisk();
+
+	void ReadIndex(TMap<FString, FImageDiskEntry>& OutEntries) const;
+	void AdoptEntries(TMap<FString, FImageDiskEntry>&& Entries);
+	void LoadIndex();
+	void SaveIndex();
+	FString GetIndexLockPath() const;
+	static FString GetTempFilePath(const FString& Path);
+	void ScheduleIndexSave();
+
+	TMap<FString, FMemoryEntry> MemoryEntries;
+	int64 MemoryBytes = 0;
+	uint64 UseCounter = 0;
+
+	// Disk entries by URL 以 URL 为键的磁盘条目
+	TMap<FString, FImageDiskEntry> DiskEntries;
+	int64 DiskBytes = 0;
+
+	// Entries removed by this process, not taken back from another process's index 本进程已移除的条目，合并其他进程的索引时不再恢复
+	TSet<FString> DroppedEntries;
+
+	FString CacheDirectory;
+	FString IndexPath;
+
+	int64 NumMemoryHits = 0;
+	int64 NumDiskHits = 0;
+	int64 NumRevalidations = 0;
+	int64 NumCoalesced = 0;
+	int64 NumMisses = 0;
+
+	FAssetLatencyHistogram TimeToFirstVisible;
+
+	FTSTicker::FDelegateHandle SaveIndexHandle;
+
+	// The index is written this long after the last change, so a folder of new thumbnails saves it once 索引在最后一次修改后延迟写入，一个文件夹的新缩略图只保存一次
+	static constexpr float IndexSaveDelay = 5.0f;
+
+	// Files missing from the index are only deleted once they are this old 不在索引中的文件达到该时长后才会删除
+	static constexpr double StrayFileMinAgeHours = 1.0;
+};
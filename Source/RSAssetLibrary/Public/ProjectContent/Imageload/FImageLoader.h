@@ -8,26 +8,98 @@
 
 
 DECLARE_DELEGATE_OneParam(FOnProjectImageReady, const TArray<uint8>&);
+DECLARE_DELEGATE_OneParam(FOnImageTextureReady, UTexture2D*);
+
+/** Identifies one load, so its caller can cancel it without affecting others waiting for the same image. */
+struct FImageRequestHandle
+{
+	FImageRequestHandle() = default;
+	explicit FImageRequestHandle(uint64 InId) : Id(InId) {}
+
+	bool IsValid() const { return Id != 0; }
+
+	uint64 Id = 0;
+};
+
+/** How urgently a load is wanted; the download queue starts higher priorities first. */
+enum class EImageLoadPriority : uint8
+{
+	// Far outside the viewport, fetched only when nothing more urgent waits 远离视口，仅在没有更紧急的请求时获取
+	OffScreen,
+	// Close to the viewport, prefetched before the user scrolls to it 接近视口，在滚动到之前预取
+	NearViewport,
+	// Loads nobody reports visibility for 未报告可见性的加载
+	Normal,
+	// Shown on screen right now 当前显示在屏幕上
+	Visible
+};
+
+/** BGRA8 pixels decoded from an image file. */
+struct FDecodedImage
+{
+	TArray<uint8> Pixels;
+	int32 Width = 0;
+	int32 Height = 0;
+};
 
 class FImageLoader
 {
 public:
 
-	static void LoadImageFromUrl(const FString& Url, FOnProjectImageReady OnImageReadyDelegate);
+	/**
+	 * Loads the bytes of an image, from the disk tier of FImageCache when it has them and from the server
+	 * otherwise. Callers asking for a URL that is already being fetched join that fetch. Callers that only
+	 * want a texture use LoadTextureFromUrl, which decodes off the game thread.
+	 */
+	static FImageRequestHandle LoadImageFromUrl(const FString& Url, FOnProjectImageReady OnImageReadyDelegate);
+
+	/**
+	 * Loads an image as a texture through both tiers of FImageCache. A texture still in memory is handed
+	 * over before the call returns. The texture belongs to the cache; callers showing it keep it alive
+	 * with a TStrongObjectPtr instead of rooting it. Calls back with null when the bytes cannot be decoded.
+	 *
+	 * A non-zero TargetSize scales the image down to fit into it, keeping its aspect ratio; the memory
+	 * tier keeps each size apart. The handle is invalid when the texture was handed over at once.
+	 */
+	static FImageRequestHandle LoadTextureFromUrl(const FString& Url, FIntPoint TargetSize, FOnImageTextureReady OnTextureReady);
+
+	/** Size grid tiles ask LoadTextureFromUrl for, set by RSAsset.ThumbnailSize. */
+	static FIntPoint GetThumbnailSize();
 
+	/** Drops one caller; the fetch itself is cancelled once no caller waits for it any more. */
+	static void CancelImageRequest(FImageRequestHandle Handle);
+
+	/** Drops every caller waiting for Url and cancels its fetch. */
 	static void CancelImageRequest(const FString& Url);
+
+	/** Reranks one caller; a fetch shared by several callers takes the highest of their priorities. */
+	static void SetImageRequestPriority(FImageRequestHandle Handle, EImageLoadPriority Priority);
 	
 	static void CancelAllImageRequests();
 
 	static void ProcessNextImageRequest();
 	
 
-	static TMap<FString, FHttpRequestPtr> ActiveRequests;
-	
+	static UTexture2D* CreateTextureFromBytes(const TArray<uint8>& ImageData);
 
-	static void OnImageRequestComplete(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful, FOnProjectImageReady OnImageReadyDelegate, FString Url);
+	/**
+	 * Decodes image bytes to BGRA8, scaled down with a box filter to fit into a non-zero TargetSize.
+	 * Runs on any thread once the ImageWrapper module is loaded.
+	 */
+	static bool DecodeImage(const TArray<uint8>& ImageData, FDecodedImage& OutImage, FIntPoint TargetSize = FIntPoint::ZeroValue);
 
-	static UTexture2D* CreateTextureFromBytes(const TArray<uint8>& ImageData);
+	/** Averages every destination pixel over the source area it covers, four channels at a time. */
+	static void ResizeImage(const FDecodedImage& Source, FDecodedImage& OutImage, int32 Width, int32 Height);
+
+	/** Creates a transient texture from decoded pixels. Game thread only. */
+	static UTexture2D* CreateTextureFromImage(const FDecodedImage& Image);
+
+	/**
+	 * Decodes on the thread pool and creates the texture on the game thread, spending at most
+	 * RSAsset.ImageUploadBudgetMs per frame on texture creation. Calls back with null when the bytes
+	 * cannot be decoded, and not at all when CancelAllImageRequests ran meanwhile.
+	 */
+	static void CreateTextureAsync(const TArray<uint8>& ImageData, FIntPoint TargetSize, TFunction<void(UTexture2D*)> OnTextureCreated);
 
 
 	static UTexture2D* LoadTextureFromBytes(const TArray<uint8>& ImageData);
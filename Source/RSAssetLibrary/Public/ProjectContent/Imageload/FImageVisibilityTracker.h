@@ -0,0 +1,52 @@
+﻿// Copyright (c) 2024 Hunan MangoXR Tech Co., Ltd. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ProjectContent/Imageload/FImageLoader.h"
+
+class SWidget;
+
+/**
+ * Ranks the thumbnail loads of one asset grid by where their tiles sit relative to the viewport of the
+ * grid. Tiles inside the viewport load first, tiles within RSAsset.ThumbnailPrefetchScreens viewports
+ * of it are prefetched, and the rest wait until nothing more urgent is queued.
+ *
+ * Also times how long after Reset the first thumbnail shows up inside the viewport, reported by
+ * RSAsset.ThumbnailCacheStats. Game thread only.
+ */
+class FImageVisibilityTracker
+{
+public:
+	/** Forgets the tiles of the previous folder and starts timing its successor. */
+	void Reset();
+
+	/** Tracks the load of Tile; an invalid handle means the thumbnail was shown at once. */
+	void Track(const TSharedRef<SWidget>& Tile, FImageRequestHandle Handle);
+
+	void OnThumbnailShown(const TSharedRef<SWidget>& Tile);
+
+	/** Measures the tracked tiles inside Content against the viewport and reranks their loads. */
+	void Update(const FGeometry& ViewportGeometry, const TSharedRef<SWidget>& Content);
+
+	/** How often grids call Update. */
+	static constexpr float UpdateInterval = 0.1f;
+
+private:
+	struct FTrackedTile
+	{
+		TWeakPtr<SWidget> Tile;
+		FImageRequestHandle Handle;
+		EImageLoadPriority Priority = EImageLoadPriority::Normal;
+		bool bShown = false;
+	};
+
+	FTrackedTile* FindTile(const TSharedRef<SWidget>& Tile);
+
+	void RecordFirstVisible();
+
+	TArray<FTrackedTile> Tiles;
+
+	double ResetTime = 0.0;
+	bool bFirstVisibleRecorded = true;
+};
@@ -5,6 +5,8 @@
 #include "CoreMinimal.h"
 #include "ProjectContent/AssetDownloader/SAssetDownloadWidget.h"
 #include "Widgets/SCompoundWidget.h"
+#include "UObject/StrongObjectPtr.h"
+#include "ProjectContent/Imageload/FImageVisibilityTracker.h"
 #include "Subsystem/USMSubsystem.h"
 
 struct FModelFileDetails;
@@ -143,7 +145,12 @@ private:
 
 	float AnimationProgress = 0.0f;
 
-	TArray<UTexture2D*> LoadedTextures; 
+	TArray<TStrongObjectPtr<UTexture2D>> LoadedTextures;
+
+	// Model previews scrolled out of ModelAssetsContainer wait behind the visible ones ModelAssetsContainer 中滚出视野的模型预览图排在可见项之后
+	FImageVisibilityTracker ThumbnailVisibility;
+
+	EActiveTimerReturnType UpdateThumbnailVisibility(double InCurrentTime, float InDeltaTime);
 
 	int32 InitialModelVersion;  
 
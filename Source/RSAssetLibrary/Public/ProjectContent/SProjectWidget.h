@@ -11,10 +11,13 @@
 #include "Subsystem/USMSubsystem.h"
 #include "ProjectContent/AssetDownloader/SDownloadCompleteWidget.h"
 #include "Widgets/Layout/SScrollBox.h"
+#include "UObject/StrongObjectPtr.h"
 
 
 class UGetModelLibrary;
 class SAssetDownloadWidget;
+class UAssetDownloadJob;
+enum class EAssetDownloadState : uint8;
 DECLARE_DELEGATE(FOnLogoutDelegate);
 
 struct FConceptDesignFileItem;
@@ -186,6 +189,23 @@ public:
 
 	void HandleVideoAssetDownloadClicked(const FString& InName, const FString& InURL, const FString& InMD5);
 
+	// Right click on a tree folder queues its whole subtree 右键目录树中的文件夹可下载整个子目录
+	FReply OnFolderMouseButtonUp(const FGeometry& Geometry, const FPointerEvent& MouseEvent, FSimpleDelegate OnDownloadFolder, FSimpleDelegate OnDownloadAndImportFolder);
+	void DownloadModelFolder(int32 FolderId, FString FolderName);
+	void DownloadVideoFolder(FString FolderNo, FString FolderName);
+	void DownloadAndImportModelFolder(int32 FolderId, FString FolderName);
+	void DownloadAndImportVideoFolder(FString FolderNo, FString FolderName);
+	void HandleDownloadJobsProgress(const TArray<UAssetDownloadJob*>& Jobs);
+	void HandleDownloadJobStateChanged(UAssetDownloadJob* Job, EAssetDownloadState PreviousState);
+	void RefreshDownloadSummaryTexts();
+	FText BuildBatchProgressText() const;
+	FText BuildDownloadStatsText() const;
+	FText GetDownloadStatsToolTipText() const;
+
+	// Bottom bar texts, refreshed by download events 底栏文本，由下载事件刷新
+	FText BatchProgressText;
+	FText DownloadStatsText;
+
 	void ResetExpandedState(EButtonClick ParentButtonType);
 
 	void UpdateRightContentBox(TSharedRef<SWidget> NewContentWidget);
@@ -247,8 +267,7 @@ public:
 
 	void OnDownloadQueueWindowClosed(const TSharedRef<SWindow>& ClosedWindow);
 	void AddToDownloadQueue(const FString& FileName, const FString& URL, const FString& MD5);
-	static TQueue<TSharedPtr<SAssetDownloadWidget>> PendingTasks;
-	static TArray<TSharedPtr<SAssetDownloadWidget>> ActiveTasks;
+	void AddDownloadJobRow(UAssetDownloadJob* Job);
 
 
 public:
@@ -317,6 +336,7 @@ private:
 	TSharedPtr<SImage> ModelAssetsIcon;
 	TSharedPtr<SImage> UserAvatarImageWidget;
 	TSharedPtr<FSlateBrush> UserAvatarBrush;
+	TStrongObjectPtr<UTexture2D> UserAvatarTexture;
 
 	TMap<EButtonClick, bool> ExpandedStateMap;
 	
@@ -358,6 +378,8 @@ private:
 	void ShowCompletedQueue();
 
 	void OnDownloadComplete(const FString& InFileName, const FString& InFilePath, const FString& FileSizeText );
+
+	void HandleResumeInterruptedDownload(const FString& InFileName, const FString& InURL, const FString& InMD5);
 	
 	TSharedPtr<SVerticalBox> CompletedDownloadContainer;
 	TSharedPtr<SScrollBox> ScrollBox;
@@ -377,12 +399,8 @@ private:
 	FDelegateHandle FocusChangeHandle;
 	
 public:
-	void CleanInvalidPausedTasks();
-	
 	void CloseAllOpenedWindows();
 
 	void GetAllWindowsRecursive(TArray<TSharedRef<SWindow>>& OutWindows, TSharedRef<SWindow> CurrentWindow);
 	
-	const int32 MaxDownloadQueueSize = 10;
-	
 };
@@ -5,11 +5,12 @@
 #include "ProjectContent/AssetDownloader/SAssetDownloadWidget.h"
 #include "VideoLibrary/GetVideoAssetLibraryListInfoData.h"
 #include "Widgets/SCompoundWidget.h"
+#include "UObject/StrongObjectPtr.h"
+#include "ProjectContent/Imageload/FImageVisibilityTracker.h"
 #include "Subsystem/USMSubsystem.h"
 #include "VideoLibrary/GetVideoVersionFileInfoData.h"
 
 class SVideoPlayerWidget;
-class UFileMediaSource;
 class UUSMSubsystem;
 
 DECLARE_DELEGATE_OneParam(FOnVedioUpdateDetailsBar, TSharedRef<SWidget>); 
@@ -111,8 +112,6 @@ private:
 
 	FOnSelectedVideoDownloadClicked OnSelectedVideoDownloadClicked;
 	
-	UFileMediaSource* SavedMediaSource = nullptr;
-
 	TSharedPtr<FButtonStyle> SelectedButtonStyle = nullptr;
 
 	bool IsFileDownloaded(const FString& ForbidFileName) const;
@@ -144,7 +143,12 @@ private:
 
 	float AnimationProgress = 0.0f; 
 
-	TArray<UTexture2D*> LoadedTextures; 
+	TArray<TStrongObjectPtr<UTexture2D>> LoadedTextures;
+
+	// Cover frames of the video tiles on screen load first, the rest by distance to the view 屏幕上视频控件的封面帧优先加载，其余按与可见区域的距离排序
+	FImageVisibilityTracker ThumbnailVisibility;
+
+	EActiveTimerReturnType UpdateThumbnailVisibility(double InCurrentTime, float InDeltaTime);
 
 	TMap<FString, FVideoAssetInfo> SelectedVersionData;
 
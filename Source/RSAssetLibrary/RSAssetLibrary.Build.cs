@@ -61,6 +61,7 @@ public class RSAssetLibrary : ModuleRules
 				"UserSessionManager", 
 				"EditorScriptingUtilities", 
 				"MediaAssets", 
+				"ImageCore",
 				// ... add private dependencies that you statically link with here ...	
 			}
 			);
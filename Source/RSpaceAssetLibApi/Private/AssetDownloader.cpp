@@ -1,18 +1,27 @@
 ﻿// Copyright (c) 2024 Hunan MangoXR Tech Co., Ltd. All Rights Reserved.
 
 #include "AssetDownloader.h"
+#include "Downloader/AssetBandwidthLimiter.h"
+#include "Downloader/AssetContentStore.h"
 #include "HttpModule.h"
 #include "Interfaces/IHttpResponse.h"
 #include "Misc/Paths.h"
 #include "Misc/FileHelper.h"
+#include "HAL/FileManager.h"
 #include "HAL/PlatformFilemanager.h"
 #include "GenericPlatform/GenericPlatformFile.h"
+#include "Containers/Ticker.h"
+#include "Misc/EngineVersionComparison.h"
+
+// IHttpRequest can stream a response body into an FArchive from UE 5.3 on 自 UE 5.3 起 IHttpRequest 支持将响应体直接写入 FArchive
+#define RSASSET_STREAM_RESPONSE_BODY !UE_VERSION_OLDER_THAN(5, 3, 0)
 
 void UAssetDownloader::StartChunkDownload(const FString& URL, const FString& FileName, const FString& MD5)
 {
     DownloadURL = URL;
     DownloadFileName = FileName;
     DownloadMD5 = MD5;
+    bIsPaused = false;
     
     FString SaveDir = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("RspaceAssetsLibrary"));
     IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
@@ -33,52 +42,466 @@ void UAssetDownloader::StartChunkDownload(const FString& URL, const FString& Fil
         }
     }
     
-    // if (CheckIfFileExistsWithMD5(FileName, MD5))
-    // {
-    //     // UE_LOG(LogTemp, Log, TEXT("File %s already exists with MD5 %s, skipping download."), *FileName, *MD5);
-    //     if (OnFileAlreadyDownloaded.IsBound())
-    //     {
-    //         OnFileAlreadyDownloaded.Execute();
-    //     }
-    //     return;
-    // }
+    bIsWaitingForSharedDownload = false;
+    if (CompleteFromContentStore())
+    {
+        return;
+    }
+
+    // Another editor instance on this machine is fetching the same content: wait for it 本机其他编辑器实例正在下载相同内容：等待其完成
+    if (!AcquireCacheLock())
+    {
+        WaitForSharedDownload();
+        return;
+    }
+
+    // It may have finished between the lookup and the lock 它可能在查找和加锁之间已经完成
+    if (CompleteFromContentStore())
+    {
+        return;
+    }
+
+    StartNetworkDownload();
+}
+
+void UAssetDownloader::StartNetworkDownload()
+{
+    ResetDownloadState();
+    MigrateLegacyPartialFile();
+    Stats.Start(FPlatformTime::Seconds());
+
+    // A matching journal already knows the file size, ranges start right away 匹配的日志已记录文件大小，直接开始分段下载
+    FDownloadJournal SavedJournal;
+    if (SavedJournal.Load(FDownloadJournal::GetJournalPath(GetPartFilePath()))
+        && SavedJournal.FileSize > 0
+        && SavedJournal.Matches(DownloadURL, SavedJournal.FileSize, DownloadMD5))
+    {
+        if (BeginFileDownload(SavedJournal.FileSize))
+        {
+            DownloadNextChunk();
+        }
+        return;
+    }
+
+    DeleteJournal();
+    SendFirstRangeRequest();
+}
+
+bool UAssetDownloader::CompleteFromContentStore()
+{
+    // Content already in the store completes without touching the network 存储中已有相同内容时直接完成，不再下载
+    FAssetStoreEntry StoreEntry;
+    if (DownloadMD5.IsEmpty() || !FAssetContentStore::Get().FindEntry(DownloadMD5, StoreEntry))
+    {
+        return false;
+    }
+
+    CloseFileWriter();
+    DeleteJournal();
+    IFileManager::Get().Delete(*GetPartFilePath(), false, true, true);
+    if (!FAssetContentStore::Get().MaterializeTo(DownloadMD5, GetDownloadFilePath()))
+    {
+        return false;
+    }
+
+    // UE_LOG(LogTemp, Log, TEXT("File %s already exists with MD5 %s, skipping download."), *FileName, *MD5);
+    ReleaseCacheLock();
+    bIsWaitingForSharedDownload = false;
+    DownloadFileSize = StoreEntry.Size;
+    DownloadedBytes = StoreEntry.Size;
+    bIsCompleted = true;
+    if (OnDownloadProgress.IsBound())
+    {
+        OnDownloadProgress.Execute(1.0f, DownloadedBytes, DownloadFileSize, 0);
+    }
+    if (OnFileAlreadyDownloaded.IsBound())
+    {
+        OnFileAlreadyDownloaded.Execute();
+    }
+    else if (OnDownloadComplete.IsBound())
+    {
+        OnDownloadComplete.Execute();
+    }
+    return true;
+}
+
+bool UAssetDownloader::AcquireCacheLock()
+{
+    if (DownloadMD5.IsEmpty() || CacheLock.IsValid())
+    {
+        return true;
+    }
+
+    CacheLock = FAssetContentStore::Get().TryLockDownload(DownloadMD5);
+    return CacheLock.IsValid();
+}
+
+void UAssetDownloader::ReleaseCacheLock()
+{
+    CacheLock.Reset();
+}
+
+void UAssetDownloader::WaitForSharedDownload()
+{
+    if (!bIsWaitingForSharedDownload)
+    {
+        bIsWaitingForSharedDownload = true;
+        UE_LOG(LogTemp, Log, TEXT("%s is being downloaded by another editor instance, waiting for it."), *DownloadFileName);
+        if (OnDownloadProgress.IsBound())
+        {
+            OnDownloadProgress.Execute(DownloadFileSize > 0 ? (float)DownloadedBytes / (float)DownloadFileSize : 0.0f, DownloadedBytes, DownloadFileSize, CurrentChunkSize);
+        }
+    }
+    ScheduleSharedDownloadPoll();
+}
+
+void UAssetDownloader::ScheduleSharedDownloadPoll()
+{
+    // One poll at a time, however often the download is paused and resumed 无论暂停和继续多少次，同时只有一个轮询
+    if (bIsSharedDownloadPollScheduled)
+    {
+        return;
+    }
+
+    bIsSharedDownloadPollScheduled = true;
+    TWeakObjectPtr<UAssetDownloader> WeakThis(this);
+    FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([WeakThis](float DeltaTime)
+    {
+        if (UAssetDownloader* Downloader = WeakThis.Get())
+        {
+            Downloader->bIsSharedDownloadPollScheduled = false;
+            Downloader->DownloadNextChunk();
+        }
+        return false;
+    }), SharedDownloadPollInterval);
+}
+
+void UAssetDownloader::PollSharedDownload()
+{
+    if (CompleteFromContentStore())
+    {
+        return;
+    }
+
+    if (!AcquireCacheLock())
+    {
+        ScheduleSharedDownloadPoll();
+        return;
+    }
+
+    // The other instance stopped without storing the file, so it is fetched here 其他实例未完成就停止了，由本实例下载
+    bIsWaitingForSharedDownload = false;
+    if (CompleteFromContentStore())
+    {
+        return;
+    }
+    if (bIsFileSizeKnown)
+    {
+        DownloadNextChunk();
+    }
+    else
+    {
+        StartNetworkDownload();
+    }
+}
+
+void UAssetDownloader::ResetDownloadState()
+{
+    DownloadFileSize = 0;
+    bIsFileSizeKnown = false;
+    TotalChunks = 0;
+    DownloadedBytes = 0;
+    CurrentChunk = 0;
+    NextRangeStart = 0;
+    ActiveSegments.Reset();
+    PendingRanges.Reset();
+    RetryRanges.Reset();
+    RetryCount = 0;
+    FirstRangeRetryCount = 0;
+    FirstRangeRetryTime = 0.0;
+    bHasFailed = false;
+    bIsCompleted = false;
+    bIsCorrupt = false;
+    FlushedBytes = 0;
+    PendingCommits = 0;
+    FirstRangeStream.Reset();
+    bInSlowStart = true;
+    SmoothedBytesPerSecond = 0.0;
+    CurrentChunkSize = FMath::Clamp<int64>(ChunkSize, MinChunkSize, MaxChunkSize);
+}
+
+void UAssetDownloader::SendFirstRangeRequest()
+{
+    if (HttpRequest.IsValid() && HttpRequest->GetStatus() == EHttpRequestStatus::Processing)
+    {
+        return;
+    }
+
+    // The first range also reports the file size, so no HEAD round trip is needed 第一个分段同时返回文件大小，无需额外的 HEAD 请求
+    FAssetBandwidthLimiter& BandwidthLimiter = FAssetBandwidthLimiter::Get();
+    const int64 FirstRangeBytes = BandwidthLimiter.IsLimited()
+        ? FMath::Min(SingleRequestFileSize, FMath::Max(BandwidthLimiter.GetBurstBytes(), DefaultMinChunkSize))
+        : SingleRequestFileSize;
+    if (!AcquireBandwidth(FirstRangeBytes))
+    {
+        return;
+    }
+
+    // The first body goes into a fresh partial file; without a journal its old bytes are stale 首个响应体写入新的临时文件；没有日志时旧数据无效
+    CloseFileWriter();
+    IFileManager::Get().Delete(*GetPartFilePath(), false, true, true);
+    FlushedBytes = 0;
+    FileWriter = MakeShared<FAssetFileWriter>(GetPartFilePath(), FOnChunkWriteFlushed::CreateUObject(this, &UAssetDownloader::HandleChunkWriteFlushed, ++FileWriterGeneration));
+    if (!FileWriter->Open())
+    {
+        BroadcastDownloadError();
+        return;
+    }
+
+    FirstRangeIssueTime = FPlatformTime::Seconds();
+    FirstRangeReportedBytes = 0;
     HttpRequest = FHttpModule::Get().CreateRequest();
     HttpRequest->OnProcessRequestComplete().BindUObject(this, &UAssetDownloader::HandleInitialResponse);
-    HttpRequest->SetURL(URL);
-    HttpRequest->SetVerb(TEXT("HEAD"));
+    BindRequestProgress(HttpRequest);
+    HttpRequest->SetURL(DownloadURL);
+    HttpRequest->SetVerb(TEXT("GET"));
+    HttpRequest->SetHeader(TEXT("Range"), FString::Printf(TEXT("bytes=0-%lld"), FirstRangeBytes - 1));
+
+#if RSASSET_STREAM_RESPONSE_BODY
+    // A server that ignores the range sends the whole file, which is streamed as well 忽略 Range 的服务器会发送整个文件，同样流式写入
+    FirstRangeStream = MakeShared<FAssetResponseStream>(FileWriter.ToSharedRef(), 0, FirstRangeBytes, -1);
+    FirstRangeStream->AcceptFullBody();
+    FirstRangeStream->SetRequest(HttpRequest);
+    HttpRequest->SetResponseBodyReceiveStream(FirstRangeStream.ToSharedRef());
+#endif
     HttpRequest->ProcessRequest();
 }
 
 void UAssetDownloader::HandleInitialResponse(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful)
 {
-    if (bWasSuccessful)
+    // A request cancelled by pause is sent again on resume 暂停时取消的请求在继续时重新发送
+    if (bIsPaused || bHasFailed)
     {
-        FString ContentLengthStr = Response->GetHeader("Content-Length");
-        DownloadFileSize = FCString::Atoi64(*ContentLengthStr);
+        return;
+    }
 
-        TotalChunks = FMath::CeilToInt((float)DownloadFileSize / ChunkSize);
-        DownloadedBytes = 0;
-        bIsPaused = false;
-        DownloadNextChunk();
+    int64 ReceivedBytes = 0;
+    bool bStreamRejected = true;
+#if RSASSET_STREAM_RESPONSE_BODY
+    // The body already went to the writer while it arrived, only the last buffer is left 响应体接收时已交给写线程，只剩最后一块缓冲
+    if (FirstRangeStream.IsValid())
+    {
+        FirstRangeStream->Flush();
+        ReceivedBytes = FirstRangeStream->GetReceivedBytes();
+        bStreamRejected = FirstRangeStream->WasRejected();
+        FirstRangeStream.Reset();
     }
-    else
+#else
+    // The body is buffered and checked below together with the status and Content-Range 响应体已缓存，下面与状态码和 Content-Range 一起检查
+    if (bWasSuccessful && Response.IsValid())
     {
+        ReceivedBytes = Response->GetContent().Num();
+        bStreamRejected = false;
+    }
+#endif
+
+    const int32 ResponseCode = bWasSuccessful && Response.IsValid() ? Response->GetResponseCode() : 0;
+    int64 RangeStart = 0;
+    int64 RangeEnd = -1;
+    int64 TotalSize = -1;
+    if (ResponseCode == 206 || ResponseCode == 416)
+    {
+        FAssetResponseStream::ParseContentRange(Response->GetHeader(TEXT("Content-Range")), RangeStart, RangeEnd, TotalSize);
+    }
+    else if (ResponseCode == 200)
+    {
+        // The server ignored the range and sent the whole file 服务器忽略了 Range，直接返回整个文件
+        TotalSize = ReceivedBytes;
+        RangeEnd = TotalSize - 1;
+    }
+
+    // 416 is only expected for an empty file; any other answer must have reached the file in full 只有空文件才会返回 416；其他响应必须完整写入文件
+    const bool bIsBodyComplete = ResponseCode == 416 || (!bStreamRejected && ReceivedBytes == RangeEnd + 1);
+    if (TotalSize < 0 || RangeStart != 0 || (ResponseCode == 416 && TotalSize != 0) || !bIsBodyComplete)
+    {
+        const bool bIsCutShort = (ResponseCode == 200 || ResponseCode == 206) && !bIsBodyComplete;
+        if ((IsRetryableFailure(bWasSuccessful, Response) || bIsCutShort) && FirstRangeRetryCount < MaxRetriesPerRange)
+        {
+            const float Delay = GetRetryDelay(FirstRangeRetryCount++);
+            RetryCount++;
+            Stats.RecordRetry();
+            FirstRangeRetryTime = FPlatformTime::Seconds() + Delay;
+            UE_LOG(LogTemp, Warning, TEXT("First range of %s failed, retry %d in %.1f s."), *DownloadFileName, FirstRangeRetryCount, Delay);
+            ScheduleDownloadNextChunk(Delay);
+            return;
+        }
+
         //UE_LOG(LogTemp, Error, TEXT("Failed to get file size from server."));
-        if (OnDownloadError.IsBound())
+        BroadcastDownloadError();
+        return;
+    }
+
+#if !RSASSET_STREAM_RESPONSE_BODY
+    // Only a checked body is written to the partial file 只有通过检查的响应体才写入临时文件
+    if (ReceivedBytes > 0 && FileWriter.IsValid())
+    {
+        FileWriter->EnqueueWrite(0, TArray<uint8>(Response->GetContent().GetData(), (int32)ReceivedBytes));
+    }
+#endif
+
+    RecordReceivedBytes(FirstRangeIssueTime, FirstRangeReportedBytes, ReceivedBytes);
+    Stats.RangeLatency.AddSample(FPlatformTime::Seconds() - FirstRangeIssueTime);
+
+    // The bytes of the first response stay in the partial file 第一个响应的数据保留在临时文件中
+    if (!BeginFileDownload(TotalSize, ReceivedBytes))
+    {
+        return;
+    }
+
+    if (ReceivedBytes > 0)
+    {
+        CurrentChunk++;
+        UpdateChunkSize(ReceivedBytes, FPlatformTime::Seconds() - FirstRangeIssueTime);
+
+        if (OnDownloadProgress.IsBound())
         {
-            OnDownloadError.Execute();
+            OnDownloadProgress.Execute((float)DownloadedBytes / (float)DownloadFileSize, DownloadedBytes, DownloadFileSize, CurrentChunkSize);
         }
     }
+
+    DownloadNextChunk();
+}
+
+bool UAssetDownloader::BeginFileDownload(int64 FileSize, int64 FirstRangeBytes)
+{
+    DownloadFileSize = FileSize;
+    bIsFileSizeKnown = true;
+    TotalChunks = FMath::CeilToInt((float)DownloadFileSize / ChunkSize);
+
+    CloseFileWriter();
+
+    // Continue a download left over from an earlier session 继续上次会话中断的下载
+    if (FirstRangeBytes == 0 && RestoreFromJournal())
+    {
+        UE_LOG(LogTemp, Log, TEXT("Resuming %s from journal at %lld/%lld bytes."), *DownloadFileName, DownloadedBytes, DownloadFileSize);
+    }
+    else
+    {
+        Journal = FDownloadJournal();
+        Journal.URL = DownloadURL;
+        Journal.FileName = DownloadFileName;
+        Journal.MD5 = DownloadMD5;
+        Journal.FileSize = DownloadFileSize;
+
+        if (FirstRangeBytes > 0)
+        {
+            // The first response was streamed into the partial file and passed its checks 首个响应已写入临时文件并通过校验
+            Journal.AddCompletedRange(0, FirstRangeBytes - 1);
+            DownloadedBytes = FirstRangeBytes;
+            NextRangeStart = FirstRangeBytes;
+        }
+        else
+        {
+            // Stale bytes from an unrelated earlier file must not survive 删除无关的旧文件内容
+            IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+            if (PlatformFile.FileExists(*GetPartFilePath()))
+            {
+                PlatformFile.DeleteFile(*GetPartFilePath());
+            }
+        }
+    }
+
+    // One handle stays open for the whole download, the file is preallocated to its full size 整个下载过程只打开一个文件句柄，文件预先分配到完整大小
+    FlushedBytes = 0;
+    PendingCommits = 0;
+    FileWriter = MakeShared<FAssetFileWriter>(GetPartFilePath(), FOnChunkWriteFlushed::CreateUObject(this, &UAssetDownloader::HandleChunkWriteFlushed, ++FileWriterGeneration));
+    FileWriter->SetOnRangeCommitted(FOnRangeCommitted::CreateUObject(this, &UAssetDownloader::HandleRangeCommitted, FileWriterGeneration));
+    FileWriter->SetPreallocatedSize(DownloadFileSize);
+    if (!DownloadMD5.IsEmpty())
+    {
+        // Hash while writing; a resumed prefix is hashed from disk once 边写边计算哈希；续传的前缀只从磁盘读取一次
+        const int64 HashPrefixBytes = Journal.CompletedRanges.Num() > 0 && Journal.CompletedRanges[0].Key == 0
+            ? Journal.CompletedRanges[0].Value + 1
+            : 0;
+        FileWriter->EnableHashing(DownloadFileSize, HashPrefixBytes);
+    }
+    if (!FileWriter->Open())
+    {
+        //UE_LOG(LogTemp, Error, TEXT("Failed to open file for writing chunk data."));
+        BroadcastDownloadError();
+        return false;
+    }
+
+    if (DownloadedBytes > 0 && OnDownloadProgress.IsBound())
+    {
+        OnDownloadProgress.Execute((float)DownloadedBytes / (float)DownloadFileSize, DownloadedBytes, DownloadFileSize, CurrentChunkSize);
+    }
+    return true;
 }
 
 void UAssetDownloader::DownloadNextChunk()
 {
-    if (bIsPaused) return;
+    if (bIsPaused || bHasFailed || bIsCompleted) return;
 
-    if (DownloadedBytes >= DownloadFileSize)
+    if (bIsWaitingForSharedDownload)
     {
+        PollSharedDownload();
+        return;
+    }
+
+    if (!bIsFileSizeKnown)
+    {
+        // A failed first range waits for its backoff; a ticker that fires early is scheduled again 失败的首个分段需等待退避时间；提前触发的定时器重新调度
+        const double Now = FPlatformTime::Seconds();
+        if (Now >= FirstRangeRetryTime)
+        {
+            SendFirstRangeRequest();
+        }
+        else
+        {
+            ScheduleDownloadNextChunk((float)(FirstRangeRetryTime - Now));
+        }
+        return;
+    }
+
+    if (IsDownloadFinished())
+    {
+        // Wait until the writer thread has flushed every chunk and journaled every range 等待写线程写完所有分段并记录所有范围
+        if (FileWriter.IsValid() && (FlushedBytes < FileWriter->GetQueuedBytes() || PendingCommits > 0))
+        {
+            return;
+        }
+
+        bIsCompleted = true;
+        const bool bVerified = VerifyDownloadedFile();
+        CloseFileWriter();
+        DeleteJournal();
+
+        if (!bVerified)
+        {
+            // Keep the bad file out of the library under a .corrupt name 将损坏的文件改名为 .corrupt，避免被导入
+            bIsCorrupt = true;
+            IFileManager::Get().Move(*GetCorruptFilePath(GetDownloadFilePath()), *GetPartFilePath(), true, true);
+            BroadcastDownloadError();
+            return;
+        }
+
+        // Only a verified file ever appears under its final name 只有校验通过的文件才会以最终文件名出现
+        if (!IFileManager::Get().Move(*GetDownloadFilePath(), *GetPartFilePath(), true, true))
+        {
+            UE_LOG(LogTemp, Error, TEXT("Failed to rename %s to its final name."), *GetPartFilePath());
+            BroadcastDownloadError();
+            return;
+        }
+
          UE_LOG(LogTemp, Log, TEXT("Download complete."));
-        //SaveToCSV(DownloadFileName, DownloadMD5);
+        if (!DownloadMD5.IsEmpty())
+        {
+            FAssetContentStore::Get().AddFile(DownloadMD5, GetDownloadFilePath());
+        }
+
+        // Instances waiting for this content find it in the store once the lock is gone 锁释放后，等待的实例可从存储中取得内容
+        ReleaseCacheLock();
         if (OnDownloadComplete.IsBound())
         {
             OnDownloadComplete.Execute();
@@ -86,69 +509,587 @@ void UAssetDownloader::DownloadNextChunk()
         return;
     }
 
-    int64 StartByte = DownloadedBytes;
-    int64 EndByte = FMath::Min(StartByte + ChunkSize - 1, DownloadFileSize - 1);
+    // Keep up to MaxConcurrentSegments ranges in flight 保持最多 MaxConcurrentSegments 个分段同时下载
+    while (ActiveSegments.Num() < MaxConcurrentSegments && IssueNextSegment())
+    {
+    }
 
-    HttpRequest = FHttpModule::Get().CreateRequest();
-    HttpRequest->OnProcessRequestComplete().BindUObject(this, &UAssetDownloader::HandleChunkDownloadComplete);
-    HttpRequest->SetURL(DownloadURL);
-    HttpRequest->SetVerb(TEXT("GET"));
+    // Ranges still in their backoff need a wake-up, also when a ticker fired slightly early 仍在退避中的分段需要唤醒，定时器略早触发时同样如此
+    if (ActiveSegments.Num() < MaxConcurrentSegments && !bIsWaitingForBandwidth && RetryRanges.Num() > 0)
+    {
+        double ReadyTime = RetryRanges[0].ReadyTime;
+        for (const FDownloadRetryRange& Retry : RetryRanges)
+        {
+            ReadyTime = FMath::Min(ReadyTime, Retry.ReadyTime);
+        }
+
+        const double Now = FPlatformTime::Seconds();
+        if (ReadyTime > Now)
+        {
+            ScheduleDownloadNextChunk((float)(ReadyTime - Now));
+        }
+    }
+}
+
+bool UAssetDownloader::AcquireBandwidth(int64 NumBytes)
+{
+    if (bIsWaitingForBandwidth)
+    {
+        return false;
+    }
+
+    if (BandwidthCredit < NumBytes)
+    {
+        const int64 MissingBytes = NumBytes - BandwidthCredit;
+        TWeakObjectPtr<UAssetDownloader> WeakThis(this);
+        const bool bGranted = FAssetBandwidthLimiter::Get().RequestBytes(this, MissingBytes, BandwidthWeight, FOnBandwidthGranted::CreateLambda([WeakThis](int64 GrantedBytes)
+        {
+            if (UAssetDownloader* Downloader = WeakThis.Get())
+            {
+                Downloader->BandwidthCredit += GrantedBytes;
+                Downloader->bIsWaitingForBandwidth = false;
+                Downloader->DownloadNextChunk();
+            }
+        }));
+        if (!bGranted)
+        {
+            bIsWaitingForBandwidth = true;
+            return false;
+        }
+        BandwidthCredit += MissingBytes;
+    }
+
+    BandwidthCredit -= NumBytes;
+    return true;
+}
+
+bool UAssetDownloader::IssueNextSegment()
+{
+    // Back-pressure: no new range while the disk lags behind the network 背压：磁盘写入落后于网络时不发起新的分段
+    if (FileWriter.IsValid() && FileWriter->GetQueuedBytes() - FlushedBytes > MaxUnflushedBytes)
+    {
+        return false;
+    }
+
+    // With a bandwidth cap one range never exceeds the bucket 限速时单个分段不超过令牌桶容量
+    FAssetBandwidthLimiter& BandwidthLimiter = FAssetBandwidthLimiter::Get();
+    int64 SegmentSize = BandwidthLimiter.IsLimited()
+        ? FMath::Min(CurrentChunkSize, FMath::Max(BandwidthLimiter.GetBurstBytes(), DefaultMinChunkSize))
+        : CurrentChunkSize;
+#if !RSASSET_STREAM_RESPONSE_BODY
+    // Without streaming each body is held in memory, so ranges stay small 无法流式接收时响应体保存在内存中，分段需保持较小
+    SegmentSize = FMath::Min(SegmentSize, MaxBufferedSegmentSize);
+#endif
+
+    int64 StartByte = 0;
+    int64 EndByte = 0;
+    int32 SegmentRetryCount = 0;
+
+    // Failed ranges whose backoff has passed come first 退避时间已到的失败分段最先重试
+    const double Now = FPlatformTime::Seconds();
+    const int32 RetryIndex = RetryRanges.IndexOfByPredicate([Now](const FDownloadRetryRange& Retry)
+    {
+        return Retry.ReadyTime <= Now;
+    });
+
+    if (RetryIndex != INDEX_NONE)
+    {
+        StartByte = RetryRanges[RetryIndex].StartByte;
+        EndByte = FMath::Min(RetryRanges[RetryIndex].EndByte, StartByte + SegmentSize - 1);
+        SegmentRetryCount = RetryRanges[RetryIndex].RetryCount;
+    }
+    // Ranges returned by a pause, a short response or the journal are fetched first 优先下载暂停、响应不完整或日志中缺失的分段
+    else if (PendingRanges.Num() > 0)
+    {
+        StartByte = PendingRanges[0].Key;
+        EndByte = FMath::Min(PendingRanges[0].Value, StartByte + SegmentSize - 1);
+    }
+    else if (NextRangeStart < DownloadFileSize)
+    {
+        StartByte = NextRangeStart;
+        EndByte = FMath::Min(StartByte + SegmentSize - 1, DownloadFileSize - 1);
+    }
+    else
+    {
+        return false;
+    }
+
+    // The range is only taken once the limiter has granted its bytes 限速器授权后才取出该分段
+    if (!AcquireBandwidth(EndByte - StartByte + 1))
+    {
+        return false;
+    }
+
+    if (RetryIndex != INDEX_NONE)
+    {
+        if (EndByte >= RetryRanges[RetryIndex].EndByte)
+        {
+            RetryRanges.RemoveAt(RetryIndex);
+        }
+        else
+        {
+            RetryRanges[RetryIndex].StartByte = EndByte + 1;
+        }
+    }
+    else if (PendingRanges.Num() > 0)
+    {
+        if (EndByte >= PendingRanges[0].Value)
+        {
+            PendingRanges.RemoveAt(0);
+        }
+        else
+        {
+            PendingRanges[0].Key = EndByte + 1;
+        }
+    }
+    else
+    {
+        NextRangeStart = EndByte + 1;
+    }
+
+    FDownloadSegment& Segment = ActiveSegments.AddDefaulted_GetRef();
+    Segment.StartByte = StartByte;
+    Segment.EndByte = EndByte;
+    Segment.IssueTime = FPlatformTime::Seconds();
+    Segment.RetryCount = SegmentRetryCount;
+    Segment.Request = FHttpModule::Get().CreateRequest();
+    Segment.Request->OnProcessRequestComplete().BindUObject(this, &UAssetDownloader::HandleChunkDownloadComplete);
+    BindRequestProgress(Segment.Request);
+    Segment.Request->SetURL(DownloadURL);
+    Segment.Request->SetVerb(TEXT("GET"));
 
     FString RangeHeader = FString::Printf(TEXT("bytes=%lld-%lld"), StartByte, EndByte);
-    HttpRequest->SetHeader(TEXT("Range"), RangeHeader);
-    HttpRequest->ProcessRequest();
+    Segment.Request->SetHeader(TEXT("Range"), RangeHeader);
+#if RSASSET_STREAM_RESPONSE_BODY
+    Segment.Stream = MakeShared<FAssetResponseStream>(FileWriter.ToSharedRef(), StartByte, EndByte - StartByte + 1, DownloadFileSize);
+    Segment.Stream->SetRequest(Segment.Request);
+    Segment.Request->SetResponseBodyReceiveStream(Segment.Stream.ToSharedRef());
+#endif
+    Segment.Request->ProcessRequest();
+    return true;
 }
 
 void UAssetDownloader::HandleChunkDownloadComplete(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful)
 {
-    if (bIsPaused)
+    // Requests cancelled by pause/cancel are no longer tracked and are ignored here 暂停或取消后的请求不再跟踪，直接忽略
+    const int32 SegmentIndex = ActiveSegments.IndexOfByPredicate([&Request](const FDownloadSegment& Segment)
+    {
+        return Segment.Request == Request;
+    });
+    if (SegmentIndex == INDEX_NONE || bIsPaused || bHasFailed)
     {
         return;
     }
+
+    FDownloadSegment Segment = ActiveSegments[SegmentIndex];
+    ActiveSegments.RemoveAtSwap(SegmentIndex);
     
-    if (bWasSuccessful && Response->GetResponseCode() == 206)
+    // The range must be the one asked for, of the file whose size we know 返回的范围和文件大小必须与请求一致
+    int64 RangeStart = -1;
+    int64 RangeEnd = -1;
+    int64 TotalSize = -1;
+    const bool bIsExpectedRange = bWasSuccessful && Response.IsValid() && Response->GetResponseCode() == 206
+        && FAssetResponseStream::ParseContentRange(Response->GetHeader(TEXT("Content-Range")), RangeStart, RangeEnd, TotalSize)
+        && RangeStart == Segment.StartByte
+        && (TotalSize < 0 || TotalSize == DownloadFileSize);
+
+#if RSASSET_STREAM_RESPONSE_BODY
+    // The stream decided on its own whether the body belongs into the file 数据流自行判断响应体是否应写入文件
+    const bool bIsBodyReceived = Segment.Stream.IsValid() && !Segment.Stream->WasRejected() && Segment.Stream->GetReceivedBytes() > 0;
+#else
+    const bool bIsBodyReceived = bIsExpectedRange && Response->GetContent().Num() > 0;
+#endif
+
+    if (bIsExpectedRange && bIsBodyReceived && FileWriter.IsValid())
     {
-        FString FilePath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("RspaceAssetsLibrary"), DownloadFileName);
+        const int64 ExpectedBytes = Segment.EndByte - Segment.StartByte + 1;
+#if RSASSET_STREAM_RESPONSE_BODY
+        // The body went to the writer while it arrived, only the last buffer is left 响应体接收时已交给写线程，只剩最后一块缓冲
+        Segment.Stream->Flush();
+        const int64 ReceivedBytes = Segment.Stream->GetReceivedBytes();
+#else
+        // The buffered body is written at its own offset once the range passed its checks 缓存的响应体通过检查后写入各自的偏移位置
         const TArray<uint8>& ChunkData = Response->GetContent();
+        const int64 ReceivedBytes = FMath::Min<int64>(ChunkData.Num(), ExpectedBytes);
+        FileWriter->EnqueueWrite(Segment.StartByte, TArray<uint8>(ChunkData.GetData(), (int32)ReceivedBytes));
+#endif
+
+        // Only a checked range is journaled and hashed, once its bytes are on disk 只有通过检查的范围在写入磁盘后才记录和计算哈希
+        FileWriter->CommitRange(Segment.StartByte, ReceivedBytes);
+        PendingCommits++;
+
+        DownloadedBytes += ReceivedBytes;
+        CurrentChunk++;
+        UpdateChunkSize(ReceivedBytes, FPlatformTime::Seconds() - Segment.IssueTime);
+        RecordReceivedBytes(Segment.IssueTime, Segment.ReportedBytes, ReceivedBytes);
+        Stats.RangeLatency.AddSample(FPlatformTime::Seconds() - Segment.IssueTime);
+
+        // A short body leaves the rest of the range to be fetched again 响应不完整时剩余部分重新下载
+        if (ReceivedBytes < ExpectedBytes)
+        {
+            PendingRanges.Add(TPair<int64, int64>(Segment.StartByte + ReceivedBytes, Segment.EndByte));
+        }
 
-        IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
-        IFileHandle* FileHandle = PlatformFile.OpenWrite(*FilePath, true);
-        if (FileHandle)
+        float Progress = (float)DownloadedBytes / (float)DownloadFileSize;
+        if (OnDownloadProgress.IsBound())
         {
-            //UE_LOG(LogTemp, Error, TEXT("Failed to open file for writing chunk data!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!!"));
-            FileHandle->Seek(DownloadedBytes);
-            FileHandle->Write(ChunkData.GetData(), ChunkData.Num());
-            delete FileHandle;
+            OnDownloadProgress.Execute(Progress, DownloadedBytes, DownloadFileSize, CurrentChunkSize);
+        }
 
-            DownloadedBytes += ChunkData.Num();
-            CurrentChunk++;
+        DownloadNextChunk();
+    }
+    else
+    {
+       // UE_LOG(LogTemp, Error, TEXT("Chunk download failed."));
+        if (TotalSize >= 0 && TotalSize != DownloadFileSize)
+        {
+            // The file changed on the server, the partial download cannot be resumed 服务器上的文件已变化，已下载部分无法续传
+            Journal = FDownloadJournal();
+            DeleteJournal();
+        }
+        else if ((IsRetryableFailure(bWasSuccessful, Response) || bIsExpectedRange) && Segment.RetryCount < MaxRetriesPerRange)
+        {
+            // Only the failed range is fetched again, the other ranges keep going 只重新下载失败的分段，其他分段继续
+            FDownloadRetryRange& Retry = RetryRanges.AddDefaulted_GetRef();
+            Retry.StartByte = Segment.StartByte;
+            Retry.EndByte = Segment.EndByte;
+            Retry.RetryCount = Segment.RetryCount + 1;
+            const float Delay = GetRetryDelay(Segment.RetryCount);
+            Retry.ReadyTime = FPlatformTime::Seconds() + Delay;
+            RetryCount++;
+            Stats.RecordRetry();
+            UE_LOG(LogTemp, Warning, TEXT("Range %lld-%lld of %s failed, retry %d in %.1f s."), Segment.StartByte, Segment.EndByte, *DownloadFileName, Retry.RetryCount, Delay);
 
-            float Progress = (float)DownloadedBytes / (float)DownloadFileSize;
-            if (OnDownloadProgress.IsBound())
-            {
-                OnDownloadProgress.Execute(Progress, DownloadedBytes, DownloadFileSize);
-            }
+            // A failure is treated like a loss in TCP and halves the range size 失败视为丢包，分段大小减半
+            bInSlowStart = false;
+            CurrentChunkSize = FMath::Max(MinChunkSize, CurrentChunkSize / 2);
 
+            ScheduleDownloadNextChunk(Delay);
             DownloadNextChunk();
-            
+            return;
         }
-        else
+        BroadcastDownloadError();
+    }
+}
+
+void UAssetDownloader::BindRequestProgress(FHttpRequestPtr Request)
+{
+#if UE_VERSION_OLDER_THAN(5, 4, 0)
+    Request->OnRequestProgress().BindWeakLambda(this, [this](FHttpRequestPtr InRequest, int32 BytesSent, int32 BytesReceived)
+#else
+    Request->OnRequestProgress64().BindWeakLambda(this, [this](FHttpRequestPtr InRequest, uint64 BytesSent, uint64 BytesReceived)
+#endif
+    {
+        HandleRequestProgress(InRequest, (int64)BytesReceived);
+    });
+}
+
+void UAssetDownloader::HandleRequestProgress(FHttpRequestPtr Request, int64 BytesReceived)
+{
+    if (Request == HttpRequest)
+    {
+        RecordReceivedBytes(FirstRangeIssueTime, FirstRangeReportedBytes, BytesReceived);
+        return;
+    }
+
+    FDownloadSegment* Segment = ActiveSegments.FindByPredicate([&Request](const FDownloadSegment& ActiveSegment)
+    {
+        return ActiveSegment.Request == Request;
+    });
+    if (Segment)
+    {
+        RecordReceivedBytes(Segment->IssueTime, Segment->ReportedBytes, BytesReceived);
+    }
+}
+
+void UAssetDownloader::RecordReceivedBytes(double IssueTime, int64& ReportedBytes, int64 BytesReceived)
+{
+    // Bytes are counted as they arrive, so throughput does not jump at the end of each range 数据到达时即计入，吞吐量不会在分段结束时跳变
+    if (BytesReceived <= ReportedBytes)
+    {
+        return;
+    }
+
+    const double Now = FPlatformTime::Seconds();
+    if (ReportedBytes == 0)
+    {
+        Stats.TimeToFirstByte.AddSample(Now - IssueTime);
+    }
+    Stats.RecordBytes(BytesReceived - ReportedBytes, Now);
+    ReportedBytes = BytesReceived;
+}
+
+const FAssetDownloadStats& UAssetDownloader::GetStats()
+{
+    Stats.UpdateThroughput(FPlatformTime::Seconds());
+    return Stats;
+}
+
+bool UAssetDownloader::IsRetryableFailure(bool bWasSuccessful, FHttpResponsePtr Response)
+{
+    // Dropped connections, timeouts, throttling and server errors may pass; other answers will not 连接中断、超时、限流和服务器错误可以重试
+    if (!bWasSuccessful || !Response.IsValid())
+    {
+        return true;
+    }
+    const int32 ResponseCode = Response->GetResponseCode();
+    return ResponseCode == 408 || ResponseCode == 429 || ResponseCode >= 500;
+}
+
+float UAssetDownloader::GetRetryDelay(int32 Attempt) const
+{
+    // Jitter keeps ranges that failed together from retrying together 抖动避免同时失败的分段同时重试
+    const float Backoff = FMath::Min(RetryMaxDelay, RetryBaseDelay * FMath::Pow(2.0f, (float)FMath::Min(Attempt, 16)));
+    return Backoff * FMath::FRandRange(0.5f, 1.0f);
+}
+
+void UAssetDownloader::ScheduleDownloadNextChunk(float Delay)
+{
+    // An earlier wake-up already covers this one 已有更早的唤醒时无需再次调度
+    const double WakeUpTime = FPlatformTime::Seconds() + Delay;
+    if (ScheduledWakeUpTime > 0.0 && ScheduledWakeUpTime <= WakeUpTime)
+    {
+        return;
+    }
+    ScheduledWakeUpTime = WakeUpTime;
+
+    TWeakObjectPtr<UAssetDownloader> WeakThis(this);
+    FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([WeakThis, WakeUpTime](float DeltaTime)
+    {
+        if (UAssetDownloader* Downloader = WeakThis.Get())
         {
-            //UE_LOG(LogTemp, Error, TEXT("Failed to open file for writing chunk data."));
-            if (OnDownloadError.IsBound())
+            if (Downloader->ScheduledWakeUpTime == WakeUpTime)
             {
-                OnDownloadError.Execute();
+                Downloader->ScheduledWakeUpTime = 0.0;
             }
+            Downloader->DownloadNextChunk();
         }
+        return false;
+    }), Delay);
+}
+
+void UAssetDownloader::HandleChunkWriteFlushed(int64 Offset, int64 NumBytes, bool bSuccess, int32 Generation)
+{
+    // Late reports of a writer that was already replaced are ignored 忽略已被替换的写线程的迟到通知
+    if (bHasFailed || Generation != FileWriterGeneration)
+    {
+        return;
+    }
+
+    if (!bSuccess)
+    {
+        //UE_LOG(LogTemp, Error, TEXT("Failed to write chunk data at offset %lld."), Offset);
+        BroadcastDownloadError();
+        return;
+    }
+
+    // A flush frees room for new ranges, but only a commit journals them 写入后可发起新的分段，但只有提交后才记录到日志
+    FlushedBytes += NumBytes;
+    DownloadNextChunk();
+}
+
+void UAssetDownloader::HandleRangeCommitted(int64 Offset, int64 NumBytes, int32 Generation)
+{
+    if (bHasFailed || Generation != FileWriterGeneration)
+    {
+        return;
+    }
+
+    PendingCommits--;
+    Journal.AddCompletedRange(Offset, Offset + NumBytes - 1);
+    SaveJournal(false);
+    DownloadNextChunk();
+}
+
+void UAssetDownloader::CloseFileWriter()
+{
+    if (FileWriter.IsValid())
+    {
+        FileWriter->Close();
+        FileWriter.Reset();
+
+        // Reports still on their way to the game thread belong to the closed writer 仍在发往游戏线程的通知属于已关闭的写线程
+        FileWriterGeneration++;
+    }
+}
+
+bool UAssetDownloader::VerifyDownloadedFile()
+{
+    if (!FileWriter.IsValid())
+    {
+        return true;
+    }
+
+    // The file is preallocated, so its size says nothing; only the journal knows which bytes arrived 文件已预分配，大小无法说明问题；只有日志记录了哪些字节已写入
+    FileWriter->Close();
+    const TArray<TPair<int64, int64>> MissingRanges = Journal.GetMissingRanges();
+    if (MissingRanges.Num() > 0)
+    {
+        UE_LOG(LogTemp, Error, TEXT("%s is incomplete: %lld of %lld bytes were written, first gap at %lld."),
+            *DownloadFileName, Journal.GetCompletedBytes(), DownloadFileSize, MissingRanges[0].Key);
+        return false;
+    }
+
+    if (DownloadMD5.IsEmpty())
+    {
+        return true;
+    }
+
+    // The writer thread hashed the chunks as they arrived; only unhashed gaps are read back 写线程已边写边计算，只回读未计算的空洞
+    FStreamingFileHasher& Hasher = FileWriter->GetHasher();
+    if (!Hasher.CatchUpFromFile(GetPartFilePath(), DownloadFileSize))
+    {
+        UE_LOG(LogTemp, Error, TEXT("Failed to read %s for MD5 verification."), *DownloadFileName);
+        return false;
+    }
+
+    const FString ActualMD5 = Hasher.Finalize();
+    if (!ActualMD5.Equals(DownloadMD5, ESearchCase::IgnoreCase))
+    {
+        UE_LOG(LogTemp, Error, TEXT("MD5 mismatch for %s: expected %s, got %s."), *DownloadFileName, *DownloadMD5, *ActualMD5);
+        return false;
+    }
+    return true;
+}
+
+FString UAssetDownloader::GetDownloadFilePath() const
+{
+    return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("RspaceAssetsLibrary"), DownloadFileName);
+}
+
+void UAssetDownloader::MigrateLegacyPartialFile()
+{
+    // Earlier versions wrote partial downloads under the final name 旧版本将未完成的下载直接写在最终文件名下
+    const FString LegacyJournalPath = FDownloadJournal::GetJournalPath(GetDownloadFilePath());
+    if (!FPaths::FileExists(LegacyJournalPath) || FPaths::FileExists(GetPartFilePath()))
+    {
+        return;
+    }
+
+    IFileManager& FileManager = IFileManager::Get();
+    if (FileManager.Move(*GetPartFilePath(), *GetDownloadFilePath(), true, true))
+    {
+        FileManager.Move(*FDownloadJournal::GetJournalPath(GetPartFilePath()), *LegacyJournalPath, true, true);
     }
     else
     {
-       // UE_LOG(LogTemp, Error, TEXT("Chunk download failed."));
-        if (OnDownloadError.IsBound())
+        FileManager.Delete(*LegacyJournalPath, false, true, true);
+    }
+}
+
+bool UAssetDownloader::RestoreFromJournal()
+{
+    const FString FilePath = GetPartFilePath();
+    FDownloadJournal SavedJournal;
+    if (!FPaths::FileExists(FilePath)
+        || !SavedJournal.Load(FDownloadJournal::GetJournalPath(FilePath))
+        || !SavedJournal.Matches(DownloadURL, DownloadFileSize, DownloadMD5))
+    {
+        return false;
+    }
+
+    Journal = MoveTemp(SavedJournal);
+    PendingRanges = Journal.GetMissingRanges();
+    NextRangeStart = DownloadFileSize;
+    DownloadedBytes = Journal.GetCompletedBytes();
+    return true;
+}
+
+void UAssetDownloader::SaveJournal(bool bForce)
+{
+    if (bIsCompleted || DownloadFileSize <= 0 || Journal.CompletedRanges.Num() == 0)
+    {
+        return;
+    }
+
+    // Throttled so that small chunks do not rewrite the journal constantly 限制保存频率
+    const double Now = FPlatformTime::Seconds();
+    if (bForce || Now - LastJournalSaveTime >= JournalSaveInterval)
+    {
+        LastJournalSaveTime = Now;
+        Journal.Save(FDownloadJournal::GetJournalPath(GetPartFilePath()));
+    }
+}
+
+void UAssetDownloader::DeleteJournal()
+{
+    const FString JournalPath = FDownloadJournal::GetJournalPath(GetPartFilePath());
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    if (PlatformFile.FileExists(*JournalPath))
+    {
+        PlatformFile.DeleteFile(*JournalPath);
+    }
+}
+
+void UAssetDownloader::UpdateChunkSize(int64 SegmentBytes, double SegmentSeconds)
+{
+    if (SegmentBytes <= 0 || DownloadFileSize <= SingleRequestFileSize)
+    {
+        return;
+    }
+
+    // Bandwidth of this range, smoothed across ranges 本分段的带宽，并做平滑处理
+    const double BytesPerSecond = SegmentBytes / FMath::Max(SegmentSeconds, 0.001);
+    SmoothedBytesPerSecond = SmoothedBytesPerSecond <= 0.0
+        ? BytesPerSecond
+        : SmoothedBytesPerSecond * 0.75 + BytesPerSecond * 0.25;
+
+    int64 NewChunkSize = CurrentChunkSize;
+    if (bInSlowStart && SegmentSeconds < TargetSegmentSeconds)
+    {
+        // Per-request overhead still dominates: double the range size 请求开销仍占主导：分段大小翻倍
+        NewChunkSize = CurrentChunkSize * 2;
+    }
+    else
+    {
+        // Steer towards a range that takes about TargetSegmentSeconds 调整到约 TargetSegmentSeconds 完成一个分段
+        bInSlowStart = false;
+        const int64 IdealChunkSize = (int64)(SmoothedBytesPerSecond * TargetSegmentSeconds);
+        NewChunkSize = (CurrentChunkSize + IdealChunkSize) / 2;
+    }
+
+    // Keep ranges aligned to 64 KB 分段大小按 64 KB 对齐
+    NewChunkSize = FMath::Clamp<int64>(NewChunkSize, MinChunkSize, MaxChunkSize);
+    CurrentChunkSize = FMath::Max<int64>(MinChunkSize, NewChunkSize - NewChunkSize % DefaultMinChunkSize);
+}
+
+bool UAssetDownloader::IsDownloadFinished() const
+{
+    return NextRangeStart >= DownloadFileSize && PendingRanges.Num() == 0 && RetryRanges.Num() == 0 && ActiveSegments.Num() == 0;
+}
+
+void UAssetDownloader::CancelActiveSegments()
+{
+    // Move the interrupted ranges back so that resume fetches them again 将中断的分段退回，恢复时重新下载
+    TArray<FDownloadSegment> InterruptedSegments = MoveTemp(ActiveSegments);
+    ActiveSegments.Reset();
+
+    for (const FDownloadSegment& Segment : InterruptedSegments)
+    {
+        PendingRanges.Add(TPair<int64, int64>(Segment.StartByte, Segment.EndByte));
+        if (Segment.Request.IsValid() && Segment.Request->GetStatus() == EHttpRequestStatus::Processing)
         {
-            OnDownloadError.Execute();
+            Segment.Request->CancelRequest();
         }
     }
+    PendingRanges.Sort([](const TPair<int64, int64>& A, const TPair<int64, int64>& B)
+    {
+        return A.Key < B.Key;
+    });
+}
+
+void UAssetDownloader::BroadcastDownloadError()
+{
+    bHasFailed = true;
+    ReleaseCacheLock();
+    FAssetBandwidthLimiter::Get().CancelRequests(this);
+    bIsWaitingForBandwidth = false;
+    CancelActiveSegments();
+    SaveJournal(true);
+    if (OnDownloadError.IsBound())
+    {
+        OnDownloadError.Execute();
+    }
 }
 
 void UAssetDownloader::PauseDownload()
@@ -156,11 +1097,18 @@ void UAssetDownloader::PauseDownload()
     if (!bIsPaused)
     {
         bIsPaused = true;
+        FAssetBandwidthLimiter::Get().CancelRequests(this);
+        bIsWaitingForBandwidth = false;
         if (HttpRequest.IsValid() && HttpRequest->GetStatus() == EHttpRequestStatus::Processing)
         {
             HttpRequest->CancelRequest();
             //// UE_LOG(LogTemp, Log, TEXT("Download paused at byte: %lld."), DownloadedBytes);
         }
+        CancelActiveSegments();
+        SaveJournal(true);
+
+        // A paused download must not hold up other editor instances 暂停的下载不应阻塞其他编辑器实例
+        ReleaseCacheLock();
     }
 }
 
@@ -169,6 +1117,14 @@ void UAssetDownloader::ResumeDownload()
     if (bIsPaused)
     {
         bIsPaused = false;
+        Stats.Start(FPlatformTime::Seconds());
+
+        // Another instance may have taken over the content while paused 暂停期间其他实例可能已开始下载该内容
+        if (!bIsWaitingForSharedDownload && !AcquireCacheLock())
+        {
+            WaitForSharedDownload();
+            return;
+        }
         DownloadNextChunk();
     }
 }
@@ -176,47 +1132,49 @@ void UAssetDownloader::ResumeDownload()
 void UAssetDownloader::CancelDownload()
 {
     PauseDownload();
-    FString FilePath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("RspaceAssetsLibrary"), DownloadFileName);
+    PendingRanges.Reset();
+    RetryRanges.Reset();
+    CloseFileWriter();
+    DeleteJournal();
+    Journal = FDownloadJournal();
+    FString FilePath = GetPartFilePath();
     if (FPlatformFileManager::Get().GetPlatformFile().FileExists(*FilePath))
     {
         FPlatformFileManager::Get().GetPlatformFile().DeleteFile(*FilePath);
     }
 }
 
-// bool UAssetDownloader::CheckIfFileExistsWithMD5(const FString& FileName, const FString& MD5)
-// {
-//     FString CSVFilePath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("RspaceAssetsLibrary"), TEXT("AssetsManagement.csv"));
-//     FString CSVContent;
-//
-//     if (FFileHelper::LoadFileToString(CSVContent, *CSVFilePath))
-//     {
-//         TArray<FString> Lines;
-//         CSVContent.ParseIntoArrayLines(Lines);
-//
-//         for (const FString& Line : Lines)
-//         {
-//             TArray<FString> Tokens;
-//             Line.ParseIntoArray(Tokens, TEXT(","), true);
-//             if (Tokens.Num() == 2 && Tokens[0] == FileName && Tokens[1] == MD5)
-//             {
-//                 return true;
-//             }
-//         }
-//     }
-//     return false;
-// }
-
-// void UAssetDownloader::SaveToCSV(const FString& FileName, const FString& MD5)
-// {
-//     FString CSVFilePath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("RspaceAssetsLibrary"), TEXT("AssetsManagement.csv"));
-//     if (!FPlatformFileManager::Get().GetPlatformFile().FileExists(*CSVFilePath))
-//     {
-//         FFileHelper::SaveStringToFile(TEXT("FileName,MD5\n"), *CSVFilePath);
-//     }
-//
-//     FString CSVLine = FString::Printf(TEXT("%s,%s\n"), *FileName, *MD5);
-//     FFileHelper::SaveStringToFile(CSVLine, *CSVFilePath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM, &IFileManager::Get(), FILEWRITE_Append);
-// }
+void UAssetDownloader::BeginDestroy()
+{
+    FAssetBandwidthLimiter::Get().CancelRequests(this);
+    CloseFileWriter();
+    SaveJournal(true);
+    ReleaseCacheLock();
+    Super::BeginDestroy();
+}
+
+void UAssetDownloader::SetChunkSizeBounds(int64 InMinChunkSize, int64 InMaxChunkSize)
+{
+    MinChunkSize = FMath::Max<int64>(InMinChunkSize, DefaultMinChunkSize);
+    MaxChunkSize = FMath::Max<int64>(InMaxChunkSize, MinChunkSize);
+    CurrentChunkSize = FMath::Clamp<int64>(CurrentChunkSize, MinChunkSize, MaxChunkSize);
+}
+
+void UAssetDownloader::SetRetryPolicy(int32 InMaxRetriesPerRange, float InRetryBaseDelay, float InRetryMaxDelay)
+{
+    MaxRetriesPerRange = FMath::Max(InMaxRetriesPerRange, 0);
+    RetryBaseDelay = FMath::Max(InRetryBaseDelay, 0.0f);
+    RetryMaxDelay = FMath::Max(InRetryMaxDelay, RetryBaseDelay);
+}
+
+void UAssetDownloader::SetMaxConcurrentSegments(int32 InMaxConcurrentSegments)
+{
+    MaxConcurrentSegments = FMath::Clamp(InMaxConcurrentSegments, 1, MaxAllowedConcurrentSegments);
+    if (!bIsPaused && DownloadFileSize > 0)
+    {
+        DownloadNextChunk();
+    }
+}
 
 void UAssetDownloader::SetOnDownloadProgress(FOnDownloadProgress InOnDownloadProgress)
 {
@@ -231,4 +1189,9 @@ void UAssetDownloader::SetOnDownloadComplete(FOnDownloadComplete InOnDownloadCom
 void UAssetDownloader::SetOnDownloadError(FOnDownloadError InOnDownloadError)
 {
     OnDownloadError = InOnDownloadError;
+}
+
+void UAssetDownloader::SetOnFileAlreadyDownloaded(FOnFileAlreadyDownloaded InOnFileAlreadyDownloaded)
+{
+    OnFileAlreadyDownloaded = InOnFileAlreadyDownloaded;
 }
\ No newline at end of file
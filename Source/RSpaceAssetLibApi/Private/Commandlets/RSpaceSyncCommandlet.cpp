@@ -0,0 +1,365 @@
+﻿// Copyright (c) 2024 Hunan MangoXR Tech Co., Ltd. All Rights Reserved.
+
+#include "Commandlets/RSpaceSyncCommandlet.h"
+#include "AudioLibrary/GetAudioFileByConditionApi.h"
+#include "AudioLibrary/GetAudioFileDetailApi.h"
+#include "ConceptDesignLibrary/GetConceptDesignLibMenuApi.h"
+#include "Downloader/AssetDownloadBatch.h"
+#include "Downloader/AssetContentStore.h"
+#include "Downloader/AssetDownloadSubsystem.h"
+#include "HttpModule.h"
+#include "HttpManager.h"
+#include "Containers/Ticker.h"
+#include "Async/TaskGraphInterfaces.h"
+#include "Misc/FileHelper.h"
+#include "Misc/SecureHash.h"
+
+URSpaceSyncCommandlet::URSpaceSyncCommandlet()
+{
+    IsClient = false;
+    IsEditor = true;
+    IsServer = false;
+    LogToConsole = true;
+}
+
+int32 URSpaceSyncCommandlet::Main(const FString& Params)
+{
+    UAssetDownloadSubsystem* Subsystem = UAssetDownloadSubsystem::Get();
+    if (!Subsystem)
+    {
+        UE_LOG(LogTemp, Error, TEXT("RSpaceSync: the download subsystem is not available."));
+        return 1;
+    }
+
+    if (!FParse::Value(*Params, TEXT("Project="), ProjectNo) || ProjectNo.IsEmpty() || !ReadCredentials(Params))
+    {
+        UE_LOG(LogTemp, Error, TEXT("Usage: -run=RSpaceSync -Project=<projectNo> [-Ticket=<ticket> -Uuid=<uuid> | -CredentialsFile=<path>] [-Libraries=Model,Video,Audio,Concept] [-Parallel=10]"));
+        return 1;
+    }
+
+    int32 Parallel = UAssetDownloadSubsystem::DefaultMaxConcurrentDownloads;
+    FParse::Value(*Params, TEXT("Parallel="), Parallel);
+    Subsystem->SetMaxConcurrentDownloads(FMath::Max(1, Parallel));
+
+    FString LibrariesParam = TEXT("Model,Video,Audio,Concept");
+    FParse::Value(*Params, TEXT("Libraries="), LibrariesParam);
+    TArray<FString> Libraries;
+    LibrariesParam.ParseIntoArray(Libraries, TEXT(","));
+
+    const double StartTime = FPlatformTime::Seconds();
+    const FAssetDownloadFileFilter FileFilter = FAssetDownloadFileFilter::CreateUObject(this, &URSpaceSyncCommandlet::ShouldDownloadFile);
+
+    // Model and video folders are walked by folder batches from the root down 模型和视频库由文件夹批次从根目录向下遍历
+    if (Libraries.Contains(TEXT("Model")))
+    {
+        if (UAssetDownloadBatch* Batch = Subsystem->EnqueueModelFolder(Ticket, Uuid, ProjectNo, 0, TEXT("Models"), EAssetDownloadPriority::Normal, FileFilter))
+        {
+            Batches.Add(Batch);
+        }
+    }
+    if (Libraries.Contains(TEXT("Video")))
+    {
+        if (UAssetDownloadBatch* Batch = Subsystem->EnqueueVideoFolder(Ticket, ProjectNo, TEXT("-1"), TEXT("Videos"), EAssetDownloadPriority::Normal, FileFilter))
+        {
+            Batches.Add(Batch);
+        }
+    }
+    if (Libraries.Contains(TEXT("Audio")))
+    {
+        ListAudioPage(1);
+    }
+    if (Libraries.Contains(TEXT("Concept")))
+    {
+        ListConceptPage(1);
+    }
+
+    // Without the editor loop the HTTP manager, tickers and game thread tasks are pumped here 没有编辑器主循环，这里手动驱动 HTTP、Ticker 和游戏线程任务
+    double LastTime = FPlatformTime::Seconds();
+    while (!IsSyncFinished() && !IsEngineExitRequested())
+    {
+        const double Now = FPlatformTime::Seconds();
+        const float DeltaTime = (float)(Now - LastTime);
+        LastTime = Now;
+
+        FHttpModule::Get().GetHttpManager().Tick(DeltaTime);
+        FTSTicker::GetCoreTicker().Tick(DeltaTime);
+        FTaskGraphInterface::Get().ProcessThreadUntilIdle(ENamedThreads::GameThread);
+        ExpireListings();
+
+        FPlatformProcess::Sleep(0.01f);
+    }
+
+    PrintSummary(FPlatformTime::Seconds() - StartTime);
+
+    const bool bAnyFailed = NumFailedListings > 0
+        || Jobs.ContainsByPredicate([](const UAssetDownloadJob* Job) { return Job->GetState() == EAssetDownloadState::Failed; })
+        || Batches.ContainsByPredicate([](const UAssetDownloadBatch* Batch) { return Batch->GetNumFailedFiles() > 0 || Batch->GetNumFailedFolders() > 0; });
+    return bAnyFailed ? 1 : 0;
+}
+
+bool URSpaceSyncCommandlet::ReadCredentials(const FString& Params)
+{
+    if (FParse::Value(*Params, TEXT("Ticket="), Ticket))
+    {
+        FParse::Value(*Params, TEXT("Uuid="), Uuid);
+        return !Ticket.IsEmpty();
+    }
+
+    // The editor keeps the ticket in memory only, so unattended runs read it from a file 编辑器只在内存中保存 ticket，无人值守时从文件读取
+    FString CredentialsFile = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("RspaceAssetsLibrary"), TEXT("SyncCredentials.ini"));
+    FParse::Value(*Params, TEXT("CredentialsFile="), CredentialsFile);
+
+    FString Credentials;
+    if (!FFileHelper::LoadFileToString(Credentials, *CredentialsFile))
+    {
+        UE_LOG(LogTemp, Error, TEXT("RSpaceSync: no -Ticket given and %s could not be read."), *CredentialsFile);
+        return false;
+    }
+
+    TArray<FString> Lines;
+    Credentials.ParseIntoArrayLines(Lines);
+    for (const FString& Line : Lines)
+    {
+        FParse::Value(*Line, TEXT("Ticket="), Ticket);
+        FParse::Value(*Line, TEXT("Uuid="), Uuid);
+    }
+    return !Ticket.IsEmpty();
+}
+
+void URSpaceSyncCommandlet::ListAudioPage(int32 Page)
+{
+    UGetAudioFileByConditionApi* AudioListing = NewObject<UGetAudioFileByConditionApi>(this);
+    AddListing(AudioListing);
+
+    // Menu type 1 lists every audio file of the project regardless of folder 菜单类型 1 列出项目中全部音频文件，不区分文件夹
+    AudioListing->SendGetAudioFileByConditionRequest(Ticket, Uuid, ProjectNo, FString(), FString(), FString(), FString(), 0, 0,
+        Page, FString(), 1, AudioPageSize, FString(), TEXT("DESC"), TEXT("1"), 0,
+        FOnGetAudioFileByConditionResponse::CreateUObject(this, &URSpaceSyncCommandlet::HandleAudioPageListed, Page, (UObject*)AudioListing));
+}
+
+void URSpaceSyncCommandlet::HandleAudioPageListed(const FGetAudioFileByConditionResponse& Response, int32 Page, UObject* ListingRequest)
+{
+    if (!FinishListing(ListingRequest))
+    {
+        return;
+    }
+
+    PendingAudioDetails.Append(Response.data.dataList);
+    if (Response.data.CurPage > 0 && Response.data.CurPage < Response.data.TotalPage)
+    {
+        ListAudioPage(Page + 1);
+    }
+    ListPendingAudioDetails();
+}
+
+void URSpaceSyncCommandlet::ListPendingAudioDetails()
+{
+    // The audio list carries no MD5, each file's detail is fetched for it 音频列表不含 MD5，逐个获取文件详情
+    while (PendingListings.Num() < MaxConcurrentListings && PendingAudioDetails.Num() > 0)
+    {
+        const FAudioFileData AudioFile = PendingAudioDetails.Pop(false);
+        const int64 ListedSize = AudioFile.FileSize.IsNumeric() ? FCString::Atoi64(*AudioFile.FileSize) : 0;
+
+        UGetAudioFileDetailApi* DetailListing = NewObject<UGetAudioFileDetailApi>(this);
+        AddListing(DetailListing);
+        DetailListing->SendGetAudioFileDetailRequest(Ticket, AudioFile.FileNo,
+            FOnGetAudioFileDetailResponse::CreateUObject(this, &URSpaceSyncCommandlet::HandleAudioDetailListed, ListedSize, (UObject*)DetailListing));
+    }
+}
+
+void URSpaceSyncCommandlet::HandleAudioDetailListed(const FAudioFileDetailData& Detail, int64 ListedSize, UObject* ListingRequest)
+{
+    if (FinishListing(ListingRequest) && !Detail.RelativePath.IsEmpty())
+    {
+        QueueFile(Detail.FileName, Detail.RelativePath, Detail.FileMd5, ListedSize);
+    }
+    ListPendingAudioDetails();
+}
+
+void URSpaceSyncCommandlet::ListConceptPage(int32 Page)
+{
+    UGetConceptDesignLibMenuApi* ConceptListing = NewObject<UGetConceptDesignLibMenuApi>(this);
+    AddListing(ConceptListing);
+
+    // Menu type 0 with no folder lists every picture of the project 菜单类型 0 且不指定文件夹时列出项目全部图片
+    ConceptListing->SendGetConceptDesignLibMenuRequest(Ticket, Page, FString(), 0, ConceptPageSize, FString(), ProjectNo, FString(), FString(), Uuid,
+        FOnGetConceptDesignLibMenuResponse::CreateUObject(this, &URSpaceSyncCommandlet::HandleConceptPageListed, Page, (UObject*)ConceptListing));
+}
+
+void URSpaceSyncCommandlet::HandleConceptPageListed(FGetConceptDesignLibMenuData* MenuData, int32 Page, UObject* ListingRequest)
+{
+    if (!FinishListing(ListingRequest) || !MenuData)
+    {
+        return;
+    }
+
+    for (const FFileItemDetails& ConceptItem : MenuData->data.items)
+    {
+        if (!ConceptItem.relativePatch.IsEmpty())
+        {
+            const int64 ListedSize = ConceptItem.fileSize.IsNumeric() ? FCString::Atoi64(*ConceptItem.fileSize) : 0;
+            QueueFile(ConceptItem.name, ConceptItem.relativePatch, ConceptItem.fileMd5, ListedSize);
+        }
+    }
+
+    if (MenuData->data.items.Num() > 0 && (int64)Page * ConceptPageSize < MenuData->data.total)
+    {
+        ListConceptPage(Page + 1);
+    }
+}
+
+void URSpaceSyncCommandlet::AddListing(UObject* ListingRequest)
+{
+    PendingListings.Add(ListingRequest, FPlatformTime::Seconds());
+}
+
+bool URSpaceSyncCommandlet::FinishListing(UObject* ListingRequest)
+{
+    // A response arriving after its listing expired is ignored 列举超时后才到达的响应直接忽略
+    return PendingListings.Remove(ListingRequest) > 0;
+}
+
+void URSpaceSyncCommandlet::ExpireListings()
+{
+    // Audio and concept requests do not report failures, so a missing answer times out 音频和原画请求失败时不会回调，无响应时按超时处理
+    const double Now = FPlatformTime::Seconds();
+    bool bExpired = false;
+    for (auto It = PendingListings.CreateIterator(); It; ++It)
+    {
+        if (Now - It.Value() > ListingTimeout)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("RSpaceSync: %s got no answer within %.0f s."), *It.Key()->GetClass()->GetName(), ListingTimeout);
+            NumFailedListings++;
+            It.RemoveCurrent();
+            bExpired = true;
+        }
+    }
+
+    if (bExpired)
+    {
+        ListPendingAudioDetails();
+    }
+}
+
+bool URSpaceSyncCommandlet::ShouldDownloadFile(const FString& FileName, const FString& URL, const FString& MD5, int64 ListedSize)
+{
+    // The mirror is flat, so a second file with the same name would overwrite the first 镜像目录是平铺的，同名的第二个文件会覆盖第一个
+    if (const FString* FirstURL = MirroredFileURLs.Find(FileName))
+    {
+        if (*FirstURL != URL)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("RSpaceSync: skipping %s, its name is already used by %s."), *URL, **FirstURL);
+            NumNameCollisions++;
+        }
+        return false;
+    }
+    MirroredFileURLs.Add(FileName, URL);
+
+    const FString FilePath = FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("RspaceAssetsLibrary"), FileName);
+    const int64 LocalSize = IFileManager::Get().FileSize(*FilePath);
+    if (MD5.IsEmpty())
+    {
+        // Without an MD5 a local file of the listed size counts as up to date 没有 MD5 时，大小与列表一致的本地文件视为最新
+        if (LocalSize >= 0 && ListedSize > 0 && LocalSize == ListedSize)
+        {
+            NumSkippedFiles++;
+            SkippedBytes += LocalSize;
+            return false;
+        }
+        return true;
+    }
+
+    // A local copy with the listed MD5 is kept and added to the content store 本地已有相同 MD5 的文件时保留，并登记到内容仓库
+    if (LocalSize >= 0 && (ListedSize <= 0 || LocalSize == ListedSize)
+        && LexToString(FMD5Hash::HashFile(*FilePath)).Equals(MD5, ESearchCase::IgnoreCase))
+    {
+        FAssetContentStore::Get().AddFile(MD5, FilePath);
+        NumSkippedFiles++;
+        SkippedBytes += LocalSize;
+        return false;
+    }
+
+    if (FAssetContentStore::Get().MaterializeTo(MD5, FilePath))
+    {
+        NumSkippedFiles++;
+        SkippedBytes += IFileManager::Get().FileSize(*FilePath);
+        return false;
+    }
+    return true;
+}
+
+void URSpaceSyncCommandlet::QueueFile(const FString& FileName, const FString& URL, const FString& MD5, int64 ListedSize)
+{
+    UAssetDownloadSubsystem* Subsystem = UAssetDownloadSubsystem::Get();
+    if (!Subsystem || !ShouldDownloadFile(FileName, URL, MD5, ListedSize))
+    {
+        return;
+    }
+
+    if (UAssetDownloadJob* Job = Subsystem->EnqueueDownload(URL, FileName, MD5))
+    {
+        Jobs.AddUnique(Job);
+    }
+}
+
+bool URSpaceSyncCommandlet::IsSyncFinished() const
+{
+    if (PendingListings.Num() > 0 || PendingAudioDetails.Num() > 0)
+    {
+        return false;
+    }
+
+    for (const UAssetDownloadBatch* Batch : Batches)
+    {
+        if (!Batch->IsFinished())
+        {
+            return false;
+        }
+    }
+
+    for (const UAssetDownloadJob* Job : Jobs)
+    {
+        if (!Job->IsFinished() && Job->GetState() != EAssetDownloadState::Failed)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+void URSpaceSyncCommandlet::PrintSummary(double Elapsed) const
+{
+    int32 NumDownloaded = 0;
+    int32 NumFailed = NumFailedListings;
+    int64 DownloadedBytes = 0;
+
+    for (const UAssetDownloadJob* Job : Jobs)
+    {
+        if (Job->GetState() == EAssetDownloadState::Completed)
+        {
+            NumDownloaded++;
+            DownloadedBytes += Job->GetTotalBytes();
+        }
+        else if (Job->GetState() == EAssetDownloadState::Failed)
+        {
+            NumFailed++;
+        }
+    }
+
+    for (const UAssetDownloadBatch* Batch : Batches)
+    {
+        NumDownloaded += Batch->GetNumCompletedFiles();
+        NumFailed += Batch->GetNumFailedFiles() + Batch->GetNumFailedFolders();
+        DownloadedBytes += Batch->GetDownloadedBytes();
+    }
+
+    const double MB = 1024.0 * 1024.0;
+    UE_LOG(LogTemp, Display, TEXT("RSpaceSync: %d files downloaded (%.1f MB), %d skipped (%.1f MB already on disk), %d failed."),
+        NumDownloaded, DownloadedBytes / MB, NumSkippedFiles, SkippedBytes / MB, NumFailed);
+    if (NumNameCollisions > 0)
+    {
+        UE_LOG(LogTemp, Warning, TEXT("RSpaceSync: %d files not mirrored because another file already uses their name."), NumNameCollisions);
+    }
+    UE_LOG(LogTemp, Display, TEXT("RSpaceSync: finished in %.1f s (%.2f MB/s)."),
+        Elapsed, Elapsed > 0.0 ? DownloadedBytes / MB / Elapsed : 0.0);
+}
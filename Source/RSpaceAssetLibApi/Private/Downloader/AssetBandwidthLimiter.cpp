@@ -0,0 +1,126 @@
+﻿// Copyright (c) 2024 Hunan MangoXR Tech Co., Ltd. All Rights Reserved.
+
+#include "Downloader/AssetBandwidthLimiter.h"
+
+FAssetBandwidthLimiter& FAssetBandwidthLimiter::Get()
+{
+    static FAssetBandwidthLimiter Instance;
+    return Instance;
+}
+
+FAssetBandwidthLimiter::~FAssetBandwidthLimiter()
+{
+    if (TickerHandle.IsValid())
+    {
+        FTSTicker::GetCoreTicker().RemoveTicker(TickerHandle);
+    }
+}
+
+void FAssetBandwidthLimiter::SetBandwidthLimit(int64 InBytesPerSecond)
+{
+    Refill();
+    const bool bWasLimited = IsLimited();
+    BytesPerSecond = FMath::Max<int64>(0, InBytesPerSecond);
+
+    // A new cap starts with a full bucket 新设置的限速从满令牌桶开始
+    Tokens = bWasLimited ? FMath::Min<double>(Tokens, (double)BytesPerSecond) : (double)BytesPerSecond;
+    GrantWaitingRequests();
+}
+
+bool FAssetBandwidthLimiter::RequestBytes(const void* Owner, int64 NumBytes, float Weight, FOnBandwidthGranted OnGranted)
+{
+    if (!IsLimited())
+    {
+        return true;
+    }
+
+    Refill();
+    const double FinishTag = MakeFinishTag(Owner, NumBytes, Weight);
+
+    // The bucket may go into debt so that ranges larger than the tokens left are not starved 允许令牌透支，避免大分段一直等待
+    if (WaitingRequests.Num() == 0 && Tokens > 0.0)
+    {
+        Tokens -= (double)NumBytes;
+        VirtualTime = FinishTag;
+        return true;
+    }
+
+    FWaitingRequest& Request = WaitingRequests.AddDefaulted_GetRef();
+    Request.Owner = Owner;
+    Request.NumBytes = NumBytes;
+    Request.FinishTag = FinishTag;
+    Request.OnGranted = OnGranted;
+
+    if (!TickerHandle.IsValid())
+    {
+        TickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FAssetBandwidthLimiter::Tick));
+    }
+    return false;
+}
+
+void FAssetBandwidthLimiter::CancelRequests(const void* Owner)
+{
+    WaitingRequests.RemoveAll([Owner](const FWaitingRequest& Request) { return Request.Owner == Owner; });
+    LastFinishTags.Remove(Owner);
+}
+
+bool FAssetBandwidthLimiter::Tick(float DeltaTime)
+{
+    Refill();
+    GrantWaitingRequests();
+
+    if (WaitingRequests.Num() == 0)
+    {
+        TickerHandle.Reset();
+        return false;
+    }
+    return true;
+}
+
+void FAssetBandwidthLimiter::Refill()
+{
+    const double Now = FPlatformTime::Seconds();
+    if (LastRefillTime > 0.0)
+    {
+        Tokens = FMath::Min<double>(Tokens + (Now - LastRefillTime) * (double)BytesPerSecond, (double)BytesPerSecond);
+    }
+    LastRefillTime = Now;
+}
+
+void FAssetBandwidthLimiter::GrantWaitingRequests()
+{
+    while (WaitingRequests.Num() > 0 && (!IsLimited() || Tokens > 0.0))
+    {
+        // Smallest finish tag first 完成标记最小的请求优先
+        int32 NextIndex = 0;
+        for (int32 Index = 1; Index < WaitingRequests.Num(); ++Index)
+        {
+            if (WaitingRequests[Index].FinishTag < WaitingRequests[NextIndex].FinishTag)
+            {
+                NextIndex = Index;
+            }
+        }
+
+        FWaitingRequest Request = MoveTemp(WaitingRequests[NextIndex]);
+        WaitingRequests.RemoveAt(NextIndex);
+
+        if (IsLimited())
+        {
+            Tokens -= (double)Request.NumBytes;
+        }
+        VirtualTime = FMath::Max(VirtualTime, Request.FinishTag);
+        Request.OnGranted.ExecuteIfBound(Request.NumBytes);
+    }
+
+    if (WaitingRequests.Num() == 0)
+    {
+        LastFinishTags.Reset();
+    }
+}
+
+double FAssetBandwidthLimiter::MakeFinishTag(const void* Owner, int64 NumBytes, float Weight)
+{
+    double& LastFinishTag = LastFinishTags.FindOrAdd(Owner, 0.0);
+    LastFinishTag = FMath::Max(VirtualTime, LastFinishTag) + (double)NumBytes / FMath::Max(Weight, 0.01f);
+    return LastFinishTag;
+}
@@ -0,0 +1,105 @@
+﻿// Copyright (c) 2024 Hunan MangoXR Tech Co., Ltd. All Rights Reserved.
+
+#include "Downloader/AssetCacheLock.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformProcess.h"
+#include "Misc/App.h"
+#include "Misc/Paths.h"
+
+#if PLATFORM_WINDOWS
+#include "Windows/AllowWindowsPlatformTypes.h"
+#include <windows.h>
+#include "Windows/HideWindowsPlatformTypes.h"
+#elif PLATFORM_UNIX || PLATFORM_MAC
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    // Written into the lock file so that a person can tell who is downloading 写入锁文件，便于查看是谁在下载
+    FString MakeOwnerMarker()
+    {
+        return FString::Printf(TEXT("Pid=%u\nProject=%s\nStarted=%s\n"),
+            FPlatformProcess::GetCurrentProcessId(), FApp::GetProjectName(), *FDateTime::UtcNow().ToIso8601());
+    }
+}
+
+TUniquePtr<FAssetCacheLock> FAssetCacheLock::TryAcquire(const FString& LockPath)
+{
+    const FString FullPath = FPaths::ConvertRelativePathToFull(LockPath);
+    IFileManager::Get().MakeDirectory(*FPaths::GetPath(FullPath), true);
+
+#if PLATFORM_WINDOWS
+    // No write sharing makes the handle exclusive; the file goes away with the last handle 不共享写权限使句柄独占；最后一个句柄关闭时文件自动删除
+    HANDLE Handle = ::CreateFileW(*FullPath, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr,
+        OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL | FILE_FLAG_DELETE_ON_CLOSE, nullptr);
+    if (Handle == INVALID_HANDLE_VALUE)
+    {
+        return nullptr;
+    }
+
+    const FTCHARToUTF8 Marker(*MakeOwnerMarker());
+    DWORD BytesWritten = 0;
+    ::WriteFile(Handle, Marker.Get(), (DWORD)Marker.Length(), &BytesWritten, nullptr);
+
+    TUniquePtr<FAssetCacheLock> Lock(new FAssetCacheLock(FullPath));
+    Lock->Handle = Handle;
+    return Lock;
+#elif PLATFORM_UNIX || PLATFORM_MAC
+    const FTCHARToUTF8 PathUtf8(*FullPath);
+    const int32 FileDescriptor = ::open(PathUtf8.Get(), O_RDWR | O_CREAT | O_CLOEXEC, 0666);
+    if (FileDescriptor < 0)
+    {
+        return nullptr;
+    }
+
+    if (::flock(FileDescriptor, LOCK_EX | LOCK_NB) != 0)
+    {
+        ::close(FileDescriptor);
+        return nullptr;
+    }
+
+    // The previous owner may have removed the file between our open and lock 上一个持有者可能在打开和加锁之间删除了文件
+    struct stat OpenedStat;
+    struct stat PathStat;
+    if (::fstat(FileDescriptor, &OpenedStat) != 0 || ::stat(PathUtf8.Get(), &PathStat) != 0
+        || OpenedStat.st_ino != PathStat.st_ino || OpenedStat.st_dev != PathStat.st_dev)
+    {
+        ::close(FileDescriptor);
+        return nullptr;
+    }
+
+    const FTCHARToUTF8 Marker(*MakeOwnerMarker());
+    if (::ftruncate(FileDescriptor, 0) == 0)
+    {
+        ::write(FileDescriptor, Marker.Get(), Marker.Length());
+    }
+
+    TUniquePtr<FAssetCacheLock> Lock(new FAssetCacheLock(FullPath));
+    Lock->FileDescriptor = FileDescriptor;
+    return Lock;
+#else
+    // Without file locks only this process is coordinated 不支持文件锁时只在本进程内生效
+    return TUniquePtr<FAssetCacheLock>(new FAssetCacheLock(FullPath));
+#endif
+}
+
+FAssetCacheLock::~FAssetCacheLock()
+{
+#if PLATFORM_WINDOWS
+    if (Handle)
+    {
+        ::CloseHandle((HANDLE)Handle);
+    }
+#elif PLATFORM_UNIX || PLATFORM_MAC
+    if (FileDescriptor >= 0)
+    {
+        // Unlink while still locked, so a waiting process never locks a stale file 在持有锁时删除，等待的进程不会锁住已失效的文件
+        ::unlink(TCHAR_TO_UTF8(*Path));
+        ::close(FileDescriptor);
+    }
+#endif
+}
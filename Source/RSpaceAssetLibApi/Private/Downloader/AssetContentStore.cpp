@@ -0,0 +1,318 @@
+﻿// Copyright (c) 2024 Hunan MangoXR Tech Co., Ltd. All Rights Reserved.
+
+#include "Downloader/AssetContentStore.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Misc/ConfigCacheIni.h"
+#include "Json.h"
+
+#if PLATFORM_WINDOWS
+#include "Windows/AllowWindowsPlatformTypes.h"
+#include <windows.h>
+#include "Windows/HideWindowsPlatformTypes.h"
+#elif PLATFORM_UNIX || PLATFORM_MAC
+#include <unistd.h>
+#endif
+
+FAssetContentStore& FAssetContentStore::Get()
+{
+    static FAssetContentStore Instance;
+    return Instance;
+}
+
+FAssetContentStore::FAssetContentStore()
+{
+    const FString SharedCacheRoot = GetSharedCacheRoot();
+    bIsShared = !SharedCacheRoot.IsEmpty();
+    const FString CacheRoot = bIsShared ? SharedCacheRoot : FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("RspaceAssetsLibrary"));
+
+    StoreDirectory = FPaths::Combine(CacheRoot, TEXT("Store"));
+    LockDirectory = FPaths::Combine(CacheRoot, TEXT("Locks"));
+    ManifestPath = FPaths::Combine(StoreDirectory, TEXT("Manifest.json"));
+    LoadManifest();
+
+    if (bIsShared)
+    {
+        UE_LOG(LogTemp, Log, TEXT("Using the shared asset cache at %s."), *CacheRoot);
+    }
+}
+
+FAssetContentStore::~FAssetContentStore()
+{
+    if (SaveManifestHandle.IsValid())
+    {
+        FTSTicker::GetCoreTicker().RemoveTicker(SaveManifestHandle);
+    }
+}
+
+FString FAssetContentStore::GetSharedCacheRoot()
+{
+    // The environment wins, so build machines can redirect the cache without touching ini files 环境变量优先，构建机无需修改 ini 即可指定缓存位置
+    FString CacheRoot = FPlatformMisc::GetEnvironmentVariable(TEXT("RSPACE_ASSET_CACHE_DIR"));
+#if WITH_EDITOR
+    if (CacheRoot.IsEmpty() && GConfig)
+    {
+        GConfig->GetString(TEXT("RspaceAssetsLibrary"), TEXT("SharedCacheDirectory"), CacheRoot, GEditorSettingsIni);
+    }
+#endif
+    CacheRoot.TrimStartAndEndInline();
+    return CacheRoot.IsEmpty() ? CacheRoot : FPaths::ConvertRelativePathToFull(CacheRoot);
+}
+
+bool FAssetContentStore::FindEntry(const FString& MD5, FAssetStoreEntry& OutEntry)
+{
+    const FString Key = MD5.ToLower();
+    FAssetStoreEntry* Entry = Entries.Find(Key);
+    if (!Entry)
+    {
+        // Another editor instance may have stored it meanwhile 其他编辑器实例可能已存入该内容
+        FAssetStoreEntry DiskEntry;
+        if (!FindObjectOnDisk(Key, DiskEntry))
+        {
+            return false;
+        }
+        DroppedEntries.Remove(Key);
+        Entry = &Entries.Add(Key, DiskEntry);
+    }
+
+    // Entries whose content disappeared or changed size are dropped 内容已丢失或大小不符的条目直接移除
+    if (IFileManager::Get().FileSize(*Entry->Path) != Entry->Size)
+    {
+        Entries.Remove(Key);
+        DroppedEntries.Add(Key);
+        SaveManifest();
+        return false;
+    }
+
+    OutEntry = *Entry;
+    return true;
+}
+
+bool FAssetContentStore::MaterializeTo(const FString& MD5, const FString& TargetPath)
+{
+    FAssetStoreEntry Entry;
+    if (!FindEntry(MD5, Entry))
+    {
+        return false;
+    }
+
+    if (FPaths::IsSamePath(Entry.Path, TargetPath))
+    {
+        return true;
+    }
+
+    // Replace only the link at TargetPath, the stored content is untouched 只替换目标路径上的链接，不影响存储内容
+    IFileManager& FileManager = IFileManager::Get();
+    FileManager.Delete(*TargetPath, false, true, true);
+    if (!CreateHardLink(TargetPath, Entry.Path)
+        && FileManager.Copy(*TargetPath, *Entry.Path) != COPY_OK)
+    {
+        return false;
+    }
+
+    Entries[MD5.ToLower()].LastAccess = FDateTime::UtcNow();
+    SaveManifest();
+    return true;
+}
+
+bool FAssetContentStore::AddFile(const FString& MD5, const FString& FilePath)
+{
+    if (MD5.IsEmpty() || !FPaths::FileExists(FilePath))
+    {
+        return false;
+    }
+
+    FAssetStoreEntry Entry;
+    Entry.MD5 = MD5.ToLower();
+    Entry.Size = IFileManager::Get().FileSize(*FilePath);
+    Entry.LastAccess = FDateTime::UtcNow();
+
+    IFileManager& FileManager = IFileManager::Get();
+    const FString ObjectPath = GetObjectPath(Entry.MD5, FPaths::GetExtension(FilePath, true));
+    FileManager.MakeDirectory(*FPaths::GetPath(ObjectPath), true);
+
+    if (bIsShared && FileManager.FileSize(*ObjectPath) == Entry.Size)
+    {
+        // Another instance stored the same content already; other processes may be reading it 其他实例已存入相同内容，可能正被读取，保留不动
+        Entry.Path = ObjectPath;
+    }
+    else
+    {
+        FileManager.Delete(*ObjectPath, false, true, true);
+        if (CreateHardLink(ObjectPath, FilePath))
+        {
+            Entry.Path = ObjectPath;
+        }
+        else
+        {
+            // A later download may replace the visible file, so the store keeps its own copy 之后的下载可能覆盖可见文件，因此存储中保留一份副本
+            const FString TempPath = ObjectPath + TEXT(".tmp");
+            if (FileManager.Copy(*TempPath, *FilePath) != COPY_OK || !FileManager.Move(*ObjectPath, *TempPath, true, true))
+            {
+                FileManager.Delete(*TempPath, false, true, true);
+                return false;
+            }
+            Entry.Path = ObjectPath;
+        }
+    }
+
+    DroppedEntries.Remove(Entry.MD5);
+    Entries.Add(Entry.MD5, Entry);
+    SaveManifest();
+    return true;
+}
+
+TUniquePtr<FAssetCacheLock> FAssetContentStore::TryLockDownload(const FString& MD5) const
+{
+    return FAssetCacheLock::TryAcquire(FPaths::Combine(LockDirectory, MD5.ToLower() + TEXT(".lock")));
+}
+
+bool FAssetContentStore::CreateHardLink(const FString& NewLinkPath, const FString& ExistingPath)
+{
+    const FString FullNewLinkPath = FPaths::ConvertRelativePathToFull(NewLinkPath);
+    const FString FullExistingPath = FPaths::ConvertRelativePathToFull(ExistingPath);
+#if PLATFORM_WINDOWS
+    return ::CreateHardLinkW(*FullNewLinkPath, *FullExistingPath, nullptr) != 0;
+#elif PLATFORM_UNIX || PLATFORM_MAC
+    return ::link(TCHAR_TO_UTF8(*FullExistingPath), TCHAR_TO_UTF8(*FullNewLinkPath)) == 0;
+#else
+    return false;
+#endif
+}
+
+FString FAssetContentStore::GetObjectPath(const FString& MD5, const FString& Extension) const
+{
+    return FPaths::Combine(StoreDirectory, MD5.Left(2), MD5 + Extension);
+}
+
+bool FAssetContentStore::FindObjectOnDisk(const FString& MD5, FAssetStoreEntry& OutEntry) const
+{
+    // Objects are named <md5><ext>, the extension is not known up front 对象名为 <md5><扩展名>，事先不知道扩展名
+    const FString ObjectDirectory = FPaths::GetPath(GetObjectPath(MD5, FString()));
+    TArray<FString> FileNames;
+    IFileManager::Get().FindFiles(FileNames, *FPaths::Combine(ObjectDirectory, MD5 + TEXT(".*")), true, false);
+
+    for (const FString& FileName : FileNames)
+    {
+        if (FileName.EndsWith(TEXT(".tmp"), ESearchCase::IgnoreCase))
+        {
+            continue;
+        }
+
+        OutEntry.MD5 = MD5;
+        OutEntry.Path = FPaths::Combine(ObjectDirectory, FileName);
+        OutEntry.Size = IFileManager::Get().FileSize(*OutEntry.Path);
+        OutEntry.LastAccess = FDateTime::UtcNow();
+        return OutEntry.Size >= 0;
+    }
+    return false;
+}
+
+void FAssetContentStore::LoadManifest()
+{
+    ReadManifest(ManifestPath, Entries);
+}
+
+void FAssetContentStore::ReadManifest(const FString& Path, TMap<FString, FAssetStoreEntry>& OutEntries)
+{
+    OutEntries.Reset();
+
+    FString JsonString;
+    if (!FFileHelper::LoadFileToString(JsonString, *Path))
+    {
+        return;
+    }
+
+    TSharedPtr<FJsonObject> JsonObject;
+    TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(JsonString);
+    if (!FJsonSerializer::Deserialize(Reader, JsonObject) || !JsonObject.IsValid())
+    {
+        return;
+    }
+
+    const TArray<TSharedPtr<FJsonValue>>* EntryValues = nullptr;
+    if (!JsonObject->TryGetArrayField(TEXT("entries"), EntryValues))
+    {
+        return;
+    }
+
+    for (const TSharedPtr<FJsonValue>& EntryValue : *EntryValues)
+    {
+        const TSharedPtr<FJsonObject>* EntryObject = nullptr;
+        if (!EntryValue.IsValid() || !EntryValue->TryGetObject(EntryObject))
+        {
+            continue;
+        }
+
+        FAssetStoreEntry Entry;
+        Entry.MD5 = (*EntryObject)->GetStringField(TEXT("md5")).ToLower();
+        Entry.Path = (*EntryObject)->GetStringField(TEXT("path"));
+        LexFromString(Entry.Size, *(*EntryObject)->GetStringField(TEXT("size")));
+        FDateTime::ParseIso8601(*(*EntryObject)->GetStringField(TEXT("lastAccess")), Entry.LastAccess);
+
+        if (!Entry.MD5.IsEmpty() && !Entry.Path.IsEmpty())
+        {
+            OutEntries.Add(Entry.MD5, Entry);
+        }
+    }
+}
+
+void FAssetContentStore::SaveManifest()
+{
+    // Other editor instances write the same manifest; merge with theirs under the lock 其他编辑器实例也会写入清单，加锁后与其合并
+    TUniquePtr<FAssetCacheLock> ManifestLock = FAssetCacheLock::TryAcquire(FPaths::Combine(LockDirectory, TEXT("Manifest.lock")));
+    if (!ManifestLock.IsValid())
+    {
+        // Another instance is saving; try again on a later tick instead of waiting on the game thread 其他实例正在保存；稍后在 tick 中重试，不在游戏线程上等待
+        if (!SaveManifestHandle.IsValid())
+        {
+            SaveManifestHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateRaw(this, &FAssetContentStore::RetrySaveManifest), ManifestSaveRetryDelay);
+        }
+        return;
+    }
+
+    TMap<FString, FAssetStoreEntry> MergedEntries;
+    ReadManifest(ManifestPath, MergedEntries);
+    for (const FString& Key : DroppedEntries)
+    {
+        MergedEntries.Remove(Key);
+    }
+    MergedEntries.Append(Entries);
+
+    TArray<TSharedPtr<FJsonValue>> EntryValues;
+    for (const TPair<FString, FAssetStoreEntry>& Pair : MergedEntries)
+    {
+        TSharedRef<FJsonObject> EntryObject = MakeShared<FJsonObject>();
+        EntryObject->SetStringField(TEXT("md5"), Pair.Value.MD5);
+        EntryObject->SetStringField(TEXT("path"), Pair.Value.Path);
+        EntryObject->SetStringField(TEXT("size"), LexToString(Pair.Value.Size));
+        EntryObject->SetStringField(TEXT("lastAccess"), Pair.Value.LastAccess.ToIso8601());
+        EntryValues.Add(MakeShared<FJsonValueObject>(EntryObject));
+    }
+
+    TSharedRef<FJsonObject> JsonObject = MakeShared<FJsonObject>();
+    JsonObject->SetArrayField(TEXT("entries"), EntryValues);
+
+    FString JsonString;
+    TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&JsonString);
+    if (!FJsonSerializer::Serialize(JsonObject, Writer))
+    {
+        return;
+    }
+
+    const FString TempPath = ManifestPath + TEXT(".tmp");
+    IFileManager::Get().MakeDirectory(*StoreDirectory, true);
+    if (FFileHelper::SaveStringToFile(JsonString, *TempPath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM))
+    {
+        IFileManager::Get().Move(*ManifestPath, *TempPath, true, true);
+    }
+}
+
+bool FAssetContentStore::RetrySaveManifest(float DeltaTime)
+{
+    SaveManifestHandle.Reset();
+    SaveManifest();
+    return false;
+}
@@ -0,0 +1,227 @@
+﻿// Copyright (c) 2024 Hunan MangoXR Tech Co., Ltd. All Rights Reserved.
+
+#include "Downloader/AssetDownloadBatch.h"
+#include "ModelLibrary/GetModelLibrary.h"
+#include "VideoLibrary/GetVideoAssetLibraryListInfoApi.h"
+#include "Containers/Ticker.h"
+
+bool UAssetDownloadBatch::IsFinished() const
+{
+    if (IsListing())
+    {
+        return false;
+    }
+
+    for (const UAssetDownloadJob* Job : Jobs)
+    {
+        if (!Job->IsFinished() && Job->GetState() != EAssetDownloadState::Failed)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+int32 UAssetDownloadBatch::GetNumCompletedFiles() const
+{
+    return Jobs.FilterByPredicate([](const UAssetDownloadJob* Job)
+    {
+        return Job->GetState() == EAssetDownloadState::Completed;
+    }).Num();
+}
+
+int32 UAssetDownloadBatch::GetNumFailedFiles() const
+{
+    return Jobs.FilterByPredicate([](const UAssetDownloadJob* Job)
+    {
+        return Job->GetState() == EAssetDownloadState::Failed;
+    }).Num();
+}
+
+int64 UAssetDownloadBatch::GetDownloadedBytes() const
+{
+    int64 DownloadedBytes = 0;
+    for (const UAssetDownloadJob* Job : Jobs)
+    {
+        if (Job->GetState() == EAssetDownloadState::Completed)
+        {
+            DownloadedBytes += FMath::Max(Job->GetTotalBytes(), ListedSizes.FindRef(Job));
+        }
+        else if (Job->GetState() != EAssetDownloadState::Cancelled)
+        {
+            DownloadedBytes += Job->GetDownloadedBytes();
+        }
+    }
+    return DownloadedBytes;
+}
+
+int64 UAssetDownloadBatch::GetTotalBytes() const
+{
+    int64 TotalBytes = 0;
+    for (const UAssetDownloadJob* Job : Jobs)
+    {
+        if (Job->GetState() != EAssetDownloadState::Cancelled)
+        {
+            TotalBytes += Job->GetTotalBytes() > 0 ? Job->GetTotalBytes() : ListedSizes.FindRef(Job);
+        }
+    }
+    return TotalBytes;
+}
+
+void UAssetDownloadBatch::Start(EAssetDownloadBatchSource InSource, const FString& InTicket, const FString& InUuid, const FString& InProjectNo, const FString& RootFolderKey, const FString& InFolderName, EAssetDownloadPriority InPriority, const FAssetDownloadFileFilter& InFileFilter)
+{
+    Source = InSource;
+    Ticket = InTicket;
+    Uuid = InUuid;
+    ProjectNo = InProjectNo;
+    FolderName = InFolderName;
+    Priority = InPriority;
+    FileFilter = InFileFilter;
+
+    FPendingFolder& RootFolder = PendingFolders.AddDefaulted_GetRef();
+    RootFolder.FolderKey = RootFolderKey;
+    ListPendingFolders();
+}
+
+void UAssetDownloadBatch::ListPendingFolders()
+{
+    // Sibling folders are listed at the same time, up to MaxConcurrentListings 同级文件夹并发列举，最多 MaxConcurrentListings 个
+    while (NumActiveListings < MaxConcurrentListings && PendingFolders.Num() > 0)
+    {
+        const FPendingFolder Folder = PendingFolders.Pop(false);
+        NumActiveListings++;
+        ListFolder(Folder);
+    }
+}
+
+void UAssetDownloadBatch::ListFolder(const FPendingFolder& Folder)
+{
+    if (Source == EAssetDownloadBatchSource::Model)
+    {
+        UGetModelLibrary* ModelListing = NewObject<UGetModelLibrary>(this);
+        ListingRequests.Add(ModelListing);
+
+        int32 FolderId = FCString::Atoi(*Folder.FolderKey);
+        int64 TagId = 0;
+        ModelListing->SetOnRequestFailed(FOnGetModelLibraryFailed::CreateUObject(this, &UAssetDownloadBatch::HandleFolderListingFailed, Folder, (UObject*)ModelListing));
+        ModelListing->SendGetModelLibraryRequest(Ticket, Uuid, FolderId, ProjectNo, FString(), TagId, FString(),
+            FOnGetModelLibraryResponse::CreateUObject(this, &UAssetDownloadBatch::HandleModelFolderListed, Folder, (UObject*)ModelListing));
+    }
+    else
+    {
+        UGetVideoAssetLibraryListInfoApi* VideoListing = NewObject<UGetVideoAssetLibraryListInfoApi>(this);
+        ListingRequests.Add(VideoListing);
+
+        VideoListing->SetOnRequestFailed(FOnGetVideoAssetLibraryListInfoFailed::CreateUObject(this, &UAssetDownloadBatch::HandleFolderListingFailed, Folder, (UObject*)VideoListing));
+        VideoListing->SendGetVideoAssetLibraryListInfoRequest(Ticket, ProjectNo, Folder.FolderKey, FString(),
+            FOnGetVideoAssetLibraryListInfoResponse::CreateUObject(this, &UAssetDownloadBatch::HandleVideoFolderListed, Folder, (UObject*)VideoListing));
+    }
+}
+
+void UAssetDownloadBatch::HandleModelFolderListed(UGetModelLibraryResponseData* ModelLibraryData, FPendingFolder Folder, UObject* ListingRequest)
+{
+    if (ModelLibraryData)
+    {
+        for (const FModelFileItem& FileItem : ModelLibraryData->data)
+        {
+            // fileType 1 is a folder in the model library 模型库中 fileType 为 1 表示文件夹
+            if (FileItem.fileType == 1)
+            {
+                FPendingFolder& SubFolder = PendingFolders.AddDefaulted_GetRef();
+                SubFolder.FolderKey = FString::FromInt(FileItem.id);
+            }
+            else if (FileItem.fileSize > 0 && !FileItem.relativePath.IsEmpty())
+            {
+                AddFile(FileItem.fileName, FileItem.relativePath, FileItem.fileMd5, FileItem.fileSize);
+            }
+        }
+    }
+    FinishListing(Folder, ListingRequest, true);
+}
+
+void UAssetDownloadBatch::HandleVideoFolderListed(FGetVideoAssetLibraryListInfoData* VideoLibraryData, FPendingFolder Folder, UObject* ListingRequest)
+{
+    if (VideoLibraryData)
+    {
+        for (const FVideoAssetInfo& VideoFileItem : VideoLibraryData->data)
+        {
+            // fileType 0 is a folder in the video library, listed by its fileNo 视频库中 fileType 为 0 表示文件夹，按 fileNo 列举
+            if (VideoFileItem.fileType == 0)
+            {
+                FPendingFolder& SubFolder = PendingFolders.AddDefaulted_GetRef();
+                SubFolder.FolderKey = VideoFileItem.fileNo;
+            }
+            else if (!VideoFileItem.relativePatch.IsEmpty())
+            {
+                // The video list carries no MD5, so these files are not verified 视频列表不含 MD5，这些文件不做校验
+                const int64 ListedSize = VideoFileItem.fileSize.IsNumeric() ? FCString::Atoi64(*VideoFileItem.fileSize) : 0;
+                AddFile(VideoFileItem.fileName, VideoFileItem.relativePatch, FString(), ListedSize);
+            }
+        }
+    }
+    FinishListing(Folder, ListingRequest, true);
+}
+
+void UAssetDownloadBatch::HandleFolderListingFailed(FPendingFolder Folder, UObject* ListingRequest)
+{
+    FinishListing(Folder, ListingRequest, false);
+}
+
+void UAssetDownloadBatch::FinishListing(const FPendingFolder& Folder, UObject* ListingRequest, bool bSucceeded)
+{
+    ListingRequests.Remove(ListingRequest);
+    NumActiveListings--;
+
+    if (!bSucceeded)
+    {
+        if (Folder.Attempts + 1 < MaxListingAttempts)
+        {
+            // Try the folder again a little later, e.g. after the tree view listed it 稍后重试该文件夹，例如目录树正在列举同一文件夹时
+            FPendingFolder RetryFolder = Folder;
+            RetryFolder.Attempts++;
+            NumActiveListings++;
+
+            TWeakObjectPtr<UAssetDownloadBatch> WeakThis(this);
+            FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateLambda([WeakThis, RetryFolder](float DeltaTime)
+            {
+                if (UAssetDownloadBatch* Batch = WeakThis.Get())
+                {
+                    Batch->ListFolder(RetryFolder);
+                }
+                return false;
+            }), (float)RetryFolder.Attempts);
+            return;
+        }
+
+        UE_LOG(LogTemp, Warning, TEXT("Failed to list folder %s of batch %s."), *Folder.FolderKey, *FolderName);
+        NumFailedFolders++;
+    }
+
+    ListPendingFolders();
+
+    if (!IsListing())
+    {
+        UE_LOG(LogTemp, Log, TEXT("Listed %d files in %s, %d folders could not be listed."), Jobs.Num(), *FolderName, NumFailedFolders);
+        if (UAssetDownloadSubsystem* Subsystem = Cast<UAssetDownloadSubsystem>(GetOuter()))
+        {
+            Subsystem->HandleBatchUpdated(this);
+        }
+    }
+}
+
+void UAssetDownloadBatch::AddFile(const FString& FileName, const FString& URL, const FString& MD5, int64 ListedSize)
+{
+    UAssetDownloadSubsystem* Subsystem = Cast<UAssetDownloadSubsystem>(GetOuter());
+    if (!Subsystem || (FileFilter.IsBound() && !FileFilter.Execute(FileName, URL, MD5, ListedSize)))
+    {
+        return;
+    }
+
+    // A file already in the queue is shared with this batch 已在队列中的文件与本批次共用同一任务
+    UAssetDownloadJob* Job = Subsystem->EnqueueDownload(URL, FileName, MD5, Priority);
+    if (Job && !ListedSizes.Contains(Job))
+    {
+        Jobs.Add(Job);
+        ListedSizes.Add(Job, ListedSize);
+    }
+}
@@ -0,0 +1,116 @@
+﻿// Copyright (c) 2024 Hunan MangoXR Tech Co., Ltd. All Rights Reserved.
+
+#include "CoreMinimal.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformMemory.h"
+#include "HAL/PlatformFileManager.h"
+#include "Containers/Ticker.h"
+#include "Algo/AllOf.h"
+#include "Downloader/AssetDownloadSubsystem.h"
+
+namespace AssetDownloadBenchmark
+{
+    /** One running batch; only a single benchmark runs at a time. 同一时间只运行一次基准测试 */
+    struct FBenchmarkRun
+    {
+        TArray<TWeakObjectPtr<UAssetDownloadJob>> Jobs;
+        TArray<FString> FilePaths;
+        double StartTime = 0.0;
+        uint64 BaselineUsedPhysical = 0;
+        uint64 PeakUsedPhysical = 0;
+    };
+
+    static TUniquePtr<FBenchmarkRun> ActiveRun;
+
+    static void SampleMemory()
+    {
+        ActiveRun->PeakUsedPhysical = FMath::Max<uint64>(ActiveRun->PeakUsedPhysical, FPlatformMemory::GetStats().UsedPhysical);
+    }
+
+    static void FinishRun()
+    {
+        const double Elapsed = FPlatformTime::Seconds() - ActiveRun->StartTime;
+
+        int64 TotalBytes = 0;
+        int32 NumCompleted = 0;
+        IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+        for (const FString& FilePath : ActiveRun->FilePaths)
+        {
+            const int64 FileSize = PlatformFile.FileSize(*FilePath);
+            if (FileSize >= 0)
+            {
+                TotalBytes += FileSize;
+                NumCompleted++;
+                PlatformFile.DeleteFile(*FilePath);
+            }
+        }
+
+        const double MB = 1024.0 * 1024.0;
+        UE_LOG(LogTemp, Display, TEXT("Download benchmark: %d/%d files, %.1f MB in %.2f s (%.2f MB/s)."),
+            NumCompleted, ActiveRun->FilePaths.Num(), TotalBytes / MB, Elapsed, Elapsed > 0.0 ? TotalBytes / MB / Elapsed : 0.0);
+        UE_LOG(LogTemp, Display, TEXT("Download benchmark: peak used physical %.1f MB, %.1f MB above the %.1f MB baseline."),
+            ActiveRun->PeakUsedPhysical / MB, (ActiveRun->PeakUsedPhysical - ActiveRun->BaselineUsedPhysical) / MB, ActiveRun->BaselineUsedPhysical / MB);
+
+        ActiveRun.Reset();
+    }
+
+    static bool Tick(float DeltaTime)
+    {
+        SampleMemory();
+
+        // Failed jobs stay paused in the queue, so they count as done here 失败的任务会留在队列中，这里视为结束
+        const bool bAllDone = Algo::AllOf(ActiveRun->Jobs, [](const TWeakObjectPtr<UAssetDownloadJob>& Job)
+        {
+            return !Job.IsValid() || Job->IsFinished() || Job->GetState() == EAssetDownloadState::Failed;
+        });
+        if (bAllDone)
+        {
+            FinishRun();
+            return false;
+        }
+        return true;
+    }
+
+    static void Run(const TArray<FString>& Args)
+    {
+        UAssetDownloadSubsystem* Subsystem = UAssetDownloadSubsystem::Get();
+        if (Args.Num() < 1 || !Subsystem)
+        {
+            UE_LOG(LogTemp, Warning, TEXT("Usage: RSAsset.DownloadBenchmark <URL> [Count=10]"));
+            return;
+        }
+        if (ActiveRun.IsValid())
+        {
+            UE_LOG(LogTemp, Warning, TEXT("Download benchmark is already running."));
+            return;
+        }
+
+        const FString& URL = Args[0];
+        const int32 Count = Args.Num() > 1 ? FMath::Max(1, FCString::Atoi(*Args[1])) : 10;
+
+        ActiveRun = MakeUnique<FBenchmarkRun>();
+        ActiveRun->StartTime = FPlatformTime::Seconds();
+        ActiveRun->BaselineUsedPhysical = FPlatformMemory::GetStats().UsedPhysical;
+        ActiveRun->PeakUsedPhysical = ActiveRun->BaselineUsedPhysical;
+
+        // No MD5, so the content store cannot serve the copies 不传 MD5，避免内容仓库直接提供副本
+        const FString BaseName = FPaths::GetCleanFilename(URL);
+        for (int32 Index = 0; Index < Count; ++Index)
+        {
+            const FString FileName = FString::Printf(TEXT("Benchmark_%d_%s"), Index, *BaseName);
+            if (UAssetDownloadJob* Job = Subsystem->EnqueueDownload(URL, FileName, FString()))
+            {
+                ActiveRun->Jobs.Add(Job);
+                ActiveRun->FilePaths.Add(Job->GetFilePath());
+            }
+        }
+
+        FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateStatic(&Tick));
+        UE_LOG(LogTemp, Display, TEXT("Download benchmark: started %d downloads of %s."), ActiveRun->Jobs.Num(), *URL);
+    }
+
+    static FAutoConsoleCommand DownloadBenchmarkCommand(
+        TEXT("RSAsset.DownloadBenchmark"),
+        TEXT("Downloads a file Count times (default 10) through the download queue and logs throughput and peak memory. Usage: RSAsset.DownloadBenchmark <URL> [Count]"),
+        FConsoleCommandWithArgsDelegate::CreateStatic(&Run));
+}
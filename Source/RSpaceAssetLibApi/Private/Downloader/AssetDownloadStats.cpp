@@ -0,0 +1,111 @@
+﻿// Copyright (c) 2024 Hunan MangoXR Tech Co., Ltd. All Rights Reserved.
+
+#include "Downloader/AssetDownloadStats.h"
+
+void FAssetLatencyHistogram::AddSample(double Seconds)
+{
+    int32 Bucket = 0;
+    while (Bucket < NumBuckets - 1 && Seconds > GetBucketUpperBound(Bucket))
+    {
+        Bucket++;
+    }
+
+    Buckets[Bucket]++;
+    NumSamples++;
+    TotalSeconds += Seconds;
+    MaxSeconds = FMath::Max(MaxSeconds, Seconds);
+}
+
+void FAssetLatencyHistogram::Merge(const FAssetLatencyHistogram& Other)
+{
+    for (int32 Bucket = 0; Bucket < NumBuckets; ++Bucket)
+    {
+        Buckets[Bucket] += Other.Buckets[Bucket];
+    }
+    NumSamples += Other.NumSamples;
+    TotalSeconds += Other.TotalSeconds;
+    MaxSeconds = FMath::Max(MaxSeconds, Other.MaxSeconds);
+}
+
+double FAssetLatencyHistogram::GetPercentile(double Percentile) const
+{
+    if (NumSamples == 0)
+    {
+        return 0.0;
+    }
+
+    const int32 TargetCount = FMath::Max(1, FMath::CeilToInt(NumSamples * FMath::Clamp(Percentile, 0.0, 1.0)));
+    int32 Count = 0;
+    for (int32 Bucket = 0; Bucket < NumBuckets; ++Bucket)
+    {
+        Count += Buckets[Bucket];
+        if (Count >= TargetCount)
+        {
+            return FMath::Min(GetBucketUpperBound(Bucket), MaxSeconds);
+        }
+    }
+    return MaxSeconds;
+}
+
+void FAssetDownloadStats::Start(double Now)
+{
+    // A resumed download keeps its figures 继续下载时保留已有的统计
+    if (StartTime <= 0.0)
+    {
+        StartTime = Now;
+    }
+    WindowStartTime = Now;
+    WindowBytes = 0;
+}
+
+void FAssetDownloadStats::RecordBytes(int64 NumBytes, double Now)
+{
+    ReceivedBytes += NumBytes;
+    WindowBytes += NumBytes;
+    UpdateThroughput(Now);
+}
+
+void FAssetDownloadStats::UpdateThroughput(double Now)
+{
+    if (WindowStartTime <= 0.0)
+    {
+        WindowStartTime = Now;
+        return;
+    }
+
+    const double WindowSeconds = Now - WindowStartTime;
+    if (WindowSeconds < ThroughputWindowSeconds)
+    {
+        return;
+    }
+
+    InstantBytesPerSecond = WindowBytes / WindowSeconds;
+    SmoothedBytesPerSecond = bHasThroughputSample
+        ? SmoothedBytesPerSecond * (1.0 - ThroughputSmoothing) + InstantBytesPerSecond * ThroughputSmoothing
+        : InstantBytesPerSecond;
+    bHasThroughputSample = true;
+
+    WindowStartTime = Now;
+    WindowBytes = 0;
+}
+
+void FAssetDownloadStats::MergeTotals(const FAssetDownloadStats& Other)
+{
+    if (Other.StartTime > 0.0)
+    {
+        StartTime = StartTime > 0.0 ? FMath::Min(StartTime, Other.StartTime) : Other.StartTime;
+    }
+    ReceivedBytes += Other.ReceivedBytes;
+    NumRetries += Other.NumRetries;
+    TimeToFirstByte.Merge(Other.TimeToFirstByte);
+    RangeLatency.Merge(Other.RangeLatency);
+}
+
+double FAssetDownloadStats::GetEtaSeconds(int64 RemainingBytes) const
+{
+    if (RemainingBytes <= 0)
+    {
+        return 0.0;
+    }
+    return SmoothedBytesPerSecond > 1.0 ? RemainingBytes / SmoothedBytesPerSecond : -1.0;
+}
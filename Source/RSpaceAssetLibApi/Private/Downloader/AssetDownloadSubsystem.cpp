@@ -0,0 +1,616 @@
+﻿// Copyright (c) 2024 Hunan MangoXR Tech Co., Ltd. All Rights Reserved.
+
+#include "Downloader/AssetDownloadSubsystem.h"
+#include "Downloader/AssetDownloadBatch.h"
+#include "Algo/AllOf.h"
+#include "Editor.h"
+#include "GenericPlatform/GenericPlatformHttp.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+static TAutoConsoleVariable<float> CVarProgressUpdateRate(
+    TEXT("RSAsset.ProgressUpdateRate"),
+    30.0f,
+    TEXT("Maximum number of download progress updates delivered to the UI per second; never more than once per frame."));
+
+namespace
+{
+    // Heap order: higher priority first, then the job that was queued first 堆顺序：优先级高的在前，同优先级先入先出
+    struct FQueuedJobPredicate
+    {
+        bool operator()(const UAssetDownloadJob& A, const UAssetDownloadJob& B) const
+        {
+            if (A.GetPriority() != B.GetPriority())
+            {
+                return (uint8)A.GetPriority() > (uint8)B.GetPriority();
+            }
+            return A.GetJobId() < B.GetJobId();
+        }
+    };
+
+    // Two requests for one file name are one download only when they carry the same content 同名请求只有内容相同时才是同一个下载
+    bool IsSameContent(const UAssetDownloadJob& Job, const FString& URL, const FString& MD5)
+    {
+        if (!Job.GetMD5().IsEmpty() || !MD5.IsEmpty())
+        {
+            return Job.GetMD5().Equals(MD5, ESearchCase::IgnoreCase);
+        }
+        return Job.GetURL() == URL;
+    }
+
+    // Share of a capped link: a job the user waits for gets four times a background one 限速时的带宽份额：用户等待的任务是后台任务的四倍
+    float GetBandwidthWeight(EAssetDownloadPriority Priority)
+    {
+        switch (Priority)
+        {
+        case EAssetDownloadPriority::High:
+            return 4.0f;
+        case EAssetDownloadPriority::Normal:
+            return 2.0f;
+        default:
+            return 1.0f;
+        }
+    }
+}
+
+FString UAssetDownloadJob::GetFilePath() const
+{
+    return FPaths::Combine(FPaths::ProjectSavedDir(), TEXT("RspaceAssetsLibrary"), FileName);
+}
+
+UAssetDownloadSubsystem* UAssetDownloadSubsystem::Get()
+{
+    return GEditor ? GEditor->GetEditorSubsystem<UAssetDownloadSubsystem>() : nullptr;
+}
+
+void UAssetDownloadSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+    Super::Initialize(Collection);
+
+    // Progress is delivered from the frame ticker, not from each finished range 进度在每帧的 Ticker 中统一通知，而不是每个分段完成时通知
+    ProgressTickerHandle = FTSTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &UAssetDownloadSubsystem::DeliverPendingProgress));
+}
+
+void UAssetDownloadSubsystem::Deinitialize()
+{
+    FTSTicker::GetCoreTicker().RemoveTicker(ProgressTickerHandle);
+    PendingProgressJobs.Reset();
+
+    // Running downloads keep their journal and resume next session 正在下载的任务保存日志，下次启动时可继续
+    for (UAssetDownloadJob* Job : Jobs)
+    {
+        if (Job && Job->Downloader && Job->State == EAssetDownloadState::Downloading)
+        {
+            Job->Downloader->PauseDownload();
+        }
+    }
+    Jobs.Reset();
+    QueuedJobs.Reset();
+    Batches.Reset();
+    FinishedJobRecords.Reset();
+    FinishedJobTotals = FAssetDownloadStats();
+
+    Super::Deinitialize();
+}
+
+UAssetDownloadJob* UAssetDownloadSubsystem::EnqueueDownload(const FString& URL, const FString& FileName, const FString& MD5, EAssetDownloadPriority Priority)
+{
+    if (UAssetDownloadJob* ExistingJob = FindJobByFileName(FileName))
+    {
+        // Both would be written to the same file, so the second one is refused 两者会写入同一个文件，因此拒绝后一个
+        if (!IsSameContent(*ExistingJob, URL, MD5))
+        {
+            UE_LOG(LogTemp, Warning, TEXT("Not queueing %s, %s with different content is already downloading."), *URL, *ExistingJob->GetFileName());
+            return nullptr;
+        }
+
+        if ((uint8)Priority > (uint8)ExistingJob->Priority)
+        {
+            SetJobPriority(ExistingJob, Priority);
+        }
+        ResumeJob(ExistingJob);
+        return ExistingJob;
+    }
+
+    UAssetDownloadJob* Job = NewObject<UAssetDownloadJob>(this);
+    Job->JobId = NextJobId++;
+    Job->URL = URL;
+    Job->FileName = FileName;
+    Job->MD5 = MD5;
+    Job->Priority = Priority;
+
+    Job->Downloader = NewObject<UAssetDownloader>(Job);
+    Job->Downloader->SetBandwidthWeight(GetBandwidthWeight(Priority));
+    Job->Downloader->SetOnDownloadProgress(FOnDownloadProgress::CreateUObject(this, &UAssetDownloadSubsystem::HandleJobProgress, Job));
+    Job->Downloader->SetOnDownloadComplete(FOnDownloadComplete::CreateUObject(this, &UAssetDownloadSubsystem::HandleJobComplete, Job));
+    Job->Downloader->SetOnDownloadError(FOnDownloadError::CreateUObject(this, &UAssetDownloadSubsystem::HandleJobError, Job));
+
+    Jobs.Add(Job);
+    PushQueuedJob(Job);
+    OnJobAdded.Broadcast(Job);
+
+    ProcessQueue();
+    return Job;
+}
+
+UAssetDownloadBatch* UAssetDownloadSubsystem::EnqueueModelFolder(const FString& Ticket, const FString& Uuid, const FString& ProjectNo, int32 FolderId, const FString& FolderName, EAssetDownloadPriority Priority, const FAssetDownloadFileFilter& FileFilter)
+{
+    UAssetDownloadBatch* Batch = AddBatch();
+    Batch->Start(EAssetDownloadBatchSource::Model, Ticket, Uuid, ProjectNo, FString::FromInt(FolderId), FolderName, Priority, FileFilter);
+    return Batch;
+}
+
+UAssetDownloadBatch* UAssetDownloadSubsystem::EnqueueVideoFolder(const FString& Ticket, const FString& ProjectNo, const FString& FolderNo, const FString& FolderName, EAssetDownloadPriority Priority, const FAssetDownloadFileFilter& FileFilter)
+{
+    UAssetDownloadBatch* Batch = AddBatch();
+    Batch->Start(EAssetDownloadBatchSource::Video, Ticket, FString(), ProjectNo, FolderNo, FolderName, Priority, FileFilter);
+    return Batch;
+}
+
+UAssetDownloadBatch* UAssetDownloadSubsystem::AddBatch()
+{
+    // A new run starts once every earlier batch has finished 之前的批次全部结束后开始新的统计
+    if (Batches.Num() > 0 && Algo::AllOf(Batches, [](const UAssetDownloadBatch* Batch) { return Batch->IsFinished(); }))
+    {
+        Batches.Reset();
+    }
+
+    UAssetDownloadBatch* Batch = NewObject<UAssetDownloadBatch>(this);
+    Batches.Add(Batch);
+    return Batch;
+}
+
+void UAssetDownloadSubsystem::HandleBatchUpdated(UAssetDownloadBatch* Batch)
+{
+    if (Batch->IsFinished())
+    {
+        UE_LOG(LogTemp, Log, TEXT("Batch %s finished: %d of %d files downloaded, %d failed."),
+            *Batch->GetFolderName(), Batch->GetNumCompletedFiles(), Batch->GetNumFiles(), Batch->GetNumFailedFiles());
+    }
+}
+
+FAssetDownloadBatchProgress UAssetDownloadSubsystem::GetBatchProgress() const
+{
+    FAssetDownloadBatchProgress Progress;
+    for (const UAssetDownloadBatch* Batch : Batches)
+    {
+        Progress.NumBatches++;
+        Progress.NumFiles += Batch->GetNumFiles();
+        Progress.NumCompletedFiles += Batch->GetNumCompletedFiles();
+        Progress.NumFailedFiles += Batch->GetNumFailedFiles();
+        Progress.DownloadedBytes += Batch->GetDownloadedBytes();
+        Progress.TotalBytes += Batch->GetTotalBytes();
+        Progress.bIsListing |= Batch->IsListing();
+    }
+    return Progress;
+}
+
+FAssetDownloadStats UAssetDownloadSubsystem::GetAggregateStats() const
+{
+    FAssetDownloadStats Aggregate;
+    Aggregate.MergeTotals(FinishedJobTotals);
+
+    for (const UAssetDownloadJob* Job : Jobs)
+    {
+        const FAssetDownloadStats JobStats = Job->GetStats();
+        Aggregate.MergeTotals(JobStats);
+        if (Job->State == EAssetDownloadState::Downloading)
+        {
+            Aggregate.InstantBytesPerSecond += JobStats.InstantBytesPerSecond;
+            Aggregate.SmoothedBytesPerSecond += JobStats.SmoothedBytesPerSecond;
+        }
+    }
+    return Aggregate;
+}
+
+int64 UAssetDownloadSubsystem::GetRemainingBytes() const
+{
+    // Paused and failed jobs do not drain, so they are left out 暂停和失败的任务不会完成，不计入剩余量
+    int64 RemainingBytes = 0;
+    for (const UAssetDownloadJob* Job : Jobs)
+    {
+        if (Job->State == EAssetDownloadState::Downloading || Job->State == EAssetDownloadState::Queued)
+        {
+            RemainingBytes += FMath::Max<int64>(Job->TotalBytes - Job->DownloadedBytes, 0);
+        }
+    }
+    return RemainingBytes;
+}
+
+bool UAssetDownloadSubsystem::ExportStatsToCsv(const FString& FilePath) const
+{
+    auto Milliseconds = [](double Seconds)
+    {
+        return FString::Printf(TEXT("%.1f"), Seconds * 1000.0);
+    };
+
+    auto StatsRow = [&Milliseconds](const FString& JobId, const FString& FileName, const FString& State, int64 DownloadedBytes, int64 TotalBytes, const FAssetDownloadStats& Stats, double EtaSeconds)
+    {
+        TArray<FString> Columns;
+        Columns.Add(JobId);
+        Columns.Add(FString::Printf(TEXT("\"%s\""), *FileName.Replace(TEXT("\""), TEXT("\"\""))));
+        Columns.Add(State);
+        Columns.Add(LexToString(DownloadedBytes));
+        Columns.Add(LexToString(TotalBytes));
+        Columns.Add(LexToString(Stats.ReceivedBytes));
+        Columns.Add(FString::Printf(TEXT("%.3f"), Stats.InstantBytesPerSecond / (1024.0 * 1024.0)));
+        Columns.Add(FString::Printf(TEXT("%.3f"), Stats.SmoothedBytesPerSecond / (1024.0 * 1024.0)));
+        Columns.Add(FString::Printf(TEXT("%.1f"), EtaSeconds));
+        Columns.Add(LexToString(Stats.NumRetries));
+        Columns.Add(LexToString(Stats.RangeLatency.NumSamples));
+        Columns.Add(Milliseconds(Stats.TimeToFirstByte.GetAverage()));
+        Columns.Add(Milliseconds(Stats.TimeToFirstByte.GetPercentile(0.5)));
+        Columns.Add(Milliseconds(Stats.TimeToFirstByte.GetPercentile(0.95)));
+        Columns.Add(Milliseconds(Stats.RangeLatency.GetAverage()));
+        Columns.Add(Milliseconds(Stats.RangeLatency.GetPercentile(0.5)));
+        Columns.Add(Milliseconds(Stats.RangeLatency.GetPercentile(0.95)));
+        Columns.Add(Milliseconds(Stats.RangeLatency.MaxSeconds));
+        return FString::Join(Columns, TEXT(","));
+    };
+
+    TArray<FString> Lines;
+    Lines.Add(TEXT("JobId,FileName,State,DownloadedBytes,TotalBytes,ReceivedBytes,InstantMBps,SmoothedMBps,EtaSeconds,Retries,Ranges,TtfbAvgMs,TtfbP50Ms,TtfbP95Ms,RangeAvgMs,RangeP50Ms,RangeP95Ms,RangeMaxMs"));
+
+    for (const FAssetDownloadJobRecord& Record : FinishedJobRecords)
+    {
+        Lines.Add(StatsRow(LexToString(Record.JobId), Record.FileName, UEnum::GetValueAsString(Record.State), Record.DownloadedBytes, Record.TotalBytes, Record.Stats, 0.0));
+    }
+    for (const UAssetDownloadJob* Job : Jobs)
+    {
+        Lines.Add(StatsRow(LexToString(Job->JobId), Job->FileName, UEnum::GetValueAsString(Job->State), Job->DownloadedBytes, Job->TotalBytes, Job->GetStats(), Job->GetEtaSeconds()));
+    }
+
+    const FAssetDownloadStats Aggregate = GetAggregateStats();
+    Lines.Add(StatsRow(TEXT("Total"), FString(), FString(), Aggregate.ReceivedBytes, Aggregate.ReceivedBytes + GetRemainingBytes(), Aggregate, Aggregate.GetEtaSeconds(GetRemainingBytes())));
+
+    // Histogram buckets of all jobs, for comparing runs 所有任务的延迟直方图，便于对比不同运行
+    Lines.Add(FString());
+    Lines.Add(TEXT("BucketUpToMs,TtfbCount,RangeCount"));
+    for (int32 Bucket = 0; Bucket < FAssetLatencyHistogram::NumBuckets; ++Bucket)
+    {
+        const bool bIsLastBucket = Bucket == FAssetLatencyHistogram::NumBuckets - 1;
+        Lines.Add(FString::Printf(TEXT("%s,%d,%d"),
+            bIsLastBucket ? TEXT("inf") : *Milliseconds(FAssetLatencyHistogram::GetBucketUpperBound(Bucket)),
+            Aggregate.TimeToFirstByte.Buckets[Bucket], Aggregate.RangeLatency.Buckets[Bucket]));
+    }
+
+    return FFileHelper::SaveStringArrayToFile(Lines, *FilePath);
+}
+
+void UAssetDownloadSubsystem::PauseJob(UAssetDownloadJob* Job)
+{
+    if (!Job)
+    {
+        return;
+    }
+
+    const EAssetDownloadState PreviousState = Job->State;
+    if (!SetJobState(Job, EAssetDownloadState::Paused))
+    {
+        return;
+    }
+
+    if (PreviousState == EAssetDownloadState::Queued)
+    {
+        RemoveQueuedJob(Job);
+    }
+    else
+    {
+        Job->Downloader->PauseDownload();
+        ProcessQueue();
+    }
+}
+
+void UAssetDownloadSubsystem::ResumeJob(UAssetDownloadJob* Job)
+{
+    if (Job && SetJobState(Job, EAssetDownloadState::Queued))
+    {
+        PushQueuedJob(Job);
+        ProcessQueue();
+    }
+}
+
+void UAssetDownloadSubsystem::CancelJob(UAssetDownloadJob* Job)
+{
+    if (!Job || Job->IsFinished())
+    {
+        return;
+    }
+
+    RemoveQueuedJob(Job);
+    if (Job->bHasStarted)
+    {
+        Job->Downloader->CancelDownload();
+    }
+
+    SetJobState(Job, EAssetDownloadState::Cancelled);
+    RemoveJob(Job);
+    ProcessQueue();
+}
+
+void UAssetDownloadSubsystem::SetJobPriority(UAssetDownloadJob* Job, EAssetDownloadPriority Priority)
+{
+    if (!Job || Job->Priority == Priority)
+    {
+        return;
+    }
+
+    Job->Priority = Priority;
+    Job->Downloader->SetBandwidthWeight(GetBandwidthWeight(Priority));
+    if (Job->State == EAssetDownloadState::Queued)
+    {
+        QueuedJobs.Heapify(FQueuedJobPredicate());
+    }
+}
+
+void UAssetDownloadSubsystem::PauseAll()
+{
+    for (UAssetDownloadJob* Job : TArray<UAssetDownloadJob*>(Jobs))
+    {
+        PauseJob(Job);
+    }
+}
+
+void UAssetDownloadSubsystem::ResumeAll()
+{
+    for (UAssetDownloadJob* Job : TArray<UAssetDownloadJob*>(Jobs))
+    {
+        ResumeJob(Job);
+    }
+}
+
+void UAssetDownloadSubsystem::CancelAll()
+{
+    for (UAssetDownloadJob* Job : TArray<UAssetDownloadJob*>(Jobs))
+    {
+        CancelJob(Job);
+    }
+}
+
+void UAssetDownloadSubsystem::SetMaxConcurrentDownloads(int32 InMaxConcurrentDownloads)
+{
+    MaxConcurrentDownloads = FMath::Max(1, InMaxConcurrentDownloads);
+    ProcessQueue();
+}
+
+UAssetDownloadJob* UAssetDownloadSubsystem::FindJobByFileName(const FString& FileName) const
+{
+    const FString CleanFileName = FPaths::GetCleanFilename(FileName);
+    for (UAssetDownloadJob* Job : Jobs)
+    {
+        if (Job && !Job->IsFinished() && Job->FileName.Equals(CleanFileName, ESearchCase::IgnoreCase))
+        {
+            return Job;
+        }
+    }
+    return nullptr;
+}
+
+int32 UAssetDownloadSubsystem::GetNumDownloadingJobs() const
+{
+    int32 NumDownloading = 0;
+    for (const UAssetDownloadJob* Job : Jobs)
+    {
+        if (Job && Job->State == EAssetDownloadState::Downloading)
+        {
+            ++NumDownloading;
+        }
+    }
+    return NumDownloading;
+}
+
+bool UAssetDownloadSubsystem::CanTransition(EAssetDownloadState From, EAssetDownloadState To)
+{
+    switch (From)
+    {
+    case EAssetDownloadState::Queued:
+        return To == EAssetDownloadState::Downloading || To == EAssetDownloadState::Paused || To == EAssetDownloadState::Cancelled;
+    case EAssetDownloadState::Downloading:
+        return To == EAssetDownloadState::Paused || To == EAssetDownloadState::Completed
+            || To == EAssetDownloadState::Failed || To == EAssetDownloadState::Cancelled;
+    case EAssetDownloadState::Paused:
+    case EAssetDownloadState::Failed:
+        return To == EAssetDownloadState::Queued || To == EAssetDownloadState::Cancelled;
+    default:
+        return false;
+    }
+}
+
+bool UAssetDownloadSubsystem::SetJobState(UAssetDownloadJob* Job, EAssetDownloadState NewState)
+{
+    const EAssetDownloadState PreviousState = Job->State;
+    if (!CanTransition(PreviousState, NewState))
+    {
+        return false;
+    }
+
+    // Progress gathered before the change must not arrive after it 状态变化前累积的进度不能在变化之后才送达
+    DeliverJobProgress(Job);
+
+    Job->State = NewState;
+    Job->OnStateChanged.Broadcast(Job, PreviousState);
+    OnJobStateChanged.Broadcast(Job, PreviousState);
+
+    if (NewState == EAssetDownloadState::Completed || NewState == EAssetDownloadState::Failed || NewState == EAssetDownloadState::Cancelled)
+    {
+        for (UAssetDownloadBatch* Batch : Batches)
+        {
+            if (Batch->ContainsJob(Job))
+            {
+                HandleBatchUpdated(Batch);
+            }
+        }
+    }
+    return true;
+}
+
+void UAssetDownloadSubsystem::PushQueuedJob(UAssetDownloadJob* Job)
+{
+    QueuedJobs.HeapPush(Job, FQueuedJobPredicate());
+}
+
+void UAssetDownloadSubsystem::RemoveQueuedJob(UAssetDownloadJob* Job)
+{
+    if (QueuedJobs.Remove(Job) > 0)
+    {
+        QueuedJobs.Heapify(FQueuedJobPredicate());
+    }
+}
+
+void UAssetDownloadSubsystem::ProcessQueue()
+{
+    // Completions raised while a job is starting are picked up by the running loop 启动任务时同步完成的任务由当前循环处理
+    if (bIsProcessingQueue)
+    {
+        return;
+    }
+    TGuardValue<bool> ProcessingGuard(bIsProcessingQueue, true);
+
+    while (QueuedJobs.Num() > 0 && GetNumDownloadingJobs() < MaxConcurrentDownloads)
+    {
+        UAssetDownloadJob* Job = nullptr;
+        QueuedJobs.HeapPop(Job, FQueuedJobPredicate(), false);
+        StartJob(Job);
+    }
+}
+
+void UAssetDownloadSubsystem::StartJob(UAssetDownloadJob* Job)
+{
+    if (!Job || !SetJobState(Job, EAssetDownloadState::Downloading))
+    {
+        return;
+    }
+
+    // A paused download continues where it stopped, anything else starts over from the journal 暂停的任务从断点继续，其余任务根据日志重新开始
+    if (Job->bHasStarted && Job->Downloader->IsPaused())
+    {
+        Job->Downloader->ResumeDownload();
+    }
+    else
+    {
+        Job->bHasStarted = true;
+        Job->Downloader->StartChunkDownload(EncodeDownloadURL(Job->URL), Job->FileName, Job->MD5);
+    }
+}
+
+void UAssetDownloadSubsystem::RemoveJob(UAssetDownloadJob* Job)
+{
+    RemoveQueuedJob(Job);
+    if (Jobs.Remove(Job) > 0)
+    {
+        FAssetDownloadJobRecord& Record = FinishedJobRecords.AddDefaulted_GetRef();
+        Record.JobId = Job->JobId;
+        Record.FileName = Job->FileName;
+        Record.State = Job->State;
+        Record.DownloadedBytes = Job->DownloadedBytes;
+        Record.TotalBytes = Job->TotalBytes;
+        Record.Stats = Job->GetStats();
+        FinishedJobTotals.MergeTotals(Record.Stats);
+    }
+}
+
+void UAssetDownloadSubsystem::HandleJobProgress(float Progress, int64 BytesDownloaded, int64 TotalBytes, int64 CurrentChunkSize, UAssetDownloadJob* Job)
+{
+    Job->DownloadedBytes = BytesDownloaded;
+    Job->TotalBytes = TotalBytes;
+    Job->CurrentChunkSize = CurrentChunkSize;
+
+    // Several ranges finishing in one frame cause a single UI update 同一帧内完成的多个分段只触发一次界面更新
+    PendingProgressJobs.AddUnique(Job);
+}
+
+bool UAssetDownloadSubsystem::DeliverPendingProgress(float DeltaTime)
+{
+    const double Now = FPlatformTime::Seconds();
+    const float UpdateRate = CVarProgressUpdateRate.GetValueOnGameThread();
+    if (PendingProgressJobs.Num() == 0 || (UpdateRate > 0.0f && Now - LastProgressDeliveryTime < 1.0 / UpdateRate))
+    {
+        return true;
+    }
+    LastProgressDeliveryTime = Now;
+
+    TArray<UAssetDownloadJob*> UpdatedJobs;
+    UpdatedJobs.Reserve(PendingProgressJobs.Num());
+    for (const TWeakObjectPtr<UAssetDownloadJob>& PendingJob : PendingProgressJobs)
+    {
+        if (UAssetDownloadJob* Job = PendingJob.Get())
+        {
+            UpdatedJobs.Add(Job);
+        }
+    }
+    PendingProgressJobs.Reset();
+
+    for (UAssetDownloadJob* Job : UpdatedJobs)
+    {
+        Job->OnProgress.Broadcast(Job);
+    }
+    OnJobsProgress.Broadcast(UpdatedJobs);
+    return true;
+}
+
+void UAssetDownloadSubsystem::DeliverJobProgress(UAssetDownloadJob* Job)
+{
+    if (PendingProgressJobs.Remove(Job) > 0)
+    {
+        Job->OnProgress.Broadcast(Job);
+        OnJobsProgress.Broadcast(TArray<UAssetDownloadJob*>({ Job }));
+    }
+}
+
+void UAssetDownloadSubsystem::HandleJobComplete(UAssetDownloadJob* Job)
+{
+    if (SetJobState(Job, EAssetDownloadState::Completed))
+    {
+        RemoveJob(Job);
+        ProcessQueue();
+    }
+}
+
+void UAssetDownloadSubsystem::HandleJobError(UAssetDownloadJob* Job)
+{
+    if (SetJobState(Job, EAssetDownloadState::Failed))
+    {
+        ProcessQueue();
+    }
+}
+
+FString UAssetDownloadSubsystem::EncodeDownloadURL(const FString& URL)
+{
+    // Only the file name part of the URL is encoded 只对 URL 中的文件名部分编码
+    int32 LastSlashIndex;
+    if (URL.FindLastChar('/', LastSlashIndex))
+    {
+        return URL.Left(LastSlashIndex + 1) + FGenericPlatformHttp::UrlEncode(URL.Mid(LastSlashIndex + 1));
+    }
+    return URL;
+}
+
+namespace AssetDownloadStatsCommand
+{
+    static void DumpStats(const TArray<FString>& Args)
+    {
+        UAssetDownloadSubsystem* Subsystem = UAssetDownloadSubsystem::Get();
+        if (!Subsystem)
+        {
+            return;
+        }
+
+        const FString FilePath = Args.Num() > 0
+            ? Args[0]
+            : FPaths::Combine(FPaths::ProjectLogDir(), FString::Printf(TEXT("RSAssetDownloadStats-%s.csv"), *FDateTime::Now().ToString()));
+        if (Subsystem->ExportStatsToCsv(FilePath))
+        {
+            UE_LOG(LogTemp, Display, TEXT("Download stats written to %s."), *FilePath);
+        }
+        else
+        {
+            UE_LOG(LogTemp, Warning, TEXT("Failed to write download stats to %s."), *FilePath);
+        }
+    }
+
+    static FAutoConsoleCommand DumpDownloadStatsCommand(
+        TEXT("RSAsset.DumpDownloadStats"),
+        TEXT("Writes throughput, latency and retry figures of every download of the session to a CSV file. Usage: RSAsset.DumpDownloadStats [FilePath]"),
+        FConsoleCommandWithArgsDelegate::CreateStatic(&DumpStats));
+}
@@ -0,0 +1,190 @@
+﻿// Copyright (c) 2024 Hunan MangoXR Tech Co., Ltd. All Rights Reserved.
+
+#include "Downloader/AssetFileWriter.h"
+#include "Async/Async.h"
+#include "HAL/PlatformFilemanager.h"
+#include "HAL/RunnableThread.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+
+static FThreadSafeCounter AssetFileWriterCounter;
+
+FAssetFileWriter::FAssetFileWriter(const FString& InFilePath, FOnChunkWriteFlushed InOnChunkWriteFlushed)
+    : FilePath(InFilePath)
+    , OnChunkWriteFlushed(InOnChunkWriteFlushed)
+{
+}
+
+FAssetFileWriter::~FAssetFileWriter()
+{
+    Close();
+}
+
+void FAssetFileWriter::EnableHashing(int64 InFileSize, int64 InHashPrefixBytes)
+{
+    check(!IsOpen());
+    bHashContent = true;
+    HashPrefixBytes = InHashPrefixBytes;
+    Hasher.Reset(InFileSize);
+}
+
+bool FAssetFileWriter::Open()
+{
+    if (IsOpen())
+    {
+        return true;
+    }
+
+    // Append mode keeps the bytes of a paused or resumed download 追加模式保留已下载的数据
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    FileHandle.Reset(PlatformFile.OpenWrite(*FilePath, true, true));
+    if (!FileHandle.IsValid())
+    {
+        // UE_LOG(LogTemp, Error, TEXT("Failed to open %s for writing."), *FilePath);
+        return false;
+    }
+
+    // Reserve the whole file once instead of growing it with every chunk 一次性分配完整文件，避免每个分段写入时扩展文件
+    if (PreallocatedSize > 0 && FileHandle->Size() < PreallocatedSize && !FileHandle->Truncate(PreallocatedSize))
+    {
+        UE_LOG(LogTemp, Error, TEXT("Failed to reserve %lld bytes for %s."), PreallocatedSize, *FilePath);
+        FileHandle.Reset();
+        return false;
+    }
+
+    bStopRequested = false;
+    WorkEvent = FPlatformProcess::GetSynchEventFromPool(false);
+    const FString ThreadName = FString::Printf(TEXT("RSAssetFileWriter_%d"), AssetFileWriterCounter.Increment());
+    Thread = FRunnableThread::Create(this, *ThreadName, 0, TPri_BelowNormal);
+    return Thread != nullptr;
+}
+
+void FAssetFileWriter::EnqueueWrite(int64 Offset, TArray<uint8>&& Data)
+{
+    FScopeLock Lock(&ProducerLock);
+    if (!IsOpen() || Data.Num() == 0)
+    {
+        return;
+    }
+
+    PendingBytes += Data.Num();
+    QueuedBytes += Data.Num();
+
+    FPendingWrite PendingWrite;
+    PendingWrite.Offset = Offset;
+    PendingWrite.Data = MoveTemp(Data);
+    PendingWrites.Enqueue(MoveTemp(PendingWrite));
+    WorkEvent->Trigger();
+}
+
+void FAssetFileWriter::CommitRange(int64 Offset, int64 NumBytes)
+{
+    FScopeLock Lock(&ProducerLock);
+    if (!IsOpen() || NumBytes <= 0)
+    {
+        return;
+    }
+
+    // The queue keeps its order, so the range is on disk when the marker is reached 队列保持顺序，处理到标记时该范围已写入磁盘
+    FPendingWrite Commit;
+    Commit.Offset = Offset;
+    Commit.bIsCommit = true;
+    Commit.CommitBytes = NumBytes;
+    PendingWrites.Enqueue(MoveTemp(Commit));
+    WorkEvent->Trigger();
+}
+
+void FAssetFileWriter::Close()
+{
+    FScopeLock Lock(&ProducerLock);
+    if (Thread)
+    {
+        Stop();
+        Thread->WaitForCompletion();
+        delete Thread;
+        Thread = nullptr;
+    }
+
+    if (WorkEvent)
+    {
+        FPlatformProcess::ReturnSynchEventToPool(WorkEvent);
+        WorkEvent = nullptr;
+    }
+
+    if (FileHandle.IsValid())
+    {
+        FileHandle->Flush();
+        FileHandle.Reset();
+    }
+}
+
+uint32 FAssetFileWriter::Run()
+{
+    // Bytes kept from an earlier session are hashed before any new chunk 先计算上次会话保留的数据
+    if (bHashContent && HashPrefixBytes > 0)
+    {
+        Hasher.CatchUpFromFile(FilePath, HashPrefixBytes);
+    }
+
+    while (!bStopRequested)
+    {
+        WorkEvent->Wait();
+        DrainPendingWrites();
+    }
+
+    // Write whatever was queued before the stop request 写完停止前已排队的数据
+    DrainPendingWrites();
+    return 0;
+}
+
+void FAssetFileWriter::Stop()
+{
+    bStopRequested = true;
+    if (WorkEvent)
+    {
+        WorkEvent->Trigger();
+    }
+}
+
+void FAssetFileWriter::DrainPendingWrites()
+{
+    FPendingWrite PendingWrite;
+    while (PendingWrites.Dequeue(PendingWrite))
+    {
+        if (PendingWrite.bIsCommit)
+        {
+            if (bHashContent)
+            {
+                Hasher.Commit(PendingWrite.Offset, PendingWrite.CommitBytes);
+            }
+
+            const int64 CommitOffset = PendingWrite.Offset;
+            const int64 CommitBytes = PendingWrite.CommitBytes;
+            FOnRangeCommitted CommittedDelegate = OnRangeCommitted;
+            AsyncTask(ENamedThreads::GameThread, [CommittedDelegate, CommitOffset, CommitBytes]()
+            {
+                CommittedDelegate.ExecuteIfBound(CommitOffset, CommitBytes);
+            });
+            continue;
+        }
+
+        const int64 NumBytes = PendingWrite.Data.Num();
+        const bool bSuccess = FileHandle.IsValid()
+            && FileHandle->Seek(PendingWrite.Offset)
+            && FileHandle->Write(PendingWrite.Data.GetData(), NumBytes);
+
+        if (bSuccess && bHashContent)
+        {
+            Hasher.Update(PendingWrite.Offset, PendingWrite.Data.GetData(), NumBytes);
+        }
+
+        PendingBytes -= NumBytes;
+
+        // Report the flushed range on the game thread 在游戏线程上报告已写入的范围
+        const int64 Offset = PendingWrite.Offset;
+        FOnChunkWriteFlushed FlushedDelegate = OnChunkWriteFlushed;
+        AsyncTask(ENamedThreads::GameThread, [FlushedDelegate, Offset, NumBytes, bSuccess]()
+        {
+            FlushedDelegate.ExecuteIfBound(Offset, NumBytes, bSuccess);
+        });
+    }
+}
@@ -0,0 +1,112 @@
+﻿// Copyright (c) 2024 Hunan MangoXR Tech Co., Ltd. All Rights Reserved.
+
+#include "Downloader/AssetResponseStream.h"
+#include "Interfaces/IHttpResponse.h"
+
+FAssetResponseStream::FAssetResponseStream(const TSharedRef<FAssetFileWriter>& InFileWriter, int64 InStartOffset, int64 InMaxBytes, int64 InExpectedTotalSize)
+    : FileWriter(InFileWriter)
+    , StartOffset(InStartOffset)
+    , MaxBytes(InMaxBytes)
+    , ExpectedTotalSize(InExpectedTotalSize)
+{
+    SetIsSaving(true);
+    Buffer.Reserve(BufferSize);
+}
+
+void FAssetResponseStream::Serialize(void* Data, int64 Length)
+{
+    // The status and headers are known by the time the first body bytes arrive 收到第一批响应体时状态码和响应头已就绪
+    if (State.Load() == EState::Unchecked)
+    {
+        State = IsExpectedResponse() ? EState::Accepted : EState::Rejected;
+    }
+    if (State.Load() == EState::Rejected)
+    {
+        return;
+    }
+
+    const int64 AcceptedBytes = FMath::Min(Length, MaxBytes - ReceivedBytes.Load());
+    if (AcceptedBytes <= 0)
+    {
+        return;
+    }
+
+    Buffer.Append(static_cast<const uint8*>(Data), (int32)AcceptedBytes);
+    ReceivedBytes += AcceptedBytes;
+
+    if (Buffer.Num() >= BufferSize)
+    {
+        Flush();
+    }
+}
+
+void FAssetResponseStream::Flush()
+{
+    if (Buffer.Num() == 0)
+    {
+        return;
+    }
+
+    // Memory is bounded by the downloader, which stops issuing ranges while the writer lags behind 内存由下载器控制：写线程落后时不再发起新的分段
+    const int64 NumBytes = Buffer.Num();
+    FileWriter->EnqueueWrite(StartOffset + EnqueuedBytes, MoveTemp(Buffer));
+    EnqueuedBytes += NumBytes;
+
+    Buffer.Reset();
+    Buffer.Reserve(BufferSize);
+}
+
+bool FAssetResponseStream::IsExpectedResponse()
+{
+    FHttpRequestPtr PinnedRequest = Request.Pin();
+    FHttpResponsePtr Response = PinnedRequest.IsValid() ? PinnedRequest->GetResponse() : nullptr;
+    if (!Response.IsValid())
+    {
+        return false;
+    }
+
+    const int32 ResponseCode = Response->GetResponseCode();
+    if (ResponseCode == 200 && bAcceptFullBody && StartOffset == 0)
+    {
+        // The server ignored the range and sends the whole file 服务器忽略了 Range，发送整个文件
+        MaxBytes = MAX_int64;
+        return true;
+    }
+
+    int64 RangeStart = -1;
+    int64 RangeEnd = -1;
+    int64 TotalSize = -1;
+    return ResponseCode == 206
+        && ParseContentRange(Response->GetHeader(TEXT("Content-Range")), RangeStart, RangeEnd, TotalSize)
+        && RangeStart == StartOffset
+        && (ExpectedTotalSize < 0 || TotalSize < 0 || TotalSize == ExpectedTotalSize);
+}
+
+bool FAssetResponseStream::ParseContentRange(const FString& Header, int64& OutStart, int64& OutEnd, int64& OutTotal)
+{
+    FString Unit;
+    FString RangeSpec;
+    FString Range;
+    FString Total;
+    if (!Header.TrimStartAndEnd().Split(TEXT(" "), &Unit, &RangeSpec) || !RangeSpec.Split(TEXT("/"), &Range, &Total))
+    {
+        return false;
+    }
+
+    // The total is "*" when the server does not know it 总大小未知时为 "*"
+    OutTotal = Total == TEXT("*") ? -1 : FCString::Atoi64(*Total);
+
+    FString Start;
+    FString End;
+    if (Range.Split(TEXT("-"), &Start, &End))
+    {
+        OutStart = FCString::Atoi64(*Start);
+        OutEnd = FCString::Atoi64(*End);
+    }
+    else
+    {
+        OutStart = 0;
+        OutEnd = -1;
+    }
+    return true;
+}
@@ -0,0 +1,177 @@
+﻿// Copyright (c) 2024 Hunan MangoXR Tech Co., Ltd. All Rights Reserved.
+
+#include "Downloader/DownloadJournal.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "Json.h"
+
+const TCHAR* FDownloadJournal::JournalExtension = TEXT(".rsjournal");
+
+void FDownloadJournal::AddCompletedRange(int64 StartByte, int64 EndByte)
+{
+    if (EndByte < StartByte)
+    {
+        return;
+    }
+
+    CompletedRanges.Add(TPair<int64, int64>(StartByte, EndByte));
+    CompletedRanges.Sort([](const TPair<int64, int64>& A, const TPair<int64, int64>& B)
+    {
+        return A.Key < B.Key;
+    });
+
+    // Merge touching or overlapping ranges 合并相邻或重叠的范围
+    TArray<TPair<int64, int64>> MergedRanges;
+    for (const TPair<int64, int64>& Range : CompletedRanges)
+    {
+        if (MergedRanges.Num() > 0 && Range.Key <= MergedRanges.Last().Value + 1)
+        {
+            MergedRanges.Last().Value = FMath::Max(MergedRanges.Last().Value, Range.Value);
+        }
+        else
+        {
+            MergedRanges.Add(Range);
+        }
+    }
+    CompletedRanges = MoveTemp(MergedRanges);
+}
+
+int64 FDownloadJournal::GetCompletedBytes() const
+{
+    int64 CompletedBytes = 0;
+    for (const TPair<int64, int64>& Range : CompletedRanges)
+    {
+        CompletedBytes += Range.Value - Range.Key + 1;
+    }
+    return CompletedBytes;
+}
+
+TArray<TPair<int64, int64>> FDownloadJournal::GetMissingRanges() const
+{
+    TArray<TPair<int64, int64>> MissingRanges;
+    int64 Cursor = 0;
+    for (const TPair<int64, int64>& Range : CompletedRanges)
+    {
+        if (Range.Key > Cursor)
+        {
+            MissingRanges.Add(TPair<int64, int64>(Cursor, Range.Key - 1));
+        }
+        Cursor = FMath::Max(Cursor, Range.Value + 1);
+    }
+    if (Cursor < FileSize)
+    {
+        MissingRanges.Add(TPair<int64, int64>(Cursor, FileSize - 1));
+    }
+    return MissingRanges;
+}
+
+bool FDownloadJournal::Matches(const FString& InURL, int64 InFileSize, const FString& InMD5) const
+{
+    return URL == InURL
+        && FileSize == InFileSize
+        && MD5.Equals(InMD5, ESearchCase::IgnoreCase);
+}
+
+bool FDownloadJournal::Save(const FString& JournalPath) const
+{
+    TSharedRef<FJsonObject> JsonObject = MakeShared<FJsonObject>();
+    JsonObject->SetStringField(TEXT("url"), URL);
+    JsonObject->SetStringField(TEXT("fileName"), FileName);
+    JsonObject->SetStringField(TEXT("md5"), MD5);
+    JsonObject->SetStringField(TEXT("fileSize"), LexToString(FileSize));
+
+    TArray<TSharedPtr<FJsonValue>> RangeValues;
+    for (const TPair<int64, int64>& Range : CompletedRanges)
+    {
+        RangeValues.Add(MakeShared<FJsonValueString>(FString::Printf(TEXT("%lld-%lld"), Range.Key, Range.Value)));
+    }
+    JsonObject->SetArrayField(TEXT("ranges"), RangeValues);
+
+    FString JsonString;
+    TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&JsonString);
+    if (!FJsonSerializer::Serialize(JsonObject, Writer))
+    {
+        return false;
+    }
+
+    // Write a temp file first so a crash never leaves a torn journal 先写临时文件，崩溃时不会留下损坏的日志
+    const FString TempPath = JournalPath + TEXT(".tmp");
+    if (!FFileHelper::SaveStringToFile(JsonString, *TempPath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM))
+    {
+        return false;
+    }
+    return IFileManager::Get().Move(*JournalPath, *TempPath, true, true);
+}
+
+bool FDownloadJournal::Load(const FString& JournalPath)
+{
+    FString JsonString;
+    if (!FFileHelper::LoadFileToString(JsonString, *JournalPath))
+    {
+        return false;
+    }
+
+    TSharedPtr<FJsonObject> JsonObject;
+    TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(JsonString);
+    if (!FJsonSerializer::Deserialize(Reader, JsonObject) || !JsonObject.IsValid())
+    {
+        return false;
+    }
+
+    URL = JsonObject->GetStringField(TEXT("url"));
+    FileName = JsonObject->GetStringField(TEXT("fileName"));
+    MD5 = JsonObject->GetStringField(TEXT("md5"));
+    LexFromString(FileSize, *JsonObject->GetStringField(TEXT("fileSize")));
+
+    CompletedRanges.Reset();
+    const TArray<TSharedPtr<FJsonValue>>* RangeValues = nullptr;
+    if (JsonObject->TryGetArrayField(TEXT("ranges"), RangeValues))
+    {
+        for (const TSharedPtr<FJsonValue>& RangeValue : *RangeValues)
+        {
+            FString StartString, EndString;
+            if (RangeValue.IsValid() && RangeValue->AsString().Split(TEXT("-"), &StartString, &EndString))
+            {
+                int64 StartByte = 0, EndByte = 0;
+                LexFromString(StartByte, *StartString);
+                LexFromString(EndByte, *EndString);
+                AddCompletedRange(StartByte, FMath::Min(EndByte, FileSize - 1));
+            }
+        }
+    }
+
+    return !URL.IsEmpty() && FileSize > 0;
+}
+
+FString FDownloadJournal::GetJournalPath(const FString& FilePath)
+{
+    return FilePath + JournalExtension;
+}
+
+bool FDownloadJournal::IsJournalFile(const FString& FilePath)
+{
+    return FilePath.EndsWith(JournalExtension, ESearchCase::IgnoreCase)
+        || FilePath.EndsWith(FString(JournalExtension) + TEXT(".tmp"), ESearchCase::IgnoreCase);
+}
+
+TArray<FDownloadJournal> FDownloadJournal::FindInterruptedDownloads(const FString& Directory)
+{
+    TArray<FDownloadJournal> InterruptedDownloads;
+
+    TArray<FString> JournalFiles;
+    IFileManager::Get().FindFiles(JournalFiles, *FPaths::Combine(Directory, FString(TEXT("*")) + JournalExtension), true, false);
+
+    for (const FString& JournalFile : JournalFiles)
+    {
+        const FString JournalPath = FPaths::Combine(Directory, JournalFile);
+        const FString PartialFilePath = JournalPath.LeftChop(FCString::Strlen(JournalExtension));
+
+        FDownloadJournal Journal;
+        if (Journal.Load(JournalPath) && FPaths::FileExists(PartialFilePath))
+        {
+            InterruptedDownloads.Add(MoveTemp(Journal));
+        }
+    }
+    return InterruptedDownloads;
+}
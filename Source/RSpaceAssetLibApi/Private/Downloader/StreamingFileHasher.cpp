@@ -0,0 +1,148 @@
+﻿// Copyright (c) 2024 Hunan MangoXR Tech Co., Ltd. All Rights Reserved.
+
+#include "Downloader/StreamingFileHasher.h"
+#include "HAL/PlatformFilemanager.h"
+#include "GenericPlatform/GenericPlatformFile.h"
+
+void FStreamingFileHasher::Reset(int64 InFileSize)
+{
+    MD5 = FMD5();
+    FileSize = InFileSize;
+    HashedBytes = 0;
+    BufferedSegments.Reset();
+    BufferedBytes = 0;
+    CommittedRanges.Reset();
+}
+
+void FStreamingFileHasher::Update(int64 Offset, const uint8* Data, int64 NumBytes)
+{
+    if (NumBytes <= 0 || Offset + NumBytes <= HashedBytes)
+    {
+        return;
+    }
+
+    // Kept until its range is committed and the prefix catches up 缓存直到其范围被提交且前缀追上
+    if (BufferedBytes + NumBytes <= MaxBufferedBytes && !BufferedSegments.Contains(Offset))
+    {
+        BufferedSegments.Add(Offset, TArray<uint8>(Data, (int32)NumBytes));
+        BufferedBytes += NumBytes;
+        HashBufferedSegments();
+    }
+}
+
+void FStreamingFileHasher::Commit(int64 Offset, int64 NumBytes)
+{
+    if (NumBytes <= 0 || Offset + NumBytes <= HashedBytes)
+    {
+        return;
+    }
+
+    CommittedRanges.Add(TPair<int64, int64>(Offset, Offset + NumBytes));
+    HashBufferedSegments();
+}
+
+int64 FStreamingFileHasher::GetCommittedEnd() const
+{
+    int64 CommittedEnd = HashedBytes;
+    bool bProgress = true;
+    while (bProgress)
+    {
+        bProgress = false;
+        for (const TPair<int64, int64>& Range : CommittedRanges)
+        {
+            if (Range.Key <= CommittedEnd && Range.Value > CommittedEnd)
+            {
+                CommittedEnd = Range.Value;
+                bProgress = true;
+            }
+        }
+    }
+    return CommittedEnd;
+}
+
+void FStreamingFileHasher::HashBufferedSegments()
+{
+    bool bProgress = true;
+    while (bProgress && BufferedSegments.Num() > 0)
+    {
+        bProgress = false;
+        const int64 CommittedEnd = GetCommittedEnd();
+        for (auto It = BufferedSegments.CreateIterator(); It; ++It)
+        {
+            const int64 Offset = It.Key();
+            const int64 NumBytes = It.Value().Num();
+
+            // Bytes of a range that was not verified yet wait for its commit 尚未校验的范围等待提交
+            if (Offset > HashedBytes || (Offset + NumBytes > HashedBytes && Offset + NumBytes > CommittedEnd))
+            {
+                continue;
+            }
+
+            if (Offset + NumBytes > HashedBytes)
+            {
+                const int64 SkipBytes = HashedBytes - Offset;
+                MD5.Update(It.Value().GetData() + SkipBytes, NumBytes - SkipBytes);
+                HashedBytes = Offset + NumBytes;
+            }
+
+            BufferedBytes -= NumBytes;
+            It.RemoveCurrent();
+            bProgress = true;
+            break;
+        }
+    }
+
+    CommittedRanges.RemoveAll([this](const TPair<int64, int64>& Range)
+    {
+        return Range.Value <= HashedBytes;
+    });
+}
+
+bool FStreamingFileHasher::CatchUpFromFile(const FString& FilePath, int64 UpToByte)
+{
+    UpToByte = FMath::Min(UpToByte, FileSize);
+    if (HashedBytes >= UpToByte)
+    {
+        return true;
+    }
+
+    IPlatformFile& PlatformFile = FPlatformFileManager::Get().GetPlatformFile();
+    TUniquePtr<IFileHandle> FileHandle(PlatformFile.OpenRead(*FilePath, true));
+    if (!FileHandle.IsValid())
+    {
+        return false;
+    }
+
+    TArray<uint8> ReadBuffer;
+    while (HashedBytes < UpToByte)
+    {
+        // Only read up to the next buffered segment 只读取到下一个已缓存分段为止
+        int64 GapEnd = UpToByte;
+        for (const TPair<int64, TArray<uint8>>& Segment : BufferedSegments)
+        {
+            if (Segment.Key > HashedBytes)
+            {
+                GapEnd = FMath::Min(GapEnd, Segment.Key);
+            }
+        }
+
+        const int64 BytesToRead = FMath::Min(GapEnd - HashedBytes, ReadBlockSize);
+        ReadBuffer.SetNumUninitialized((int32)BytesToRead, false);
+        if (!FileHandle->Seek(HashedBytes) || !FileHandle->Read(ReadBuffer.GetData(), BytesToRead))
+        {
+            return false;
+        }
+
+        MD5.Update(ReadBuffer.GetData(), BytesToRead);
+        HashedBytes += BytesToRead;
+        HashBufferedSegments();
+    }
+    return true;
+}
+
+FString FStreamingFileHasher::Finalize()
+{
+    uint8 Hash[16];
+    MD5.Final(Hash);
+    return BytesToHex(Hash, 16).ToLower();
+}
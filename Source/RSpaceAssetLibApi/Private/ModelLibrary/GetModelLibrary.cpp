@@ -19,6 +19,7 @@ void UGetModelLibrary::SendGetModelLibraryRequest(const FString& Ticket, const F
         if (ModelActiveRequests.Contains(RequestKey))
         {
             UE_LOG(LogTemp, Warning, TEXT("Duplicate request detected, skipping: %s"), *RequestKey);
+            OnRequestFailedDelegate.ExecuteIfBound();
             return;
         }
  
@@ -51,6 +52,11 @@ void UGetModelLibrary::OnResponseReceivedWithCleanup(FHttpRequestPtr Request, FH
     OnResponseReceived(Request, Response, bWasSuccessful);
 }
 
+void UGetModelLibrary::SetOnRequestFailed(FOnGetModelLibraryFailed InFailedDelegate)
+{
+    OnRequestFailedDelegate = InFailedDelegate;
+}
+
 FString UGetModelLibrary::PreprocessJsonString(const FString& JsonString)
 {
     FString ProcessedString = JsonString;
@@ -110,10 +116,14 @@ void UGetModelLibrary::OnResponseReceived(FHttpRequestPtr Request, FHttpResponse
             {
                 OnGetModelLibraryResponseDelegate.Execute(ModelLibraryData);
             }
+            return;
         }
     }
     else
     {
         UE_LOG(LogTemp, Error, TEXT("Failed to send GetModelLibrary request"));
     }
+
+    // Only callers that asked for it hear about failures 只有注册了失败回调的调用方会收到失败通知
+    OnRequestFailedDelegate.ExecuteIfBound();
 }
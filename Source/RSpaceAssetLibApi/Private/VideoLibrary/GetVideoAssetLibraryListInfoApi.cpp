@@ -21,6 +21,7 @@ void UGetVideoAssetLibraryListInfoApi::SendGetVideoAssetLibraryListInfoRequest(c
 		if (VideoActiveRequests.Contains(RequestKey))
 		{
 			UE_LOG(LogTemp, Warning, TEXT("Duplicate request detected, skipping: %s"), *RequestKey);
+			OnRequestFailedDelegate.ExecuteIfBound();
 			return;
 		}
 	
@@ -41,6 +42,11 @@ void UGetVideoAssetLibraryListInfoApi::SendGetVideoAssetLibraryListInfoRequest(c
 	Request->ProcessRequest();
 }
 
+void UGetVideoAssetLibraryListInfoApi::SetOnRequestFailed(FOnGetVideoAssetLibraryListInfoFailed InFailedDelegate)
+{
+	OnRequestFailedDelegate = InFailedDelegate;
+}
+
 FString UGetVideoAssetLibraryListInfoApi::PreprocessJsonString(const FString& JsonString)
 {
 	FString ProcessedString = JsonString;
@@ -75,6 +81,7 @@ void UGetVideoAssetLibraryListInfoApi::OnResponseReceived(FHttpRequestPtr Reques
 			{
 				OnResponseDelegate.Execute(&VideoAssetData);
 			}
+			return;
 		}
 		else
 		{
@@ -85,4 +92,7 @@ void UGetVideoAssetLibraryListInfoApi::OnResponseReceived(FHttpRequestPtr Reques
 	{
 		UE_LOG(LogTemp, Error, TEXT("Failed to receive valid response."));
 	}
+
+	// Only callers that asked for it hear about failures 只有注册了失败回调的调用方会收到失败通知
+	OnRequestFailedDelegate.ExecuteIfBound();
 }
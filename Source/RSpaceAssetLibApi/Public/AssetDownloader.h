@@ -4,14 +4,44 @@
 
 #include "CoreMinimal.h"
 #include "Interfaces/IHttpRequest.h"
+#include "Downloader/AssetCacheLock.h"
+#include "Downloader/AssetFileWriter.h"
+#include "Downloader/AssetResponseStream.h"
+#include "Downloader/AssetDownloadStats.h"
+#include "Downloader/DownloadJournal.h"
 #include "UObject/NoExportTypes.h"
 #include "AssetDownloader.generated.h"
 
-DECLARE_DELEGATE_ThreeParams(FOnDownloadProgress, float /*Progress*/, int64 /*BytesDownloaded*/, int64 /*TotalBytes*/);
+DECLARE_DELEGATE_FourParams(FOnDownloadProgress, float /*Progress*/, int64 /*BytesDownloaded*/, int64 /*TotalBytes*/, int64 /*CurrentChunkSize*/);
 DECLARE_DELEGATE(FOnDownloadComplete);
 DECLARE_DELEGATE(FOnDownloadError);
 DECLARE_DELEGATE(FOnFileAlreadyDownloaded);
 
+/** One ranged GET that is currently in flight for the downloaded file. */
+struct FDownloadSegment
+{
+	int64 StartByte = 0;
+	int64 EndByte = 0;
+	double IssueTime = 0.0;
+	int32 RetryCount = 0;
+	FHttpRequestPtr Request;
+
+	/** Body bytes already counted in the download stats. */
+	int64 ReportedBytes = 0;
+
+	/** Receives the body straight into the file once the response is the requested range (UE 5.3 and later). */
+	TSharedPtr<FAssetResponseStream> Stream;
+};
+
+/** A failed range waiting for its backoff before it is fetched again. */
+struct FDownloadRetryRange
+{
+	int64 StartByte = 0;
+	int64 EndByte = 0;
+	int32 RetryCount = 0;
+	double ReadyTime = 0.0;
+};
+
 UCLASS()
 class RSPACEASSETLIBAPI_API UAssetDownloader : public UObject
 {
@@ -24,20 +54,89 @@ public:
 	void CancelDownload();
 	FString PreprocessJsonString(const FString& JsonString);
 
+	virtual void BeginDestroy() override;
+
 	void SetOnDownloadProgress(FOnDownloadProgress InOnDownloadProgress);
 	void SetOnDownloadComplete(FOnDownloadComplete InOnDownloadComplete);
 	void SetOnDownloadError(FOnDownloadError InOnDownloadError);
 	void SetOnFileAlreadyDownloaded(FOnFileAlreadyDownloaded InOnFileAlreadyDownloaded);
+
+	/** Number of range requests kept in flight for this file (1 = sequential). */
+	void SetMaxConcurrentSegments(int32 InMaxConcurrentSegments);
+	int32 GetMaxConcurrentSegments() const { return MaxConcurrentSegments; }
+
+	/** Share of the global bandwidth cap relative to other downloads (see FAssetBandwidthLimiter). */
+	void SetBandwidthWeight(float InBandwidthWeight) { BandwidthWeight = FMath::Max(InBandwidthWeight, 0.01f); }
+	float GetBandwidthWeight() const { return BandwidthWeight; }
+
+	/** Bounds for the adaptive range size, in bytes. */
+	void SetChunkSizeBounds(int64 InMinChunkSize, int64 InMaxChunkSize);
+	int64 GetCurrentChunkSize() const { return CurrentChunkSize; }
 	bool IsPaused() const { return bIsPaused; }
+
+	/** True while another editor instance downloads the same content and this one waits for it. */
+	bool IsWaitingForSharedDownload() const { return bIsWaitingForSharedDownload; }
+
+	/**
+	 * A failed range is fetched again up to MaxRetriesPerRange times before the download fails.
+	 * The wait doubles from RetryBaseDelay up to RetryMaxDelay seconds, with random jitter.
+	 */
+	void SetRetryPolicy(int32 InMaxRetriesPerRange, float InRetryBaseDelay, float InRetryMaxDelay);
+	int32 GetMaxRetriesPerRange() const { return MaxRetriesPerRange; }
+
+	/** Ranges fetched again after a failure since the download started. */
+	int32 GetRetryCount() const { return RetryCount; }
+
+	/** Throughput, latency and retry figures since the download was first started. */
+	const FAssetDownloadStats& GetStats();
+
+	/** True when the finished file did not match the expected MD5. */
+	bool IsCorrupt() const { return bIsCorrupt; }
+	static FString GetCorruptFilePath(const FString& FilePath) { return FilePath + TEXT(".corrupt"); }
+	static bool IsCorruptFile(const FString& FilePath) { return FilePath.EndsWith(TEXT(".corrupt"), ESearchCase::IgnoreCase); }
+
+	/** A download is written to FilePath.part and only renamed to FilePath once verified. */
+	static FString GetPartFilePath(const FString& FilePath) { return FilePath + TEXT(".part"); }
+	static bool IsPartFile(const FString& FilePath) { return FilePath.EndsWith(TEXT(".part"), ESearchCase::IgnoreCase); }
 	bool bIsPaused = false;
 
 private:
+	void StartNetworkDownload();
+	bool CompleteFromContentStore();
+	bool AcquireCacheLock();
+	void ReleaseCacheLock();
+	void WaitForSharedDownload();
+	void ScheduleSharedDownloadPoll();
+	void PollSharedDownload();
+	void ResetDownloadState();
+	void SendFirstRangeRequest();
 	void HandleInitialResponse(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful);
+	/** FirstRangeBytes were already streamed into the partial file by the first request. */
+	bool BeginFileDownload(int64 FileSize, int64 FirstRangeBytes = 0);
+	bool AcquireBandwidth(int64 NumBytes);
 	void DownloadNextChunk();
+	bool IssueNextSegment();
 	void HandleChunkDownloadComplete(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful);
-
-	bool CheckIfFileExistsWithMD5(const FString& FileName, const FString& MD5);
-	void SaveToCSV(const FString& FileName, const FString& MD5);
+	void BindRequestProgress(FHttpRequestPtr Request);
+	void HandleRequestProgress(FHttpRequestPtr Request, int64 BytesReceived);
+	void RecordReceivedBytes(double IssueTime, int64& ReportedBytes, int64 BytesReceived);
+	void CancelActiveSegments();
+	bool IsDownloadFinished() const;
+	void BroadcastDownloadError();
+	static bool IsRetryableFailure(bool bWasSuccessful, FHttpResponsePtr Response);
+	float GetRetryDelay(int32 Attempt) const;
+	void ScheduleDownloadNextChunk(float Delay);
+	void UpdateChunkSize(int64 SegmentBytes, double SegmentSeconds);
+	void HandleChunkWriteFlushed(int64 Offset, int64 NumBytes, bool bSuccess, int32 Generation);
+	void HandleRangeCommitted(int64 Offset, int64 NumBytes, int32 Generation);
+	void CloseFileWriter();
+	bool VerifyDownloadedFile();
+	FString GetDownloadFilePath() const;
+	FString GetPartFilePath() const { return GetPartFilePath(GetDownloadFilePath()); }
+	void MigrateLegacyPartialFile();
+	bool RestoreFromJournal();
+	void SaveJournal(bool bForce);
+	void DeleteJournal();
 
 	FOnDownloadProgress OnDownloadProgress;
 	FOnDownloadComplete OnDownloadComplete;
@@ -48,10 +147,85 @@ private:
 	FString DownloadFileName;
 	FString DownloadMD5;
 	int64 DownloadFileSize = 0;
+	bool bIsFileSizeKnown = false;
+	double FirstRangeIssueTime = 0.0;
 	int64 DownloadedBytes = 0;
 	int32 TotalChunks = 0;
 	int32 CurrentChunk = 0;
 
+	// Segmented download state 分段下载状态
+	int64 NextRangeStart = 0;
+	TArray<FDownloadSegment> ActiveSegments;
+	TArray<TPair<int64, int64>> PendingRanges;
+	TArray<FDownloadRetryRange> RetryRanges;
+	int32 MaxConcurrentSegments = DefaultConcurrentSegments;
+	bool bHasFailed = false;
+	bool bIsCompleted = false;
+	bool bIsCorrupt = false;
+
+	// Failed ranges are retried with jittered exponential backoff 失败的分段按带抖动的指数退避重试
+	int32 MaxRetriesPerRange = DefaultMaxRetriesPerRange;
+	float RetryBaseDelay = DefaultRetryBaseDelay;
+	float RetryMaxDelay = DefaultRetryMaxDelay;
+	int32 RetryCount = 0;
+	int32 FirstRangeRetryCount = 0;
+	double FirstRangeRetryTime = 0.0;
+
+	// Time of the earliest pending ticker wake-up, 0 when none is pending 最早一次待触发唤醒的时间，没有时为 0
+	double ScheduledWakeUpTime = 0.0;
+
+	// Claim on the content in the shared cache, held while this instance downloads it 对共享缓存中该内容的占用，本实例下载期间持有
+	TUniquePtr<FAssetCacheLock> CacheLock;
+	bool bIsWaitingForSharedDownload = false;
+	bool bIsSharedDownloadPollScheduled = false;
+
+	// Kept for the lifetime of the job, across pause and resume 在任务整个生命周期内保留，暂停和继续不清零
+	FAssetDownloadStats Stats;
+	int64 FirstRangeReportedBytes = 0;
+
+	// Chunks are written by a write-behind thread 分段数据由后台写线程写入磁盘
+	TSharedPtr<FAssetFileWriter> FileWriter;
+	int32 FileWriterGeneration = 0;
+
+	// Bytes flushed by the current writer, compared with its queued bytes 当前写线程已写入的字节数
+	int64 FlushedBytes = 0;
+
+	// Checked ranges the writer has not journaled yet 已通过检查但尚未记录到日志的范围数
+	int32 PendingCommits = 0;
+
+	// Body of the first request, streamed into the partial file before the file size is known 首个请求的响应体，在文件大小已知前写入临时文件
+	TSharedPtr<FAssetResponseStream> FirstRangeStream;
+
+	// Flushed ranges, persisted next to the partial file 已写入的范围，保存在临时文件旁边
+	FDownloadJournal Journal;
+	double LastJournalSaveTime = 0.0;
+
+	// Adaptive range size, grown like TCP slow start 自适应分段大小，类似 TCP 慢启动
+	int64 CurrentChunkSize = ChunkSize;
+	int64 MinChunkSize = DefaultMinChunkSize;
+	int64 MaxChunkSize = DefaultMaxChunkSize;
+	bool bInSlowStart = true;
+	double SmoothedBytesPerSecond = 0.0;
+
+	// Bytes granted by the global bandwidth limiter but not yet requested 全局限速器已授权但尚未请求的字节数
+	float BandwidthWeight = 1.0f;
+	int64 BandwidthCredit = 0;
+	bool bIsWaitingForBandwidth = false;
+
 	TSharedPtr<IHttpRequest> HttpRequest;
 	static constexpr int64 ChunkSize = 512 * 512; 
+	static constexpr int64 DefaultMinChunkSize = 64 * 1024;
+	static constexpr int64 DefaultMaxChunkSize = 16 * 1024 * 1024;
+	static constexpr int64 MaxBufferedSegmentSize = 4 * 1024 * 1024;
+	// New ranges wait while the writer has more than this queued, bounding memory on slow disks 写线程积压超过该值时新分段等待，限制慢速磁盘上的内存占用
+	static constexpr int64 MaxUnflushedBytes = 8 * 1024 * 1024;
+	static constexpr int64 SingleRequestFileSize = 2 * 1024 * 1024;
+	static constexpr double TargetSegmentSeconds = 1.0;
+	static constexpr double JournalSaveInterval = 1.0;
+	static constexpr float SharedDownloadPollInterval = 1.0f;
+	static constexpr int32 DefaultConcurrentSegments = 4;
+	static constexpr int32 MaxAllowedConcurrentSegments = 16;
+	static constexpr int32 DefaultMaxRetriesPerRange = 5;
+	static constexpr float DefaultRetryBaseDelay = 1.0f;
+	static constexpr float DefaultRetryMaxDelay = 30.0f;
 };
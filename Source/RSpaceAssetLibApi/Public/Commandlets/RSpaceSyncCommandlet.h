@@ -0,0 +1,86 @@
+﻿// Copyright (c) 2024 Hunan MangoXR Tech Co., Ltd. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "AudioLibrary/GetAudioFileByConditionData.h"
+#include "AudioLibrary/GetAudioFileDetailData.h"
+#include "ConceptDesignLibrary/GetConceptDesignLibMenuData.h"
+#include "RSpaceSyncCommandlet.generated.h"
+
+class UAssetDownloadJob;
+class UAssetDownloadBatch;
+
+/**
+ * Mirrors the asset library of one project into Saved/RspaceAssetsLibrary without the editor UI,
+ * e.g. to pre-warm build machines overnight:
+ *
+ *   UnrealEditor-Cmd <Project>.uproject -run=RSpaceSync -Project=<projectNo> [-Ticket=<ticket> -Uuid=<uuid>]
+ *       [-CredentialsFile=<path>] [-Libraries=Model,Video,Audio,Concept] [-Parallel=10]
+ *
+ * Without -Ticket the ticket and uuid are read from CredentialsFile (Ticket=... and Uuid=... lines),
+ * by default Saved/RspaceAssetsLibrary/SyncCredentials.ini. Files whose MD5 is already present on
+ * disk or in the content store are skipped; files listed without an MD5 are skipped when a local
+ * file of the listed size exists. The mirror is flat, so a file whose name is already taken by
+ * another one is skipped and counted in the summary.
+ */
+UCLASS()
+class RSPACEASSETLIBAPI_API URSpaceSyncCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	URSpaceSyncCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+	/** A listing without an answer after this long counts as failed. */
+	static constexpr double ListingTimeout = 120.0;
+	static constexpr int32 MaxConcurrentListings = 8;
+	static constexpr int32 AudioPageSize = 1000;
+	static constexpr int32 ConceptPageSize = 100;
+
+private:
+	bool ReadCredentials(const FString& Params);
+
+	void ListAudioPage(int32 Page);
+	void HandleAudioPageListed(const FGetAudioFileByConditionResponse& Response, int32 Page, UObject* ListingRequest);
+	void ListPendingAudioDetails();
+	void HandleAudioDetailListed(const FAudioFileDetailData& Detail, int64 ListedSize, UObject* ListingRequest);
+	void ListConceptPage(int32 Page);
+	void HandleConceptPageListed(FGetConceptDesignLibMenuData* MenuData, int32 Page, UObject* ListingRequest);
+
+	void AddListing(UObject* ListingRequest);
+	bool FinishListing(UObject* ListingRequest);
+	void ExpireListings();
+
+	bool ShouldDownloadFile(const FString& FileName, const FString& URL, const FString& MD5, int64 ListedSize);
+	void QueueFile(const FString& FileName, const FString& URL, const FString& MD5, int64 ListedSize);
+	bool IsSyncFinished() const;
+	void PrintSummary(double Elapsed) const;
+
+	FString Ticket;
+	FString Uuid;
+	FString ProjectNo;
+
+	// Listing requests in flight and when they were sent 正在进行的列举请求及其发送时间
+	UPROPERTY()
+	TMap<UObject*, double> PendingListings;
+
+	TArray<FAudioFileData> PendingAudioDetails;
+	int32 NumFailedListings = 0;
+
+	UPROPERTY()
+	TArray<UAssetDownloadBatch*> Batches;
+
+	UPROPERTY()
+	TArray<UAssetDownloadJob*> Jobs;
+
+	int32 NumSkippedFiles = 0;
+	int64 SkippedBytes = 0;
+
+	// URL of the first file mirrored under each name 每个文件名下第一个镜像文件的 URL
+	TMap<FString, FString> MirroredFileURLs;
+	int32 NumNameCollisions = 0;
+};
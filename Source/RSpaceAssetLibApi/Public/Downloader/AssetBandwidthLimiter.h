@@ -0,0 +1,60 @@
+﻿// Copyright (c) 2024 Hunan MangoXR Tech Co., Ltd. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+
+DECLARE_DELEGATE_OneParam(FOnBandwidthGranted, int64 /*NumBytes*/);
+
+/**
+ * Token bucket shared by every UAssetDownloader. Downloaders take the bytes of a range from the bucket
+ * before requesting it; when the bucket is empty the request waits and is served by weighted fair
+ * queuing, so a job with twice the weight gets twice the share of a capped link.
+ */
+class RSPACEASSETLIBAPI_API FAssetBandwidthLimiter
+{
+public:
+	static FAssetBandwidthLimiter& Get();
+
+	~FAssetBandwidthLimiter();
+
+	/** Bytes per second for all downloads together, 0 removes the cap. */
+	void SetBandwidthLimit(int64 InBytesPerSecond);
+	int64 GetBandwidthLimit() const { return BytesPerSecond; }
+	bool IsLimited() const { return BytesPerSecond > 0; }
+
+	/** Bucket capacity: one second of bandwidth. A single range should not ask for more. */
+	int64 GetBurstBytes() const { return BytesPerSecond; }
+
+	/** Returns true if NumBytes may be used now, otherwise OnGranted fires once they are available. */
+	bool RequestBytes(const void* Owner, int64 NumBytes, float Weight, FOnBandwidthGranted OnGranted);
+
+	/** Drops the waiting requests of Owner, e.g. when its download pauses. */
+	void CancelRequests(const void* Owner);
+
+private:
+	struct FWaitingRequest
+	{
+		const void* Owner = nullptr;
+		int64 NumBytes = 0;
+		double FinishTag = 0.0;
+		FOnBandwidthGranted OnGranted;
+	};
+
+	bool Tick(float DeltaTime);
+	void Refill();
+	void GrantWaitingRequests();
+	double MakeFinishTag(const void* Owner, int64 NumBytes, float Weight);
+
+	int64 BytesPerSecond = 0;
+	double Tokens = 0.0;
+	double LastRefillTime = 0.0;
+
+	// Self-clocked fair queuing: virtual time is the finish tag of the last grant 自计时公平队列：虚拟时间为最近一次授权的完成标记
+	double VirtualTime = 0.0;
+	TMap<const void*, double> LastFinishTags;
+	TArray<FWaitingRequest> WaitingRequests;
+
+	FTSTicker::FDelegateHandle TickerHandle;
+};
@@ -0,0 +1,35 @@
+﻿// Copyright (c) 2024 Hunan MangoXR Tech Co., Ltd. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Exclusive lock on a file, visible to every editor process on the machine. The operating system
+ * drops the lock when its owner exits, so a crashed editor never blocks the others. While held, the
+ * lock file doubles as an in-progress marker naming the owning process and project.
+ */
+class RSPACEASSETLIBAPI_API FAssetCacheLock
+{
+public:
+	UE_NONCOPYABLE(FAssetCacheLock);
+
+	/** Returns null when LockPath is held by another process or another lock in this one. */
+	static TUniquePtr<FAssetCacheLock> TryAcquire(const FString& LockPath);
+
+	/** Releases the lock and removes the lock file. */
+	~FAssetCacheLock();
+
+	const FString& GetPath() const { return Path; }
+
+private:
+	explicit FAssetCacheLock(const FString& InPath) : Path(InPath) {}
+
+	FString Path;
+
+#if PLATFORM_WINDOWS
+	void* Handle = nullptr;
+#else
+	int32 FileDescriptor = -1;
+#endif
+};
@@ -0,0 +1,92 @@
+﻿// Copyright (c) 2024 Hunan MangoXR Tech Co., Ltd. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Containers/Ticker.h"
+#include "Downloader/AssetCacheLock.h"
+
+struct FAssetStoreEntry
+{
+	FString MD5;
+
+	/** Absolute path of the stored content. */
+	FString Path;
+
+	int64 Size = 0;
+
+	FDateTime LastAccess;
+};
+
+/**
+ * Content-addressed store for downloaded assets, keyed by the MD5 the API reports for each file.
+ * Objects live under Store/<first two hex digits>/<md5><ext>; visible files in the download folder
+ * are hard links to them, so versions sharing a file name no longer overwrite each other's data and
+ * identical files under different names are downloaded once.
+ *
+ * The store lives under Saved/RspaceAssetsLibrary of the project unless a machine-wide cache root is
+ * configured, either with the RSPACE_ASSET_CACHE_DIR environment variable or with
+ * [RspaceAssetsLibrary] SharedCacheDirectory= in EditorSettings.ini. Every editor instance using the
+ * same root then shares one copy of each file, and a download in one instance is awaited by the
+ * others through a lock file under Locks/ instead of being fetched twice.
+ */
+class RSPACEASSETLIBAPI_API FAssetContentStore
+{
+public:
+	static FAssetContentStore& Get();
+
+	/** Returns the stored entry for MD5 if its content is still on disk. */
+	bool FindEntry(const FString& MD5, FAssetStoreEntry& OutEntry);
+
+	bool Contains(const FString& MD5) { FAssetStoreEntry Entry; return FindEntry(MD5, Entry); }
+
+	/** Makes TargetPath refer to the stored content of MD5 (hard link, or a copy as fallback). */
+	bool MaterializeTo(const FString& MD5, const FString& TargetPath);
+
+	/** Registers a verified download. The content is linked into the store, or copied where hard links fail. */
+	bool AddFile(const FString& MD5, const FString& FilePath);
+
+	/**
+	 * Claims the download of MD5 for this process. Returns null while another editor instance holds
+	 * the claim; it should then wait for the content to appear in the store.
+	 */
+	TUniquePtr<FAssetCacheLock> TryLockDownload(const FString& MD5) const;
+
+	FString GetStoreDirectory() const { return StoreDirectory; }
+
+	/** True when the store is a machine-wide cache shared with other projects. */
+	bool IsShared() const { return bIsShared; }
+
+	/** The configured machine-wide cache root, or an empty string for the per-project store. */
+	static FString GetSharedCacheRoot();
+
+	static bool CreateHardLink(const FString& NewLinkPath, const FString& ExistingPath);
+
+private:
+	FAssetContentStore();
+	~FAssetContentStore();
+
+	FString GetObjectPath(const FString& MD5, const FString& Extension) const;
+
+	/** Looks for an object that another process added since the manifest was read. */
+	bool FindObjectOnDisk(const FString& MD5, FAssetStoreEntry& OutEntry) const;
+
+	void LoadManifest();
+	void SaveManifest();
+	bool RetrySaveManifest(float DeltaTime);
+	static void ReadManifest(const FString& Path, TMap<FString, FAssetStoreEntry>& OutEntries);
+
+	FString StoreDirectory;
+	FString LockDirectory;
+	FString ManifestPath;
+	bool bIsShared = false;
+	TMap<FString, FAssetStoreEntry> Entries;
+
+	// Entries dropped by this process, not taken back from another process's manifest 本进程已移除的条目，合并其他进程的清单时不再恢复
+	TSet<FString> DroppedEntries;
+
+	// Pending save after the manifest lock was busy 清单锁被占用后待执行的保存
+	FTSTicker::FDelegateHandle SaveManifestHandle;
+
+	static constexpr float ManifestSaveRetryDelay = 0.5f;
+};
@@ -0,0 +1,91 @@
+﻿// Copyright (c) 2024 Hunan MangoXR Tech Co., Ltd. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Downloader/AssetDownloadSubsystem.h"
+#include "AssetDownloadBatch.generated.h"
+
+class UGetModelLibraryResponseData;
+struct FGetVideoAssetLibraryListInfoData;
+
+UENUM()
+enum class EAssetDownloadBatchSource : uint8
+{
+	Model,
+	Video
+};
+
+/**
+ * A library folder queued for download with its whole subtree. Sub folders are listed concurrently
+ * and every file found becomes a job of UAssetDownloadSubsystem, so the files share the download
+ * queue with single downloads. Progress is summed over the jobs of the batch.
+ */
+UCLASS()
+class RSPACEASSETLIBAPI_API UAssetDownloadBatch : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	const FString& GetFolderName() const { return FolderName; }
+	EAssetDownloadBatchSource GetSource() const { return Source; }
+
+	/** True while folders are still being listed; more files may be added. */
+	bool IsListing() const { return PendingFolders.Num() > 0 || NumActiveListings > 0; }
+
+	/** Listing is done and every file completed, failed or was cancelled. */
+	bool IsFinished() const;
+	bool ContainsJob(UAssetDownloadJob* Job) const { return ListedSizes.Contains(Job); }
+
+	int32 GetNumFiles() const { return Jobs.Num(); }
+	int32 GetNumCompletedFiles() const;
+	int32 GetNumFailedFiles() const;
+	int32 GetNumFailedFolders() const { return NumFailedFolders; }
+
+	int64 GetDownloadedBytes() const;
+	int64 GetTotalBytes() const;
+
+	static constexpr int32 MaxConcurrentListings = 8;
+	static constexpr int32 MaxListingAttempts = 3;
+
+private:
+	friend class UAssetDownloadSubsystem;
+
+	struct FPendingFolder
+	{
+		FString FolderKey;
+		int32 Attempts = 0;
+	};
+
+	void Start(EAssetDownloadBatchSource InSource, const FString& InTicket, const FString& InUuid, const FString& InProjectNo, const FString& RootFolderKey, const FString& InFolderName, EAssetDownloadPriority InPriority, const FAssetDownloadFileFilter& InFileFilter);
+	void ListPendingFolders();
+	void ListFolder(const FPendingFolder& Folder);
+	void HandleModelFolderListed(UGetModelLibraryResponseData* ModelLibraryData, FPendingFolder Folder, UObject* ListingRequest);
+	void HandleVideoFolderListed(FGetVideoAssetLibraryListInfoData* VideoLibraryData, FPendingFolder Folder, UObject* ListingRequest);
+	void HandleFolderListingFailed(FPendingFolder Folder, UObject* ListingRequest);
+	void FinishListing(const FPendingFolder& Folder, UObject* ListingRequest, bool bSucceeded);
+	void AddFile(const FString& FileName, const FString& URL, const FString& MD5, int64 ListedSize);
+
+	EAssetDownloadBatchSource Source = EAssetDownloadBatchSource::Model;
+	EAssetDownloadPriority Priority = EAssetDownloadPriority::Normal;
+	FString Ticket;
+	FString Uuid;
+	FString ProjectNo;
+	FString FolderName;
+	FAssetDownloadFileFilter FileFilter;
+
+	// Folders waiting for a listing slot 等待列举的文件夹
+	TArray<FPendingFolder> PendingFolders;
+	int32 NumActiveListings = 0;
+	int32 NumFailedFolders = 0;
+
+	// Listing API objects stay referenced until their response arrives 列举请求对象在收到响应前保持引用
+	UPROPERTY()
+	TArray<UObject*> ListingRequests;
+
+	UPROPERTY()
+	TArray<UAssetDownloadJob*> Jobs;
+
+	// Size reported by the listing, used until the download knows the real size 列表中的大小，下载得到实际大小前使用
+	TMap<UAssetDownloadJob*, int64> ListedSizes;
+};
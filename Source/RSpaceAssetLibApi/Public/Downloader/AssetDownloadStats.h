@@ -0,0 +1,71 @@
+﻿// Copyright (c) 2024 Hunan MangoXR Tech Co., Ltd. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Latency histogram with doubling buckets: bucket 0 counts samples up to 10 ms, bucket 1 up to 20 ms
+ * and so on; the last bucket also takes everything slower.
+ */
+struct RSPACEASSETLIBAPI_API FAssetLatencyHistogram
+{
+	static constexpr int32 NumBuckets = 12;
+	static constexpr double FirstBucketSeconds = 0.01;
+
+	int32 Buckets[NumBuckets] = {};
+	int32 NumSamples = 0;
+	double TotalSeconds = 0.0;
+	double MaxSeconds = 0.0;
+
+	void AddSample(double Seconds);
+	void Merge(const FAssetLatencyHistogram& Other);
+
+	double GetAverage() const { return NumSamples > 0 ? TotalSeconds / NumSamples : 0.0; }
+
+	/** Upper bound of the bucket that holds the given percentile (0-1), capped at the slowest sample. */
+	double GetPercentile(double Percentile) const;
+
+	static double GetBucketUpperBound(int32 Bucket) { return FirstBucketSeconds * (double)(1 << Bucket); }
+};
+
+/**
+ * Throughput, latency and retry figures of one download. The subsystem merges them into figures for
+ * the whole queue. Throughput is measured over short windows and smoothed across windows.
+ */
+struct RSPACEASSETLIBAPI_API FAssetDownloadStats
+{
+	double StartTime = 0.0;
+	int64 ReceivedBytes = 0;
+	int32 NumRetries = 0;
+
+	double InstantBytesPerSecond = 0.0;
+	double SmoothedBytesPerSecond = 0.0;
+
+	/** From sending a range request to its first response byte. */
+	FAssetLatencyHistogram TimeToFirstByte;
+
+	/** From sending a range request to its last byte. */
+	FAssetLatencyHistogram RangeLatency;
+
+	void Start(double Now);
+	void RecordBytes(int64 NumBytes, double Now);
+	void RecordRetry() { NumRetries++; }
+
+	/** Closes the current throughput window once it is long enough, so a stalled download drops to zero. */
+	void UpdateThroughput(double Now);
+
+	/** Adds bytes, retries and latencies of Other; throughput is left alone. */
+	void MergeTotals(const FAssetDownloadStats& Other);
+
+	/** Seconds left for RemainingBytes at the smoothed rate, or -1 while the rate is unknown. */
+	double GetEtaSeconds(int64 RemainingBytes) const;
+
+	static constexpr double ThroughputWindowSeconds = 0.5;
+	static constexpr double ThroughputSmoothing = 0.3;
+
+private:
+	double WindowStartTime = 0.0;
+	int64 WindowBytes = 0;
+	bool bHasThroughputSample = false;
+};
@@ -0,0 +1,236 @@
+﻿// Copyright (c) 2024 Hunan MangoXR Tech Co., Ltd. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "EditorSubsystem.h"
+#include "Containers/Ticker.h"
+#include "AssetDownloader.h"
+#include "AssetDownloadSubsystem.generated.h"
+
+class UAssetDownloadJob;
+class UAssetDownloadBatch;
+
+UENUM()
+enum class EAssetDownloadState : uint8
+{
+	Queued,
+	Downloading,
+	Paused,
+	Completed,
+	Failed,
+	Cancelled
+};
+
+UENUM()
+enum class EAssetDownloadPriority : uint8
+{
+	Background,
+	Normal,
+	High
+};
+
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnAssetDownloadJobAdded, UAssetDownloadJob* /*Job*/);
+DECLARE_MULTICAST_DELEGATE_TwoParams(FOnAssetDownloadJobStateChanged, UAssetDownloadJob* /*Job*/, EAssetDownloadState /*PreviousState*/);
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnAssetDownloadJobProgress, UAssetDownloadJob* /*Job*/);
+DECLARE_MULTICAST_DELEGATE_OneParam(FOnAssetDownloadJobsProgress, const TArray<UAssetDownloadJob*>& /*Jobs*/);
+
+/** Decides whether a file listed by a folder batch is queued; return false to skip it. */
+DECLARE_DELEGATE_RetVal_FourParams(bool, FAssetDownloadFileFilter, const FString& /*FileName*/, const FString& /*URL*/, const FString& /*MD5*/, int64 /*ListedSize*/);
+
+/** Files and bytes summed over the running folder batches. */
+struct FAssetDownloadBatchProgress
+{
+	int32 NumBatches = 0;
+	int32 NumFiles = 0;
+	int32 NumCompletedFiles = 0;
+	int32 NumFailedFiles = 0;
+	int64 DownloadedBytes = 0;
+	int64 TotalBytes = 0;
+	bool bIsListing = false;
+};
+
+/** Figures of a job that left the queue, kept for the session totals and the CSV export. */
+struct FAssetDownloadJobRecord
+{
+	int32 JobId = 0;
+	FString FileName;
+	EAssetDownloadState State = EAssetDownloadState::Completed;
+	int64 DownloadedBytes = 0;
+	int64 TotalBytes = 0;
+	FAssetDownloadStats Stats;
+};
+
+/** One queued file download. Jobs are created and driven by UAssetDownloadSubsystem. */
+UCLASS()
+class RSPACEASSETLIBAPI_API UAssetDownloadJob : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	int32 GetJobId() const { return JobId; }
+	const FString& GetURL() const { return URL; }
+	const FString& GetFileName() const { return FileName; }
+	const FString& GetMD5() const { return MD5; }
+	FString GetFilePath() const;
+
+	EAssetDownloadState GetState() const { return State; }
+	EAssetDownloadPriority GetPriority() const { return Priority; }
+
+	/** Completed and cancelled jobs never change state again. */
+	bool IsFinished() const { return State == EAssetDownloadState::Completed || State == EAssetDownloadState::Cancelled; }
+
+	float GetProgress() const { return TotalBytes > 0 ? (float)DownloadedBytes / (float)TotalBytes : 0.0f; }
+	int64 GetDownloadedBytes() const { return DownloadedBytes; }
+	int64 GetTotalBytes() const { return TotalBytes; }
+	int64 GetCurrentChunkSize() const { return CurrentChunkSize; }
+	bool IsCorrupt() const { return Downloader && Downloader->IsCorrupt(); }
+	int32 GetRetryCount() const { return Downloader ? Downloader->GetRetryCount() : 0; }
+
+	/** True while another editor instance on this machine downloads the same content. */
+	bool IsWaitingForSharedDownload() const { return Downloader && Downloader->IsWaitingForSharedDownload(); }
+
+	FAssetDownloadStats GetStats() const { return Downloader ? Downloader->GetStats() : FAssetDownloadStats(); }
+
+	/** Seconds until the job completes at its smoothed rate, or -1 while unknown. */
+	double GetEtaSeconds() const { return TotalBytes > 0 ? GetStats().GetEtaSeconds(TotalBytes - DownloadedBytes) : -1.0; }
+
+	FOnAssetDownloadJobStateChanged OnStateChanged;
+	FOnAssetDownloadJobProgress OnProgress;
+
+private:
+	friend class UAssetDownloadSubsystem;
+
+	int32 JobId = 0;
+	bool bHasStarted = false;
+	FString URL;
+	FString FileName;
+	FString MD5;
+
+	EAssetDownloadState State = EAssetDownloadState::Queued;
+	EAssetDownloadPriority Priority = EAssetDownloadPriority::Normal;
+
+	int64 DownloadedBytes = 0;
+	int64 TotalBytes = 0;
+	int64 CurrentChunkSize = 0;
+
+	UPROPERTY()
+	UAssetDownloader* Downloader = nullptr;
+};
+
+/**
+ * Owns every asset download of the editor session. Jobs wait in a priority queue and are started
+ * while fewer than MaxConcurrentDownloads are running, independent of any widget; the download list
+ * only subscribes to the job events.
+ */
+UCLASS()
+class RSPACEASSETLIBAPI_API UAssetDownloadSubsystem : public UEditorSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	static UAssetDownloadSubsystem* Get();
+
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/**
+	 * Queues URL (not yet URL-encoded) for download to FileName. An unfinished job for the same file and
+	 * MD5 is returned instead of a new one; returns null while a job with other content holds the name.
+	 */
+	UAssetDownloadJob* EnqueueDownload(const FString& URL, const FString& FileName, const FString& MD5, EAssetDownloadPriority Priority = EAssetDownloadPriority::Normal);
+
+	/** Lists a model library folder recursively and queues every file in it. */
+	UAssetDownloadBatch* EnqueueModelFolder(const FString& Ticket, const FString& Uuid, const FString& ProjectNo, int32 FolderId, const FString& FolderName, EAssetDownloadPriority Priority = EAssetDownloadPriority::Normal, const FAssetDownloadFileFilter& FileFilter = FAssetDownloadFileFilter());
+
+	/** Lists a video library folder, identified by its fileNo, recursively and queues every file in it. */
+	UAssetDownloadBatch* EnqueueVideoFolder(const FString& Ticket, const FString& ProjectNo, const FString& FolderNo, const FString& FolderName, EAssetDownloadPriority Priority = EAssetDownloadPriority::Normal, const FAssetDownloadFileFilter& FileFilter = FAssetDownloadFileFilter());
+
+	void PauseJob(UAssetDownloadJob* Job);
+	void ResumeJob(UAssetDownloadJob* Job);
+	void CancelJob(UAssetDownloadJob* Job);
+	void SetJobPriority(UAssetDownloadJob* Job, EAssetDownloadPriority Priority);
+
+	void PauseAll();
+	void ResumeAll();
+	void CancelAll();
+
+	void SetMaxConcurrentDownloads(int32 InMaxConcurrentDownloads);
+	int32 GetMaxConcurrentDownloads() const { return MaxConcurrentDownloads; }
+
+	/** Unfinished jobs in the order they were added. */
+	const TArray<UAssetDownloadJob*>& GetJobs() const { return Jobs; }
+	UAssetDownloadJob* FindJobByFileName(const FString& FileName) const;
+	bool IsFileDownloading(const FString& FileName) const { return FindJobByFileName(FileName) != nullptr; }
+	int32 GetNumDownloadingJobs() const;
+
+	/** Folder batches of the current run; they are dropped together once all of them finished. */
+	const TArray<UAssetDownloadBatch*>& GetBatches() const { return Batches; }
+	FAssetDownloadBatchProgress GetBatchProgress() const;
+
+	/**
+	 * Stats of every job of the session merged together. Throughput is the sum over running jobs,
+	 * so GetEtaSeconds(GetRemainingBytes()) estimates when the queue drains.
+	 */
+	FAssetDownloadStats GetAggregateStats() const;
+	int64 GetRemainingBytes() const;
+
+	/** Writes one row per job of the session, a total row and the latency histograms. */
+	bool ExportStatsToCsv(const FString& FilePath) const;
+
+	FOnAssetDownloadJobAdded OnJobAdded;
+	FOnAssetDownloadJobStateChanged OnJobStateChanged;
+
+	/**
+	 * Jobs whose progress changed since the last delivery. Progress is gathered here and delivered
+	 * once per frame at most, capped by RSAsset.ProgressUpdateRate; each job's OnProgress fires in
+	 * the same pass.
+	 */
+	FOnAssetDownloadJobsProgress OnJobsProgress;
+
+	static constexpr int32 DefaultMaxConcurrentDownloads = 10;
+
+private:
+	friend class UAssetDownloadBatch;
+
+	bool SetJobState(UAssetDownloadJob* Job, EAssetDownloadState NewState);
+	static bool CanTransition(EAssetDownloadState From, EAssetDownloadState To);
+
+	void PushQueuedJob(UAssetDownloadJob* Job);
+	void RemoveQueuedJob(UAssetDownloadJob* Job);
+	void ProcessQueue();
+	void StartJob(UAssetDownloadJob* Job);
+	void RemoveJob(UAssetDownloadJob* Job);
+
+	void HandleJobProgress(float Progress, int64 BytesDownloaded, int64 TotalBytes, int64 CurrentChunkSize, UAssetDownloadJob* Job);
+	bool DeliverPendingProgress(float DeltaTime);
+	void DeliverJobProgress(UAssetDownloadJob* Job);
+	void HandleJobComplete(UAssetDownloadJob* Job);
+	void HandleJobError(UAssetDownloadJob* Job);
+
+	static FString EncodeDownloadURL(const FString& URL);
+
+	UAssetDownloadBatch* AddBatch();
+	void HandleBatchUpdated(UAssetDownloadBatch* Batch);
+
+	UPROPERTY()
+	TArray<UAssetDownloadJob*> Jobs;
+
+	/** Binary heap of queued jobs, highest priority first, then first come first served. */
+	TArray<UAssetDownloadJob*> QueuedJobs;
+
+	UPROPERTY()
+	TArray<UAssetDownloadBatch*> Batches;
+
+	TArray<FAssetDownloadJobRecord> FinishedJobRecords;
+	FAssetDownloadStats FinishedJobTotals;
+
+	// Jobs with progress not yet delivered to the UI 进度尚未通知界面的任务
+	TArray<TWeakObjectPtr<UAssetDownloadJob>> PendingProgressJobs;
+	FTSTicker::FDelegateHandle ProgressTickerHandle;
+	double LastProgressDeliveryTime = 0.0;
+
+	int32 MaxConcurrentDownloads = DefaultMaxConcurrentDownloads;
+	int32 NextJobId = 1;
+	bool bIsProcessingQueue = false;
+};
@@ -0,0 +1,101 @@
+﻿// Copyright (c) 2024 Hunan MangoXR Tech Co., Ltd. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/Runnable.h"
+#include "Containers/Queue.h"
+#include "Downloader/StreamingFileHasher.h"
+
+class FRunnableThread;
+class IFileHandle;
+
+DECLARE_DELEGATE_ThreeParams(FOnChunkWriteFlushed, int64 /*Offset*/, int64 /*NumBytes*/, bool /*bSuccess*/);
+DECLARE_DELEGATE_TwoParams(FOnRangeCommitted, int64 /*Offset*/, int64 /*NumBytes*/);
+
+/**
+ * Write-behind writer for one download target.
+ * Chunk buffers are handed over through a lock-free queue and written on a dedicated thread
+ * through a single open file handle; each flushed chunk is reported back on the game thread.
+ */
+class RSPACEASSETLIBAPI_API FAssetFileWriter : public FRunnable
+{
+public:
+	FAssetFileWriter(const FString& InFilePath, FOnChunkWriteFlushed InOnChunkWriteFlushed);
+	virtual ~FAssetFileWriter();
+
+	/**
+	 * Hashes every written chunk on the writer thread. Call before Open().
+	 * HashPrefixBytes already on disk (e.g. from a resumed download) are hashed first.
+	 */
+	void EnableHashing(int64 InFileSize, int64 InHashPrefixBytes);
+
+	/** Reports each range passed to CommitRange on the game thread. Call before Open(). */
+	void SetOnRangeCommitted(FOnRangeCommitted InOnRangeCommitted) { check(!IsOpen()); OnRangeCommitted = InOnRangeCommitted; }
+
+	/** Extends the file to InFileSize when it is opened, so chunks never grow it. Call before Open(). */
+	void SetPreallocatedSize(int64 InFileSize) { check(!IsOpen()); PreallocatedSize = InFileSize; }
+
+	/** Opens the target file and starts the writer thread. */
+	bool Open();
+
+	/** Queues a chunk to be written at Offset. Safe to call from any thread, e.g. an HTTP response stream. */
+	void EnqueueWrite(int64 Offset, TArray<uint8>&& Data);
+
+	/**
+	 * Marks [Offset, Offset + NumBytes) as verified once everything queued before it has been written.
+	 * Only committed bytes are hashed.
+	 */
+	void CommitRange(int64 Offset, int64 NumBytes);
+
+	/** Writes everything still queued, stops the thread and closes the file handle. */
+	void Close();
+
+	bool IsOpen() const { return Thread != nullptr; }
+	int64 GetPendingBytes() const { return PendingBytes.Load(); }
+
+	/** Bytes handed to EnqueueWrite since the writer was opened. */
+	int64 GetQueuedBytes() const { return QueuedBytes.Load(); }
+	const FString& GetFilePath() const { return FilePath; }
+
+	/** Only safe to use once the writer has been closed. */
+	FStreamingFileHasher& GetHasher() { return Hasher; }
+
+	// FRunnable
+	virtual uint32 Run() override;
+	virtual void Stop() override;
+
+private:
+	struct FPendingWrite
+	{
+		int64 Offset = 0;
+		TArray<uint8> Data;
+
+		// A commit marker carries no data 提交标记不携带数据
+		bool bIsCommit = false;
+		int64 CommitBytes = 0;
+	};
+
+	void DrainPendingWrites();
+
+	FString FilePath;
+	FOnChunkWriteFlushed OnChunkWriteFlushed;
+	FOnRangeCommitted OnRangeCommitted;
+
+	TQueue<FPendingWrite, EQueueMode::Mpsc> PendingWrites;
+
+	// Keeps producers from queueing while the thread is being shut down 防止关闭线程时仍有数据入队
+	FCriticalSection ProducerLock;
+	TUniquePtr<IFileHandle> FileHandle;
+
+	FStreamingFileHasher Hasher;
+	bool bHashContent = false;
+	int64 HashPrefixBytes = 0;
+	int64 PreallocatedSize = 0;
+
+	FRunnableThread* Thread = nullptr;
+	FEvent* WorkEvent = nullptr;
+	TAtomic<bool> bStopRequested { false };
+	TAtomic<int64> PendingBytes { 0 };
+	TAtomic<int64> QueuedBytes { 0 };
+};
@@ -0,0 +1,67 @@
+﻿// Copyright (c) 2024 Hunan MangoXR Tech Co., Ltd. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Serialization/Archive.h"
+#include "Interfaces/IHttpRequest.h"
+#include "Downloader/AssetFileWriter.h"
+
+/**
+ * Archive that receives one ranged response body on the HTTP thread.
+ * Bytes are gathered into a small buffer and handed to the file writer at their offset in the
+ * target file, so a response is never held in memory as a whole.
+ *
+ * Nothing reaches the writer unless the response is a 206 for the requested range, so error pages
+ * and full-body answers never land in the file. The written bytes are not committed; the downloader
+ * commits the range once the whole response passed its checks.
+ */
+class RSPACEASSETLIBAPI_API FAssetResponseStream : public FArchive
+{
+public:
+	/** ExpectedTotalSize is the size of the whole file, or -1 while it is unknown. */
+	FAssetResponseStream(const TSharedRef<FAssetFileWriter>& InFileWriter, int64 InStartOffset, int64 InMaxBytes, int64 InExpectedTotalSize);
+
+	/** The request whose response this stream receives; call before the request is processed. */
+	void SetRequest(const FHttpRequestPtr& InRequest) { Request = InRequest; }
+
+	/** Also accepts a 200 carrying the whole file, for the first range of a download at offset 0. */
+	void AcceptFullBody() { bAcceptFullBody = true; }
+
+	// FArchive
+	virtual void Serialize(void* Data, int64 Length) override;
+	virtual void Flush() override;
+	virtual FString GetArchiveName() const override { return TEXT("FAssetResponseStream"); }
+
+	/** Bytes of the range received so far; bytes past the requested range are dropped. */
+	int64 GetReceivedBytes() const { return ReceivedBytes.Load(); }
+
+	/** True once the response turned out not to be the requested range; its body was dropped. */
+	bool WasRejected() const { return State.Load() == EState::Rejected; }
+
+	/** Parses "bytes 0-1023/4096"; OutTotal is -1 when the server sends "*" for the size. */
+	static bool ParseContentRange(const FString& Header, int64& OutStart, int64& OutEnd, int64& OutTotal);
+
+	static constexpr int64 BufferSize = 256 * 1024;
+
+private:
+	enum class EState : uint8
+	{
+		Unchecked,
+		Accepted,
+		Rejected
+	};
+
+	bool IsExpectedResponse();
+
+	TSharedRef<FAssetFileWriter> FileWriter;
+	TWeakPtr<IHttpRequest, ESPMode::ThreadSafe> Request;
+	int64 StartOffset = 0;
+	int64 MaxBytes = 0;
+	int64 ExpectedTotalSize = -1;
+	bool bAcceptFullBody = false;
+	int64 EnqueuedBytes = 0;
+	TAtomic<int64> ReceivedBytes { 0 };
+	TAtomic<EState> State { EState::Unchecked };
+	TArray<uint8> Buffer;
+};
@@ -0,0 +1,39 @@
+﻿// Copyright (c) 2024 Hunan MangoXR Tech Co., Ltd. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Sidecar journal stored next to a partial download.
+ * Records which byte ranges already reached the disk so that a download can continue
+ * after the editor was closed or crashed.
+ */
+struct RSPACEASSETLIBAPI_API FDownloadJournal
+{
+	FString URL;
+	FString FileName;
+	FString MD5;
+	int64 FileSize = 0;
+
+	/** Inclusive byte ranges flushed to disk, sorted and merged. */
+	TArray<TPair<int64, int64>> CompletedRanges;
+
+	void AddCompletedRange(int64 StartByte, int64 EndByte);
+	int64 GetCompletedBytes() const;
+	TArray<TPair<int64, int64>> GetMissingRanges() const;
+
+	/** True when the journal describes the same remote file. */
+	bool Matches(const FString& InURL, int64 InFileSize, const FString& InMD5) const;
+
+	bool Save(const FString& JournalPath) const;
+	bool Load(const FString& JournalPath);
+
+	static FString GetJournalPath(const FString& FilePath);
+	static bool IsJournalFile(const FString& FilePath);
+
+	/** Loads every journal in Directory whose partial file still exists. */
+	static TArray<FDownloadJournal> FindInterruptedDownloads(const FString& Directory);
+
+	static const TCHAR* JournalExtension;
+};
@@ -0,0 +1,53 @@
+﻿// Copyright (c) 2024 Hunan MangoXR Tech Co., Ltd. All Rights Reserved.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/SecureHash.h"
+
+/**
+ * Incremental MD5 of a file that arrives in possibly out-of-order ranges.
+ * Written bytes are buffered until their range is committed as verified; only the committed,
+ * contiguous prefix is hashed. Whatever could not be buffered is read back from disk, gap by gap,
+ * when catching up.
+ */
+class RSPACEASSETLIBAPI_API FStreamingFileHasher
+{
+public:
+	void Reset(int64 InFileSize);
+
+	/** Feeds the bytes written at Offset; they are hashed once a committed range covers them. */
+	void Update(int64 Offset, const uint8* Data, int64 NumBytes);
+
+	/** Marks [Offset, Offset + NumBytes) as verified content of the file. */
+	void Commit(int64 Offset, int64 NumBytes);
+
+	/** Hashes the bytes in [HashedBytes, UpToByte) that were not streamed by reading them from FilePath. */
+	bool CatchUpFromFile(const FString& FilePath, int64 UpToByte);
+
+	/** Returns the lower-case hex digest. Valid once GetHashedBytes() equals the file size. */
+	FString Finalize();
+
+	int64 GetHashedBytes() const { return HashedBytes; }
+	int64 GetBufferedBytes() const { return BufferedBytes; }
+
+private:
+	void HashBufferedSegments();
+
+	/** End of the committed bytes that continue the hashed prefix. */
+	int64 GetCommittedEnd() const;
+
+	FMD5 MD5;
+	int64 FileSize = 0;
+	int64 HashedBytes = 0;
+
+	TMap<int64, TArray<uint8>> BufferedSegments;
+	int64 BufferedBytes = 0;
+
+	// Committed ranges past the hashed prefix, as [start, end) 已提交但尚未计算的范围，左闭右开
+	TArray<TPair<int64, int64>> CommittedRanges;
+
+	// Beyond this the remaining gaps are read back from disk instead 超过该大小后改为从磁盘回读
+	static constexpr int64 MaxBufferedBytes = 64 * 1024 * 1024;
+	static constexpr int64 ReadBlockSize = 1024 * 1024;
+};
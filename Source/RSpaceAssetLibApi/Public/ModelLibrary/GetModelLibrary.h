@@ -10,6 +10,7 @@
 #include "GetModelLibrary.generated.h"
 
 DECLARE_DELEGATE_OneParam(FOnGetModelLibraryResponse, UGetModelLibraryResponseData* /* ModelLibraryData */);
+DECLARE_DELEGATE(FOnGetModelLibraryFailed);
 
 UCLASS()
 class RSPACEASSETLIBAPI_API UGetModelLibrary : public UObject
@@ -22,6 +23,9 @@ public:
 	                                int64& tagId, const FString& tagName, FOnGetModelLibraryResponse InOnGetModelLibraryResponseDelegate);
 	FString PreprocessJsonString(const FString& JsonString);
 
+	/** Called instead of the response delegate when the request fails or duplicates one in flight. */
+	void SetOnRequestFailed(FOnGetModelLibraryFailed InFailedDelegate);
+
 private:
 
 	void OnResponseReceived(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful);
@@ -30,4 +34,5 @@ private:
 
 
 	FOnGetModelLibraryResponse OnGetModelLibraryResponseDelegate;
+	FOnGetModelLibraryFailed OnRequestFailedDelegate;
 };
@@ -10,6 +10,7 @@
 #include "GetVideoAssetLibraryListInfoApi.generated.h"
 
 DECLARE_DELEGATE_OneParam(FOnGetVideoAssetLibraryListInfoResponse, FGetVideoAssetLibraryListInfoData* /* VideoAssetData */);
+DECLARE_DELEGATE(FOnGetVideoAssetLibraryListInfoFailed);
 
 UCLASS()
 class RSPACEASSETLIBAPI_API UGetVideoAssetLibraryListInfoApi : public UObject
@@ -21,10 +22,14 @@ public:
 	void SendGetVideoAssetLibraryListInfoRequest(const FString& Ticket, const FString& ProjectNo, const FString& ParentId, const FString& FileName, FOnGetVideoAssetLibraryListInfoResponse InResponseDelegate);
 	FString PreprocessJsonString(const FString& JsonString);
 
+	/** Called instead of the response delegate when the request fails or duplicates one in flight. */
+	void SetOnRequestFailed(FOnGetVideoAssetLibraryListInfoFailed InFailedDelegate);
+
 private:
 	void OnResponseReceived(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful);
 
 	void OnResponseReceivedWithCleanup(FHttpRequestPtr Request, FHttpResponsePtr Response, bool bWasSuccessful, FString RequestKey);
 
 	FOnGetVideoAssetLibraryListInfoResponse OnResponseDelegate;
+	FOnGetVideoAssetLibraryListInfoFailed OnRequestFailedDelegate;
 };
@@ -23,6 +23,7 @@ public class RSpaceAssetLibApi : ModuleRules
 		if (Target.bBuildEditor)
 		{
 			PublicDependencyModuleNames.Add("UnrealEd");
+			PublicDependencyModuleNames.Add("EditorSubsystem");
 		}
         
 		PrivateDependencyModuleNames.AddRange(new string[]